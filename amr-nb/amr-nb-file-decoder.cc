@@ -0,0 +1,124 @@
+#include "amr-nb-file-decoder.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "c-code/interf_dec.h"
+
+static const char kAmrMagic[] = "#!AMR\n";
+static const int kAmrMagicSize = 6;
+// payload octets after the header octet per frame type, 8 is SID, 15 is NO_DATA
+static const short kBlockSize[16] = { 12, 13, 15, 17, 19, 20, 26, 31, 5, 0, 0, 0, 0, 0, 0, 0 };
+
+bool AmrNbFileDecoder::Open(const std::string &filename, bool use_mmap) {
+  Close();
+  if (use_mmap) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < kAmrMagicSize) {
+      close(fd);
+      return false;
+    }
+    void *mapped = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return false;
+    madvise(mapped, st.st_size, MADV_SEQUENTIAL);
+    mapped_ = (const unsigned char *)mapped;
+    mapped_size_ = st.st_size;
+    own_mapping_ = true;
+  } else {
+    file_ = fopen(filename.c_str(), "rb");
+    if (file_ == NULL) return false;
+  }
+  return Start();
+}
+
+bool AmrNbFileDecoder::OpenMemory(const char *data, size_t size) {
+  Close();
+  mapped_ = (const unsigned char *)data;
+  mapped_size_ = size;
+  own_mapping_ = false;
+  return Start();
+}
+
+bool AmrNbFileDecoder::Start() {
+  char magic[kAmrMagicSize];
+  if (file_ != NULL) {
+    if (fread(magic, 1, kAmrMagicSize, file_) != (size_t)kAmrMagicSize) {
+      Close();
+      return false;
+    }
+  } else {
+    if (mapped_size_ < (size_t)kAmrMagicSize) {
+      Close();
+      return false;
+    }
+    std::memcpy(magic, mapped_, kAmrMagicSize);
+  }
+  if (std::memcmp(magic, kAmrMagic, kAmrMagicSize) != 0) {
+    Close();
+    return false;
+  }
+  offset_ = kAmrMagicSize;
+  num_frames_ = 0;
+  // the state block is kept across files and reset in place
+  arena_.resize(Decoder_Interface_state_size());
+  decoder_state_ = Decoder_Interface_init_in(arena_.data());
+  return decoder_state_ != NULL;
+}
+
+bool AmrNbFileDecoder::NextFrame(unsigned char *frame) {
+  if (file_ != NULL) {
+    if (fread(frame, 1, 1, file_) != 1) return false;
+    int read_size = kBlockSize[(frame[0] >> 3) & 0x000F];
+    return fread(&frame[1], 1, read_size, file_) == (size_t)read_size;
+  }
+  if (offset_ >= mapped_size_) return false;
+  int read_size = kBlockSize[(mapped_[offset_] >> 3) & 0x000F];
+  if (offset_ + 1 + read_size > mapped_size_) return false;
+  // the decoder shifts the octets while unpacking, so it gets a copy
+  std::memcpy(frame, mapped_ + offset_, 1 + read_size);
+  offset_ += 1 + read_size;
+  return true;
+}
+
+int AmrNbFileDecoder::Read(short *pcm_out, int max_samples) {
+  unsigned char frame[32];
+  int num_samples = 0;
+  if (decoder_state_ == NULL) return 0;
+  while (num_samples + samples_per_frames_ <= max_samples && NextFrame(frame)) {
+    Decoder_Interface_Decode(decoder_state_, frame, pcm_out + num_samples, 0);
+    num_samples += samples_per_frames_;
+    num_frames_++;
+  }
+  return num_samples;
+}
+
+void AmrNbFileDecoder::ReadAll(std::vector<short> *pcm_out) {
+  const int frames_per_read = 500;
+  size_t num_samples = pcm_out->size();
+  int read_samples;
+  do {
+    pcm_out->resize(num_samples + frames_per_read * samples_per_frames_);
+    read_samples = Read(pcm_out->data() + num_samples, frames_per_read * samples_per_frames_);
+    num_samples += read_samples;
+  } while (read_samples > 0);
+  pcm_out->resize(num_samples);
+}
+
+void AmrNbFileDecoder::Close() {
+  decoder_state_ = NULL;
+  if (file_ != NULL) {
+    fclose(file_);
+    file_ = NULL;
+  }
+  if (mapped_ != NULL && own_mapping_) {
+    munmap((void *)mapped_, mapped_size_);
+  }
+  mapped_ = NULL;
+  mapped_size_ = 0;
+  own_mapping_ = false;
+}
@@ -0,0 +1,46 @@
+#ifndef AMR_NB_FILE_DECODER_H
+#define AMR_NB_FILE_DECODER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// streaming decoder of .amr storage format files (RFC 4867 section 5, magic
+// "#!AMR\n" followed by one header octet and the packed speech bits per frame),
+// the frames go straight to Decoder_Interface_Decode, no re-encoding
+class AmrNbFileDecoder {
+ public:
+  AmrNbFileDecoder(): samples_per_frames_(160), decoder_state_(NULL), file_(NULL),
+    mapped_(NULL), mapped_size_(0), own_mapping_(false), offset_(0), num_frames_(0) {};
+  // with use_mmap the whole file is mapped and the frames are parsed in place,
+  // otherwise it is read frame by frame, returns false if the file can not be
+  // opened or does not start with the magic
+  bool Open(const std::string &filename, bool use_mmap);
+  // decodes an in-memory .amr file, data has to stay valid until Close
+  bool OpenMemory(const char *data, size_t size);
+  // decodes up to max_samples / 160 whole frames into pcm_out, returns the
+  // number of samples written, 0 at the end of the file, a truncated last
+  // frame is dropped
+  int Read(short *pcm_out, int max_samples);
+  // decodes the rest of the file
+  void ReadAll(std::vector<short> *pcm_out);
+  int NumFrames() const { return num_frames_; }
+  void Close();
+  ~AmrNbFileDecoder() { Close(); };
+ private:
+  bool Start();
+  // copies the next frame (header + payload) into frame, false at the end
+  bool NextFrame(unsigned char *frame);
+  const int samples_per_frames_; // how many samples in a frame defined by AMR_NB codec
+
+  void *decoder_state_; // placed in arena_
+  std::vector<char> arena_;
+  FILE *file_;
+  const unsigned char *mapped_; // mmap-ed file or caller's buffer
+  size_t mapped_size_;
+  bool own_mapping_;
+  size_t offset_;
+  int num_frames_;
+};
+
+#endif
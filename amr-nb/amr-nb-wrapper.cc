@@ -4,66 +4,227 @@
 #include <stdio.h>
 #include <memory.h>
 #include <string.h>
+#include <cstring>
 #include "c-code/typedef.h"
 #include "c-code/interf_enc.h"
 #include "c-code/interf_dec.h"
+#include <thread>
+#include "frame-ring.h"
+
+void AmrNbWrapper::FillFrameModes() {
+  frame_modes_.resize(num_frames_);
+  if (!mode_trace_.empty()) {
+    int last_mode = mode_;
+    for (int iframe = 0; iframe < num_frames_; iframe++) {
+      if (iframe < (int)mode_trace_.size()) {
+        last_mode = ModeFromInt(mode_trace_[iframe], (Mode)last_mode);
+      }
+      frame_modes_[iframe] = last_mode;
+    }
+    return;
+  }
+  int cur_mode = std::max(min_mode_, std::min((int)mode_, max_mode_));
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  for (int iframe = 0; iframe < num_frames_; iframe++) {
+    if (switch_prob_ > 0.0f && uniform(rng_) < switch_prob_) {
+      // step up or down, reflecting at the ends of the allowed range
+      int step = uniform(rng_) < 0.5f ? -1 : 1;
+      if (cur_mode + step < min_mode_ || cur_mode + step > max_mode_) step = -step;
+      cur_mode = std::max(min_mode_, std::min(cur_mode + step, max_mode_));
+    }
+    frame_modes_[iframe] = switch_prob_ > 0.0f ? cur_mode : (int)mode_;
+  }
+}
+
+// the state lives in enc_arena_ and is reset in place on every call
+void *AmrNbWrapper::InitEncoder() {
+  enc_arena_.resize(Encoder_Interface_state_size());
+  void * enstate = Encoder_Interface_init_in(enc_arena_.data(), dtx_ ? 1 : 0);
+  Encoder_Interface_set_search_effort(enstate, search_effort_);
+  num_sid_frames_ = num_no_data_frames_ = 0;
+  return enstate;
+}
+
+// encodes frame iframe into serial_data (header octet + payload), returns its size in bytes
+int AmrNbWrapper::EncodeFrame(void *enstate, int iframe, short *speech, unsigned char *serial_data) {
+  /* call encoder, it masks speech[] in place */
+  int byte_counter = Encoder_Interface_Encode(enstate, (Mode)frame_modes_[iframe], speech, serial_data, 0);
+  // frame type in the header octet, 8 is SID, 15 is NO_DATA
+  switch ((serial_data[0] >> 3) & 0x0F) {
+  case MRDTX:
+    num_sid_frames_++; break;
+  case 15:
+    num_no_data_frames_++; break;
+  }
+  return byte_counter;
+}
 
 void AmrNbWrapper::Encode(const char *pcm_in, int in_samples, unsigned char * amr_nb) {
   /* input speech vector */
   short speech[160];
-  /* counters */
-  int byte_counter, frames = 0, bytes = 0;
-  /* pointer to encoder state structure */
+  int byte_counter;
   unsigned char serial_data[32];
-  void * enstate = Encoder_Interface_init(0);
+  void * enstate = InitEncoder();
   /* read file */
   const char *p_input = pcm_in;
   unsigned char *p_amr_nb = amr_nb;
-  // std::cout << "mode_=" << mode_ << "\n";
   for (int iframe = 0; iframe < num_frames_; iframe++) {
     std::memcpy(speech, p_input, sizeof(short) * samples_per_frames_);
     p_input += sizeof(short) * samples_per_frames_;
-    frames ++;
-    /* call encoder */
-    byte_counter = Encoder_Interface_Encode(enstate, mode_, speech, serial_data, 0);
-    bytes += byte_counter;
+    byte_counter = EncodeFrame(enstate, iframe, speech, serial_data);
     std::memcpy(p_amr_nb, serial_data, sizeof(UWord8) * byte_counter);
     p_amr_nb += byte_counter;
   }
-  Encoder_Interface_exit(enstate);
+}
+
+void AmrNbWrapper::EncodeModes(const char *pcm_in, const std::vector<Mode> &modes,
+                               std::vector<unsigned char *> &amr_nbs) {
+  short speech[160];
+  unsigned char serial_data[32];
+  int num_modes = modes.size();
+  std::vector<void *> enstates(num_modes);
+  std::vector<unsigned char *> p_amr_nbs(amr_nbs);
+  // one contiguous block of encoder states, kept 16 byte aligned
+  int state_size = (Encoder_Interface_state_size() + 15) & ~15;
+  enc_arena_.resize((size_t)state_size * num_modes);
+  for (int imode = 0; imode < num_modes; imode++) {
+    enstates[imode] = Encoder_Interface_init_in(enc_arena_.data() + (size_t)state_size * imode, dtx_ ? 1 : 0);
+    Encoder_Interface_set_search_effort(enstates[imode], search_effort_);
+  }
+  const char *p_input = pcm_in;
+  for (int iframe = 0; iframe < num_frames_; iframe++) {
+    for (int imode = 0; imode < num_modes; imode++) {
+      // the encoder masks speech[] in place
+      std::memcpy(speech, p_input, sizeof(short) * samples_per_frames_);
+      int byte_counter = Encoder_Interface_Encode(enstates[imode], modes[imode], speech, serial_data, 0);
+      std::memcpy(p_amr_nbs[imode], serial_data, sizeof(UWord8) * byte_counter);
+      p_amr_nbs[imode] += byte_counter;
+    }
+    p_input += sizeof(short) * samples_per_frames_;
+  }
+}
+
+// steps the channel one frame and corrupts the frame (header + payload) in
+// place, returns the bad frame indicator for the decoder
+int AmrNbWrapper::ApplyChannel(unsigned char *frame, int dec_mode) {
+  // payload bits and class A bits per frame type, TS 26.101 (8 is SID)
+  static const short num_bits[16] = { 95, 103, 118, 134, 148, 159, 204, 244, 39, 0, 0, 0, 0, 0, 0, 0 };
+  static const short num_class_a[16] = { 42, 49, 55, 58, 61, 75, 65, 81, 39, 0, 0, 0, 0, 0, 0, 0 };
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  if (uniform(channel_rng_) < (channel_bad_ ? channel_.p_bg : channel_.p_gb)) {
+    channel_bad_ = !channel_bad_;
+  }
+  if (num_bits[dec_mode] == 0) return 0;
+  if (uniform(channel_rng_) < (channel_bad_ ? channel_.loss_bad : channel_.loss_good)) {
+    num_lost_frames_++;
+    return 1;
+  }
+  float ber = channel_bad_ ? channel_.ber_bad : channel_.ber_good;
+  if (ber <= 0.0f) return 0;
+  // gaps between flipped bits are geometric, one draw per error instead of per bit
+  std::geometric_distribution<int> gap(std::min(ber, 1.0f));
+  bool class_a_error = false;
+  for (int ibit = gap(channel_rng_); ibit < num_bits[dec_mode]; ibit += 1 + gap(channel_rng_)) {
+    frame[1 + ibit / 8] ^= 0x80 >> (ibit % 8);
+    class_a_error = class_a_error || ibit < num_class_a[dec_mode];
+    num_bit_errors_++;
+  }
+  if (class_a_error && channel_.crc_class_a) {
+    num_bad_frames_++;
+    return 1;
+  }
+  return 0;
+}
+
+// the state lives in dec_arena_, the channel restarts from the good state
+void *AmrNbWrapper::InitDecoder() {
+  dec_arena_.resize(Decoder_Interface_state_size());
+  void *destate = Decoder_Interface_init_in(dec_arena_.data());
+  channel_bad_ = false;
+  channel_rng_.seed(channel_.seed);
+  num_lost_frames_ = num_bad_frames_ = num_bit_errors_ = 0;
+  return destate;
+}
+
+// decodes one frame (header octet + payload), the channel corrupts it in place
+void AmrNbWrapper::DecodeFrame(void *destate, unsigned char *analysis, short *synth) {
+  int dec_mode = ((analysis[0] >> 3) & 0x000F);
+  /* call decoder */
+  Decoder_Interface_Decode(destate, analysis, synth, channel_.Enabled() ? ApplyChannel(analysis, dec_mode) : 0);
 }
 
 void AmrNbWrapper::Decode(const unsigned char * amr_nb, int num_frames, char * pcm_out) {
-  short synth[160];
-  int frames = 0;
   int read_size;
   unsigned char analysis[32];
-  int dec_mode;
   short block_size[16] = { 12, 13, 15, 17, 19, 20, 26, 31, 5, 0, 0, 0, 0, 0, 0, 0 };
 
-  void *destate = Decoder_Interface_init();
+  void *destate = InitDecoder();
   /* find mode, read file */
   const unsigned char * p_encoded = amr_nb;
   short * p_pcmout = (short *)pcm_out;
   for (int iframe = 0; iframe < num_frames; iframe++) {
     analysis[0] = p_encoded[0];
-    dec_mode = ((analysis[0] >> 3) & 0x000F);
-    read_size = block_size[dec_mode];
+    read_size = block_size[(analysis[0] >> 3) & 0x000F];
     std::memcpy(&analysis[1], &p_encoded[1], sizeof(unsigned char ) * read_size);
     p_encoded += read_size + 1;
-    frames ++;
-    /* call decoder */
-    Decoder_Interface_Decode(destate, analysis, synth, 0);
-    std::memcpy(p_pcmout, synth, sizeof(short) * samples_per_frames_);
+    DecodeFrame(destate, analysis, p_pcmout);
     p_pcmout += samples_per_frames_;
   }
-  Decoder_Interface_exit(destate);
+}
+
+// one encoded frame in the ring, the header octet and up to 31 payload bytes
+struct AmrNbRingFrame {
+  unsigned char serial_data[32];
+};
+
+void AmrNbWrapper::SimulatePipeline(const char * pcm_in, char * pcm_out) {
+  FrameRing<AmrNbRingFrame, 64> ring;
+  short *synth = (short *)pcm_out;
+  std::thread encoder([&]() {
+    short speech[160];
+    void *enstate = InitEncoder();
+    for (int iframe = 0; iframe < num_frames_; iframe++) {
+      std::memcpy(speech, pcm_in + sizeof(short) * samples_per_frames_ * iframe, sizeof(short) * samples_per_frames_);
+      EncodeFrame(enstate, iframe, speech, ring.BeginPush()->serial_data);
+      ring.EndPush();
+    }
+  });
+  unsigned char analysis[32];
+  void *destate = InitDecoder();
+  for (int iframe = 0; iframe < num_frames_; iframe++) {
+    std::memcpy(analysis, ring.BeginPop()->serial_data, sizeof(analysis));
+    ring.EndPop();
+    DecodeFrame(destate, analysis, synth + iframe * samples_per_frames_);
+  }
+  encoder.join();
 }
 
 void AmrNbWrapper::Simulate(const char * pcm_in, int in_samples, char * pcm_out) {
   num_frames_ = in_samples / samples_per_frames_;
+  FillFrameModes();
+  if (pipeline_) {
+    SimulatePipeline(pcm_in, pcm_out);
+    return;
+  }
   unsigned char * encoded_amr_nb = new unsigned char [num_frames_ * bytes_per_frames_];
   Encode(pcm_in, in_samples, encoded_amr_nb);
   Decode(encoded_amr_nb, num_frames_, pcm_out);
   delete []encoded_amr_nb;
-};
\ No newline at end of file
+};
+
+void AmrNbWrapper::SimulateModes(const char * pcm_in, int in_samples, const std::vector<int> &mode_ints,
+                                 const std::vector<char *> &pcm_outs) {
+  num_frames_ = in_samples / samples_per_frames_;
+  int num_modes = mode_ints.size();
+  std::vector<Mode> modes(num_modes);
+  std::vector<unsigned char *> encoded_amr_nbs(num_modes);
+  for (int imode = 0; imode < num_modes; imode++) {
+    modes[imode] = ModeFromInt(mode_ints[imode], mode_);
+    encoded_amr_nbs[imode] = new unsigned char [num_frames_ * bytes_per_frames_];
+  }
+  if (num_modes > 0) EncodeModes(pcm_in, modes, encoded_amr_nbs);
+  for (int imode = 0; imode < num_modes; imode++) {
+    Decode(encoded_amr_nbs[imode], num_frames_, pcm_outs[imode]);
+    delete []encoded_amr_nbs[imode];
+  }
+}
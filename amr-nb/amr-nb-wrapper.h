@@ -2,49 +2,139 @@
 #define AMR_NB_WRAPPER_H
 
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <random>
 #include "c-code/sp_enc.h"
 
+// Gilbert-Elliott channel between the encoder and the decoder: every frame the
+// channel moves good->bad with p_gb and bad->good with p_bg, and in each state a
+// frame is lost with loss_* and its payload bits are flipped with ber_*
+struct AmrNbChannelOptions {
+  float p_gb = 0.0f, p_bg = 1.0f;
+  float loss_good = 0.0f, loss_bad = 0.0f;
+  float ber_good = 0.0f, ber_bad = 0.0f;
+  // class A bit errors are caught by the CRC and the frame decoded as bad,
+  // class B/C bit errors reach the decoder undetected
+  bool crc_class_a = true;
+  unsigned int seed = 0;
+  bool Enabled() const {
+    return loss_good > 0.0f || loss_bad > 0.0f || ber_good > 0.0f || ber_bad > 0.0f;
+  }
+};
+
 class AmrNbWrapper {
  public:
-  AmrNbWrapper(int mode_int): samples_per_frames_(160), bytes_per_frames_(32) {
+  AmrNbWrapper(int mode_int): samples_per_frames_(160), bytes_per_frames_(32), search_effort_(0),
+    dtx_(false), num_sid_frames_(0), num_no_data_frames_(0),
+    switch_prob_(0.0f), min_mode_(0), max_mode_(7), channel_bad_(false), num_lost_frames_(0), num_bad_frames_(0),
+    num_bit_errors_(0), pipeline_(false) {
     mode_ = MR122;
     SetMode(mode_int);
   };
   void SetMode(int mode_int) {
+    mode_ = ModeFromInt(mode_int, mode_);
+  };
+  // per-frame rate modes [0, 7], the last one is held when the trace is
+  // shorter than the utterance, an empty trace falls back to the fixed mode
+  void SetModeTrace(const std::vector<int> &mode_trace) { mode_trace_ = mode_trace; }
+  // link adaptation model: starting from the fixed mode, each frame steps one
+  // mode up or down with probability switch_prob, staying within [min_mode, max_mode]
+  void SetRateAdaptation(float switch_prob, int min_mode, int max_mode, unsigned int seed) {
+    switch_prob_ = switch_prob;
+    min_mode_ = std::max(0, std::min(min_mode, 7));
+    max_mode_ = std::max(min_mode_, std::min(max_mode, 7));
+    rng_.seed(seed);
+  }
+  // modes actually used for each frame of the last Simulate call
+  const std::vector<int> &FrameModes() const { return frame_modes_; }
+  // lost and corrupted frames are handed to the decoder as bad frames (bfi) and
+  // concealed, each Simulate call restarts the channel from the good state
+  void SetChannel(const AmrNbChannelOptions &channel) { channel_ = channel; }
+  // channel statistics of the last Simulate call
+  int NumLostFrames() const { return num_lost_frames_; }
+  int NumBadFrames() const { return num_bad_frames_; }
+  int NumBitErrors() const { return num_bit_errors_; }
+  // DTX with VAD option 1 (VAD2 is a compile time option of the c-code):
+  // inactive frames skip the pitch and codebook searches, are sent as
+  // SID_FIRST/SID_UPDATE/NO_DATA and decoded as comfort noise
+  void SetDtx(bool dtx) { dtx_ = dtx; }
+  // SID and NO_DATA frames of the last Simulate call
+  int NumSidFrames() const { return num_sid_frames_; }
+  int NumNoDataFrames() const { return num_no_data_frames_; }
+  // 0 is the standard encoder, 1 and 2 trade quality for speed (not bit exact)
+  void SetSearchEffort(int effort) { search_effort_ = effort; }
+  // Simulate runs the encoder on a second thread, the frames go to the
+  // decoder through a ring as they are encoded, so encoding and decoding
+  // overlap; the output is the same as without the pipeline
+  void SetPipeline(bool pipeline) { pipeline_ = pipeline; }
+  void Simulate(const char * pcm_in, int in_samples, char * pcm_out);
+  // encodes the input frame by frame in all the modes [0, 7] of mode_ints and
+  // decodes each into pcm_outs[i], bit exact with one Simulate call per mode
+  // (the mode trace and rate adaptation are not used)
+  void SimulateModes(const char * pcm_in, int in_samples, const std::vector<int> &mode_ints,
+                     const std::vector<char *> &pcm_outs);
+  ~AmrNbWrapper() {};
+ private:
+  static Mode ModeFromInt(int mode_int, Mode fallback) {
+    Mode mode = fallback;
     if (mode_int > -1 && mode_int < 8) {
       switch (mode_int) {
       case 0:
-        mode_ = MR475; break;
+        mode = MR475; break;
       case 1:
-        mode_ = MR515; break;
+        mode = MR515; break;
       case 2:
-        mode_ = MR59; break;
+        mode = MR59; break;
       case 3:
-        mode_ = MR67; break;
+        mode = MR67; break;
       case 4:
-        mode_ = MR74; break;
+        mode = MR74; break;
       case 5:
-        mode_ = MR795; break;
+        mode = MR795; break;
       case 6:
-        mode_ = MR102; break;
+        mode = MR102; break;
       case 7:
-        mode_ = MR122; break;
+        mode = MR122; break;
       default:
-        mode_ = MR122;
+        mode = MR122;
         break;
       }
     }
-  };
-  void Simulate(const char * pcm_in, int in_samples, char * pcm_out);
-  ~AmrNbWrapper() {};
- private:
+    return mode;
+  }
+  void FillFrameModes();
+  void *InitEncoder();
+  void *InitDecoder();
+  int EncodeFrame(void *enstate, int iframe, short *speech, unsigned char *serial_data);
+  void DecodeFrame(void *destate, unsigned char *analysis, short *synth);
   void Encode(const char * pcm_in, int in_samples, unsigned char* amr_nb);
+  void EncodeModes(const char * pcm_in, const std::vector<Mode> &modes,
+                   std::vector<unsigned char *> &amr_nbs);
   void Decode(const unsigned char *amr_nb, int num_frames, char * pcm_out);
+  int ApplyChannel(unsigned char *frame, int dec_mode);
+  void SimulatePipeline(const char * pcm_in, char * pcm_out);
   const int samples_per_frames_; // how many samples in a frame defined by AMR_NB codec
   const int bytes_per_frames_; // how many bytes for an AMR_NB encoded frame
 
   Mode mode_;
+  int search_effort_;
+  bool dtx_;
+  int num_sid_frames_, num_no_data_frames_;
+  std::vector<int> mode_trace_;
+  float switch_prob_;
+  int min_mode_, max_mode_;
+  std::mt19937 rng_;
+  std::vector<int> frame_modes_;
+  AmrNbChannelOptions channel_;
+  bool channel_bad_;
+  std::mt19937 channel_rng_;
+  int num_lost_frames_, num_bad_frames_, num_bit_errors_;
   int num_frames_;
+  bool pipeline_;
+  // codec states are placed here instead of being allocated on every
+  // Simulate call, see Encoder_Interface_init_in/Decoder_Interface_init_in
+  std::vector<char> enc_arena_, dec_arena_;
 };
 
 #endif
\ No newline at end of file
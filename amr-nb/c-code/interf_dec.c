@@ -28,6 +28,7 @@
 #include <memory.h>
 #include "typedef.h"
 #include "sp_dec.h"
+#include "interf_dec.h"
 #include "interf_rom.h"
 #include "rom_dec.h"
 
@@ -49,6 +50,9 @@ struct
 
 }dec_interface_State;
 
+/* the decoder state follows the interface state in the same block */
+#define DEC_INTERFACE_SIZE ( ( sizeof( dec_interface_State ) + 15 ) & ~15 )
+
 #ifdef ETSI
 
 
@@ -585,21 +589,64 @@ void Decoder_Interface_reset( dec_interface_State *st )
  */
 void * Decoder_Interface_init( void )
 {
-   dec_interface_State * s;
+   void * s;
 
    /* allocate memory */
-   if ( ( s = ( dec_interface_State * ) malloc( sizeof( dec_interface_State ) ) ) ==
-         NULL ) {
+   if ( ( s = malloc( Decoder_Interface_state_size( ) ) ) == NULL ) {
       fprintf( stderr, "Decoder_Interface_init: "
             "can not malloc state structure\n" );
       return NULL;
    }
-   s->decoder_State = Speech_Decode_Frame_init( );
+   return Decoder_Interface_init_in( s );
+}
+
+
+/*
+ * Decoder_Interface_state_size
+ *
+ *
+ * Parameters:
+ *    void
+ *
+ * Function:
+ *    Size of the memory taken by Decoder_Interface_init_in
+ *
+ * Returns:
+ *    size in bytes
+ */
+int Decoder_Interface_state_size( void )
+{
+   return ( int )DEC_INTERFACE_SIZE + Speech_Decode_Frame_state_size( );
+}
+
+
+/*
+ * Decoder_Interface_init_in
+ *
+ *
+ * Parameters:
+ *    mem               O: Decoder_Interface_state_size() bytes,
+ *                         aligned as returned by malloc
+ *
+ * Function:
+ *    Initializes the interface and decoder states in the caller's
+ *    memory without allocating, the caller releases the memory
+ *    instead of calling Decoder_Interface_exit. Calling it again
+ *    on the same memory resets the decoder.
+ *
+ * Returns:
+ *    success           : pointer to structure (mem)
+ *    failure           : NULL
+ */
+void * Decoder_Interface_init_in( void *mem )
+{
+   dec_interface_State * s;
 
-   if ( s->decoder_State == NULL ) {
-      free( s );
+   if ( mem == NULL )
       return NULL;
-   }
+   s = ( dec_interface_State * )mem;
+   s->decoder_State = Speech_Decode_Frame_init_in( ( UWord8 * )mem +
+         DEC_INTERFACE_SIZE );
    Decoder_Interface_reset( s );
    return s;
 }
@@ -623,8 +670,7 @@ void Decoder_Interface_exit( void *state )
    dec_interface_State * s;
    s = ( dec_interface_State * )state;
 
-   /* free memory */
-   Speech_Decode_Frame_exit(s->decoder_State );
+   /* free memory, the decoder state is in the same block */
    free( s );
    s = NULL;
    state = NULL;
@@ -48,6 +48,14 @@ void Decoder_Interface_Decode( void *st,
  * Reserve and init. memory
  */
 void *Decoder_Interface_init( void );
+/*
+ * allocation free life cycle: Decoder_Interface_init_in places the state in
+ * Decoder_Interface_state_size() bytes of caller memory aligned like malloc,
+ * calling it again resets the decoder in place, the caller frees the memory
+ * and does not call Decoder_Interface_exit
+ */
+int Decoder_Interface_state_size( void );
+void *Decoder_Interface_init_in( void *mem );
 
 /*
  * Exit and free memory
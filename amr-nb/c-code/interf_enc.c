@@ -28,6 +28,7 @@
 #include <stdio.h>
 #include <memory.h>
 #include "sp_enc.h"
+#include "interf_enc.h"
 #include "interf_rom.h"
 
 /*
@@ -55,6 +56,9 @@ typedef struct
    void *encoderState;   /* Points encoder state structure */
 } enc_interface_State;
 
+/* the encoder state follows the interface state in the same block */
+#define ENC_INTERFACE_SIZE ( ( sizeof( enc_interface_State ) + 15 ) & ~15 )
+
 
 #ifdef ETSI
 /*
@@ -567,69 +571,46 @@ static void Sid_Sync_reset( enc_interface_State *st )
 
 
 /*
- * Encoder_Interface_Encode
+ * Encoder_Interface_Pack
  *
  *
  * Parameters:
- *    st                I: pointer to state structure
+ *    s                 B: state structure
  *    mode              I: Speech Mode
- *    speech            I: Input speech
+ *    used_mode         I: used mode of Speech_Encode_Frame
+ *    prm               B: speech parameters, size PRMNO_MR122
+ *    noHoming          I: zero for an encoder homing frame
  *    serial            O: Output octet structure 3GPP or
  *                         ETSI serial stream
- *    force_speech      I: Force speech in DTX
  *
  * Function:
- *    Encoding and packing one frame of speech
+ *    Frame type, homing and packing of one encoded frame
  *
  * Returns:
  *    number of octets
  */
-int Encoder_Interface_Encode( void *st, enum Mode mode, Word16 *speech,
+static int Encoder_Interface_Pack( enc_interface_State *s, enum Mode mode,
+      enum Mode used_mode, Word16 *prm, int noHoming,
 
 #ifndef ETSI
-      UWord8 *serial,
+      UWord8 *serial
 
 #else
-      Word16 *serial,
+      Word16 *serial
 #endif
 
-      int force_speech )
+      )
 {
-   Word16 prm[PRMNO_MR122];   /* speech parameters, max size */
    const Word16 *homing;   /* pointer to homing frame */
    Word16 homing_size;   /* frame size for homing frame */
 
 
-   enc_interface_State * s;
    enum TXFrameType txFrameType;   /* frame type */
 
-   int i, noHoming = 0;
-
+   int i;
 
-   /*
-    * used encoder mode,
-    * if used_mode == -1, force VAD on
-    */
-   enum Mode used_mode = -force_speech;
-
-
-   s = ( enc_interface_State * )st;
 
-    /*
-     * Checks if all samples of the input frame matches the encoder
-     * homing frame pattern, which is 0x0008 for all samples.
-     */
-   for ( i = 0; i < 160; i++ ) {
-      noHoming = speech[i] ^ 0x0008;
-
-      if ( noHoming )
-         break;
-   }
-
-   if (noHoming){
-      Speech_Encode_Frame( s->encoderState, mode, speech, prm, &used_mode );
-   }
-   else {
+   if ( noHoming == 0 ) {
       switch ( mode ) {
          case MR122:
             homing = dhf_MR122;
@@ -742,6 +723,90 @@ int Encoder_Interface_Encode( void *st, enum Mode mode, Word16 *speech,
 }
 
 
+/*
+ * Homing_Test
+ *
+ *
+ * Parameters:
+ *    speech            I: Input speech
+ *
+ * Function:
+ *    Checks if all samples of the input frame matches the encoder
+ *    homing frame pattern, which is 0x0008 for all samples.
+ *
+ * Returns:
+ *    zero for a homing frame
+ */
+static int Homing_Test( Word16 *speech )
+{
+   int i, noHoming = 0;
+
+
+   for ( i = 0; i < 160; i++ ) {
+      noHoming = speech[i] ^ 0x0008;
+
+      if ( noHoming )
+         break;
+   }
+   return noHoming;
+}
+
+
+/*
+ * Encoder_Interface_Encode
+ *
+ *
+ * Parameters:
+ *    st                I: pointer to state structure
+ *    mode              I: Speech Mode
+ *    speech            I: Input speech
+ *    serial            O: Output octet structure 3GPP or
+ *                         ETSI serial stream
+ *    force_speech      I: Force speech in DTX
+ *
+ * Function:
+ *    Encoding and packing one frame of speech
+ *
+ * Returns:
+ *    number of octets
+ */
+int Encoder_Interface_Encode( void *st, enum Mode mode, Word16 *speech,
+
+#ifndef ETSI
+      UWord8 *serial,
+
+#else
+      Word16 *serial,
+#endif
+
+      int force_speech )
+{
+   Word16 prm[PRMNO_MR122];   /* speech parameters, max size */
+
+
+   enc_interface_State * s;
+
+   int noHoming;
+
+
+   /*
+    * used encoder mode,
+    * if used_mode == -1, force VAD on
+    */
+   enum Mode used_mode = -force_speech;
+
+
+   s = ( enc_interface_State * )st;
+
+   noHoming = Homing_Test( speech );
+
+   if (noHoming){
+      Speech_Encode_Frame( s->encoderState, mode, speech, prm, &used_mode );
+   }
+   return Encoder_Interface_Pack( s, mode, used_mode, prm, noHoming, serial );
+}
+
+
 /*
  * Encoder_Interface_init
  *
@@ -757,22 +822,114 @@ int Encoder_Interface_Encode( void *st, enum Mode mode, Word16 *speech,
  */
 void * Encoder_Interface_init( int dtx )
 {
-   enc_interface_State * s;
+   void * s;
 
    /* allocate memory */
-   if ( ( s = ( enc_interface_State * ) malloc( sizeof( enc_interface_State ) ) ) ==
-         NULL ) {
+   if ( ( s = malloc( Encoder_Interface_state_size( ) ) ) == NULL ) {
       fprintf( stderr, "Encoder_Interface_init: "
             "can not malloc state structure\n" );
       return NULL;
    }
-   s->encoderState = Speech_Encode_Frame_init( dtx );
+   return Encoder_Interface_init_in( s, dtx );
+}
+
+
+/*
+ * Encoder_Interface_state_size
+ *
+ *
+ * Parameters:
+ *    void
+ *
+ * Function:
+ *    Size of the memory taken by Encoder_Interface_init_in
+ *
+ * Returns:
+ *    size in bytes
+ */
+int Encoder_Interface_state_size( void )
+{
+   return ( int )ENC_INTERFACE_SIZE + Speech_Encode_Frame_state_size( );
+}
+
+
+/*
+ * Encoder_Interface_init_in
+ *
+ *
+ * Parameters:
+ *    mem               O: Encoder_Interface_state_size() bytes,
+ *                         aligned as returned by malloc
+ *    dtx               I: DTX flag
+ *
+ * Function:
+ *    Initializes the interface and encoder states in the caller's
+ *    memory without allocating, the caller releases the memory
+ *    instead of calling Encoder_Interface_exit
+ *
+ * Returns:
+ *    pointer to encoder interface structure (mem)
+ */
+void * Encoder_Interface_init_in( void *mem, int dtx )
+{
+   enc_interface_State * s;
+
+   if ( mem == NULL )
+      return NULL;
+   s = ( enc_interface_State * )mem;
+   s->encoderState = Speech_Encode_Frame_init_in( ( UWord8 * )mem +
+         ENC_INTERFACE_SIZE, dtx );
    Sid_Sync_reset( s );
    s->dtx = dtx;
    return s;
 }
 
 
+/*
+ * Encoder_Interface_reset
+ *
+ *
+ * Parameters:
+ *    state             B: state structure
+ *    dtx               I: DTX flag
+ *
+ * Function:
+ *    Resets the interface and encoder states in place, the search
+ *    effort goes back to the standard search
+ *
+ * Returns:
+ *    void
+ */
+void Encoder_Interface_reset( void *state, int dtx )
+{
+   Encoder_Interface_init_in( state, dtx );
+}
+
+
+/*
+ * Encoder_Interface_set_search_effort
+ *
+ *
+ * Parameters:
+ *    state             B: state structure
+ *    effort            I: search effort, 0 is the standard search
+ *
+ * Function:
+ *    Sets the effort of the pitch and codebook searches,
+ *    see Speech_Encode_Frame_set_search_effort
+ *
+ * Returns:
+ *    0 on success
+ */
+int Encoder_Interface_set_search_effort( void *state, int effort )
+{
+   enc_interface_State * s;
+   s = ( enc_interface_State * )state;
+
+   return Speech_Encode_Frame_set_search_effort( s->encoderState, effort );
+}
+
+
 /*
  * DecoderInterfaceExit
  *
@@ -791,8 +948,7 @@ void Encoder_Interface_exit( void *state )
    enc_interface_State * s;
    s = ( enc_interface_State * )state;
 
-   /* free memory */
-   Speech_Encode_Frame_exit( &s->encoderState );
+   /* free memory, the encoder state is in the same block */
    free( s );
    state = NULL;
 }
@@ -52,6 +52,17 @@ int Encoder_Interface_Encode( void *st, enum Mode mode, short *speech,
  * Reserve and init. memory
  */
 void *Encoder_Interface_init( int dtx );
+/*
+ * allocation free life cycle: Encoder_Interface_init_in places the state in
+ * Encoder_Interface_state_size() bytes of caller memory aligned like malloc,
+ * Encoder_Interface_reset restarts it in place, the caller frees the memory
+ * and does not call Encoder_Interface_exit
+ */
+int Encoder_Interface_state_size( void );
+void *Encoder_Interface_init_in( void *mem, int dtx );
+void Encoder_Interface_reset( void *state, int dtx );
+
+int Encoder_Interface_set_search_effort( void *state, int effort );
 
 /*
  * Exit and free memory
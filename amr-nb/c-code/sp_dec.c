@@ -29,6 +29,7 @@
 #include <math.h>
 #include "sp_dec.h"
 #include "rom_dec.h"
+#include "sp_dec_simd.h"
 
 /*
  * Declare structure types
@@ -223,6 +224,25 @@ typedef struct
    Post_ProcessState * postHP_state;
 }Speech_Decode_FrameState;
 
+/* all states of one decoder in one block, see Speech_Decode_Frame_init_in */
+typedef struct
+{
+   Speech_Decode_FrameState frame;
+   Decoder_amrState decoder_amr;
+   Bgn_scdState background;
+   Cb_gain_averageState Cb_gain_aver;
+   lsp_avgState lsp_avg;
+   D_plsfState lsf;
+   ec_gain_pitchState ec_gain_p;
+   ec_gain_codeState ec_gain_c;
+   gc_predState pred;
+   ph_dispState ph_disp;
+   dtx_decState dtxDecoder;
+   Post_FilterState post;
+   agcState agc;
+   Post_ProcessState postHP;
+}Speech_Decode_FrameBlock;
+
 
 /*
  * CodAmrReset
@@ -1323,6 +1343,9 @@ static Word32 Syn_filt( Word32 a[], Word32 x[], Word32 y[], Word32 lg, Word32 me
    Word32 *yy, *yy_limit;
 
 
+   if ( simd_dec_kernels.syn_filt != NULL )
+      return simd_dec_kernels.syn_filt( a, x, y, lg, mem, update );
+
    /* Copy mem[] to yy[] */
    memcpy( tmp, mem, 40 );
    yy = tmp + M;
@@ -2268,6 +2291,12 @@ static void Pred_lt_3or6_40( Word32 exc[], Word32 T0, Word32 frac, Word32 flag3
    c1 = &inter6[frac];
    c2 = &inter6[6 - frac];
 
+   /* the vector blocks need the samples they read to be final */
+   if ( simd_dec_kernels.pred_lt_40 != NULL && T0 >= 18 ) {
+      simd_dec_kernels.pred_lt_40( exc, x0, c1, c2 );
+      return;
+   }
+
    for ( i = 0; i < 40; i++ ) {
       x1 = x0++;
       x2 = x0;
@@ -3976,22 +4005,26 @@ static void ph_disp( ph_dispState *state, enum Mode mode, Word32 x[],
       }
 
       /* Do phase dispersion of innovation */
-      for ( nPulse = 0; nPulse < nze; nPulse++ ) {
-         ppos = ps_poss[nPulse];
+      if ( simd_dec_kernels.ph_disp_pulses != NULL )
+         simd_dec_kernels.ph_disp_pulses( inno, inno_sav, ps_poss, nze, ph_imp );
+      else {
+         for ( nPulse = 0; nPulse < nze; nPulse++ ) {
+            ppos = ps_poss[nPulse];
 
-         /* circular convolution with impulse response */
-         j = 0;
+            /* circular convolution with impulse response */
+            j = 0;
 
-         for ( i = ppos; i < L_SUBFR; i++ ) {
-            /* inno[i1] += inno_sav[ppos] * ph_imp[i1-ppos] */
-            temp1 = ( inno_sav[ppos] * ph_imp[j++] ) >> 15;
-            inno[i] = inno[i] + temp1;
-         }
+            for ( i = ppos; i < L_SUBFR; i++ ) {
+               /* inno[i1] += inno_sav[ppos] * ph_imp[i1-ppos] */
+               temp1 = ( inno_sav[ppos] * ph_imp[j++] ) >> 15;
+               inno[i] = inno[i] + temp1;
+            }
 
-         for ( i = 0; i < ppos; i++ ) {
-            /* inno[i] += inno_sav[ppos] * ph_imp[L_SUBFR-ppos+i] */
-            temp1 = ( inno_sav[ppos] * ph_imp[j++] ) >> 15;
-            inno[i] = inno[i] + temp1;
+            for ( i = 0; i < ppos; i++ ) {
+               /* inno[i] += inno_sav[ppos] * ph_imp[L_SUBFR-ppos+i] */
+               temp1 = ( inno_sav[ppos] * ph_imp[j++] ) >> 15;
+               inno[i] = inno[i] + temp1;
+            }
          }
       }
    }
@@ -4000,6 +4033,11 @@ static void ph_disp( ph_dispState *state, enum Mode mode, Word32 x[],
     * compute total excitation for synthesis part of decoder
     * (using modified innovation if phase dispersion is active)
     */
+   if ( simd_dec_kernels.ph_disp_exc != NULL ) {
+      simd_dec_kernels.ph_disp_exc( x, inno, pitch_fac, cbGain, tmp_shift );
+      return;
+   }
+
    for ( i = 0; i < L_SUBFR; i++ ) {
       /* x[i] = gain_pit*x[i] + cbGain*code[i]; */
       temp1 = x[i] * pitch_fac + inno[i] * cbGain;
@@ -4283,6 +4321,13 @@ static Word32 energy_new( Word32 in[] )
 {
    Word32 i, s = 0, overflow = 0;
 
+   if ( simd_dec_kernels.energy_new != NULL ) {
+      s = simd_dec_kernels.energy_new( in );
+
+      if ( s >= 0 )
+         return s;
+      s = 0;
+   }
    s += in[0] * in[0];
    for ( i = 1; i < L_SUBFR; i += 3 ) {
       s += in[i] * in[i];
@@ -5296,6 +5341,12 @@ static void Residu40( Word32 a[], Word32 x[], Word32 y[] )
    Word32 s, i, j;
 
 
+   /* the kernel leaves the inputs out of the 16 bit range to the loop below */
+   if ( simd_dec_kernels.residu40 != NULL ) {
+      if ( simd_dec_kernels.residu40( a, x, y ) == 0 )
+         return;
+   }
+
    for ( i = 0; i < 40; i++ ) {
       s = a[0] * x[i] + a[1] * x[i - 1] + a[2] * x[i - 2] + a[3] * x[i - 3];
       s += a[4] * x[i - 4] + a[5] * x[i - 5] + a[6] * x[i - 6] + a[7] * x[i - 7]
@@ -5537,26 +5588,30 @@ static void Post_Filter( Post_FilterState *st, enum Mode mode, Word32 *syn,
       p2 = p1 - 1;
       tmp = *p1;
 
-      do {
-         *p1 = *p1 - ( ( temp2 * *p2-- ) >> 15 );
-         if (abs(*p1) > 32767) {
-            *p1 = (*p1 & 0x80000000) ? -32768 : 32767;
-         }
-         p1--;
-         *p1 = *p1 - ( ( temp2 * *p2-- ) >> 15 );
-         if (abs(*p1) > 32767) {
-            *p1 = (*p1 & 0x80000000) ? -32768 : 32767;
-         }
-         p1--;
-         *p1 = *p1 - ( ( temp2 * *p2-- ) >> 15 );
+      if ( simd_dec_kernels.preemph40 != NULL )
+         simd_dec_kernels.preemph40( st->res2, temp2, st->preemph_state_mem_pre );
+      else {
+         do {
+            *p1 = *p1 - ( ( temp2 * *p2-- ) >> 15 );
+            if (abs(*p1) > 32767) {
+               *p1 = (*p1 & 0x80000000) ? -32768 : 32767;
+            }
+            p1--;
+            *p1 = *p1 - ( ( temp2 * *p2-- ) >> 15 );
+            if (abs(*p1) > 32767) {
+               *p1 = (*p1 & 0x80000000) ? -32768 : 32767;
+            }
+            p1--;
+            *p1 = *p1 - ( ( temp2 * *p2-- ) >> 15 );
+            if (abs(*p1) > 32767) {
+               *p1 = (*p1 & 0x80000000) ? -32768 : 32767;
+            }
+            p1--;
+         } while( p1 > st->res2 );
+         *p1 = *p1 - ( ( temp2 * st->preemph_state_mem_pre ) >> 15 );
          if (abs(*p1) > 32767) {
             *p1 = (*p1 & 0x80000000) ? -32768 : 32767;
          }
-         p1--;
-      } while( p1 > st->res2 );
-      *p1 = *p1 - ( ( temp2 * st->preemph_state_mem_pre ) >> 15 );
-      if (abs(*p1) > 32767) {
-         *p1 = (*p1 & 0x80000000) ? -32768 : 32767;
       }
       st->preemph_state_mem_pre = tmp;
 
@@ -5698,66 +5753,6 @@ for ( i = 0; i < L_FRAME; i++ ) {
 }
 
 
-/*
- * Decoder_amr_exit
- *
- *
- * Parameters:
- *    state                I: state structure
- *
- * Function:
- *    The memory used for state memory is freed
- *
- * Returns:
- *    Void
- */
-static void Decoder_amr_exit( Decoder_amrState **state )
-{
-   if ( state == NULL || *state == NULL )
-      return;
-   free( ( *state )->lsfState );
-   free( ( *state )->ec_gain_p_st );
-   free( ( *state )->ec_gain_c_st );
-   free( ( *state )->pred_state );
-   free( ( *state )->background_state );
-   free( ( *state )->ph_disp_st );
-   free( ( *state )->Cb_gain_averState );
-   free( ( *state )->lsp_avg_st );
-   free( ( *state )->dtxDecoderState );
-
-   /* deallocate memory */
-   free( *state );
-   *state = NULL;
-   return;
-}
-
-
-/*
- * Post_Filter_exit
- *
- *
- * Parameters:
- *    state                I: state structure
- *
- * Function:
- *    The memory used for state memory is freed
- *
- * Returns:
- *    Void
- */
-static void Post_Filter_exit( Post_FilterState **state )
-{
-   if ( state == NULL || *state == NULL )
-      return;
-   free( ( *state )->agc_state );
-
-   /* deallocate memory */
-   free( *state );
-   *state = NULL;
-   return;
-}
-
-
 /*
  * Post_Process_reset
  *
@@ -5788,140 +5783,36 @@ static int Post_Process_reset( Post_ProcessState *state )
 
 
 /*
- * Post_Process_exit
+ * Speech_Decode_Frame_place
  *
  *
  * Parameters:
- *    state                I: state structure
+ *    b                 B: state block
  *
  * Function:
- *    The memory used for state memory is freed
+ *    Links the sub-states of the block to the decoder state
  *
  * Returns:
- *    Void
+ *    void
  */
-static void Post_Process_exit( Post_ProcessState **state )
+static void Speech_Decode_Frame_place( Speech_Decode_FrameBlock *b )
 {
-   if ( state == NULL || *state == NULL )
-      return;
-
-   /* deallocate memory */
-   free( *state );
-   *state = NULL;
-   return;
-}
-
-
-/*
- * Decoder_amr_init
- *
- *
- * Parameters:
- *    state             O: state structure
- *
- * Function:
- *    Allocates state memory and initializes state memory
- *
- * Returns:
- *    success = 0
- */
-static int Decoder_amr_init( Decoder_amrState **state )
-{
-   Decoder_amrState * s;
-
-   if ( ( Decoder_amrState * )state == NULL ) {
-      fprintf( stderr, "Decoder_amr_init: invalid parameter\n" );
-      return-1;
-   }
-   *state = NULL;
-
-   /* allocate memory */
-   if ( ( s = ( Decoder_amrState * ) malloc( sizeof( Decoder_amrState ) ) ) ==
-         NULL ) {
-      fprintf( stderr, "Decoder_amr_init: can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* DPlsf_init */
-   /* allocate memory */
-   if ( ( s->lsfState = ( D_plsfState * ) malloc( sizeof( D_plsfState ) ) ) ==
-         NULL ) {
-      fprintf( stderr, "DPlsf_init: can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* ecGainPitchInit */
-   /* allocate memory */
-   if ( ( s->ec_gain_p_st = ( ec_gain_pitchState * ) malloc( sizeof(
-         ec_gain_pitchState ) ) ) == NULL ) {
-      fprintf( stderr, "ecGainPitchInit: can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* ecGainCodeInit */
-   /* allocate memory */
-   if ( ( s->ec_gain_c_st = ( ec_gain_codeState * ) malloc( sizeof(
-         ec_gain_codeState ) ) ) == NULL ) {
-      fprintf( stderr, "ecGainCodeInit: can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* gcPredInit */
-   /* allocate memory */
-   if ( ( s->pred_state = ( gc_predState * ) malloc( sizeof( gc_predState ) ) )
-         == NULL ) {
-      fprintf( stderr, "gcPredInit: can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* Cb_gain_averageInit */
-   /* allocate memory */
-   if ( ( s->Cb_gain_averState = ( Cb_gain_averageState * ) malloc( sizeof(
-         Cb_gain_averageState ) ) ) == NULL ) {
-      fprintf( stderr, "Cb_gain_averageInit: can not malloc state structure\n" )
-      ;
-      return-1;
-   }
-   memset( s->Cb_gain_averState->cbGainHistory, 0, L_CBGAINHIST <<2 );
-
-   /* Initialize hangover handling */
-   s->Cb_gain_averState->hangVar = 0;
-   s->Cb_gain_averState->hangCount = 0;
-
-   /* lsp_avgInit */
-   /* allocate memory */
-   if ( ( s->lsp_avg_st = ( lsp_avgState * ) malloc( sizeof( lsp_avgState ) ) )
-         == NULL ) {
-      fprintf( stderr, "lsp_avgInit: can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* Bgn_scdInit */
-   /* allocate memory */
-   if ( ( s->background_state = ( Bgn_scdState * ) malloc( sizeof( Bgn_scdState
-         ) ) ) == NULL ) {
-      fprintf( stderr, "Bgn_scdInit: can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* phDispInit */
-   /* allocate memory */
-   if ( ( s->ph_disp_st = ( ph_dispState * ) malloc( sizeof( ph_dispState ) ) )
-         == NULL ) {
-      fprintf( stderr, "phDispInit: can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* dtxDecInit */
-   /* allocate memory */
-   if ( ( s->dtxDecoderState = ( dtx_decState * ) malloc( sizeof( dtx_decState )
-         ) ) == NULL ) {
-      fprintf( stderr, "dtxDecInit: can not malloc state structure\n" );
-      return-1;
-   }
-   Decoder_amr_reset( s, 0 );
-   *state = s;
-   return 0;
+   Decoder_amrState * s = &b->decoder_amr;
+
+
+   b->frame.decoder_amrState = s;
+   b->frame.post_state = &b->post;
+   b->frame.postHP_state = &b->postHP;
+   s->background_state = &b->background;
+   s->Cb_gain_averState = &b->Cb_gain_aver;
+   s->lsp_avg_st = &b->lsp_avg;
+   s->lsfState = &b->lsf;
+   s->ec_gain_p_st = &b->ec_gain_p;
+   s->ec_gain_c_st = &b->ec_gain_c;
+   s->pred_state = &b->pred;
+   s->ph_disp_st = &b->ph_disp;
+   s->dtxDecoderState = &b->dtxDecoder;
+   b->post.agc_state = &b->agc;
 }
 
 
@@ -5954,136 +5845,107 @@ static int Post_Filter_reset( Post_FilterState *state )
 
 
 /*
- * Post_Filter_init
+ * Speech_Decode_Frame_exit
  *
  *
  * Parameters:
- *    state             O: state structure
+ *    state                I: state structure
  *
  * Function:
- *    Allocates state memory and initializes state memory
+ *    The memory used for state memory is freed
  *
  * Returns:
- *    success = 0
+ *    Void
  */
-static int Post_Filter_init( Post_FilterState **state )
+void Speech_Decode_Frame_exit( void **st )
 {
-   Post_FilterState * s;
-
-   if ( ( Post_FilterState * )state == NULL ) {
-      fprintf( stderr, "F057:invalid parameter\n" );
-      return-1;
-   }
-   *state = NULL;
-
-   /* allocate memory */
-   if ( ( s = ( Post_FilterState * ) malloc( sizeof( Post_FilterState ) ) ) ==
-         NULL ) {
-      fprintf( stderr, "F057:can not malloc filter structure\n" );
-      return-1;
-   }
-   s->agc_state = NULL;
+   if ( (( Speech_Decode_FrameState * )( st )) == NULL )
+      return;
 
-   /* allocate memory */
-   if ( ( s->agc_state = ( agcState * ) malloc( sizeof( agcState ) ) ) == NULL )
-   {
-      fprintf( stderr, "agcInit: can not malloc state structure\n" );
-      return-1;
-   }
-   Post_Filter_reset( s );
-   *state = s;
-   return 0;
+   /* deallocate memory, the sub-states are in the same block */
+   free( (( Speech_Decode_FrameState * )st) );
+   return;
 }
 
 
 /*
- * Post_Process_init
+ * Speech_Decode_Frame_reset
  *
  *
  * Parameters:
- *    state             O: state structure
+ *    state             B: state structure
  *
  * Function:
- *    Allocates state memory and initializes state memory
+ *    Resets state memory
  *
  * Returns:
- *    success = 0
+ *    -1 = failure
  */
-static int Post_Process_init( Post_ProcessState **state )
+int Speech_Decode_Frame_reset( void **st )
 {
-   Post_ProcessState * s;
-
-   if ( ( Post_ProcessState * )state == NULL ) {
-      fprintf( stderr, "Post_Process_init: invalid parameter\n" );
-      return-1;
-   }
-   *state = NULL;
+   Speech_Decode_FrameState * state;
 
-   /* allocate memory */
-   if ( ( s = ( Post_ProcessState * ) malloc( sizeof( Post_ProcessState ) ) ) ==
-         NULL ) {
-      fprintf( stderr, "Post_Process_init: can not malloc state structure\n" );
-      return-1;
-   }
-   Post_Process_reset( s );
-   *state = s;
+   if ( st == NULL || *st == NULL )
+      return (-1);
+   state = ( Speech_Decode_FrameState * )st;
+   Decoder_amr_reset( state->decoder_amrState, ( enum Mode ) 0 );
+   Post_Filter_reset( state->post_state );
+   Post_Process_reset( state->postHP_state );
    return 0;
 }
 
 
 /*
- * Speech_Decode_Frame_exit
+ * Speech_Decode_Frame_state_size
  *
  *
  * Parameters:
- *    state                I: state structure
+ *    void
  *
  * Function:
- *    The memory used for state memory is freed
+ *    Size of the memory taken by Speech_Decode_Frame_init_in
  *
  * Returns:
- *    Void
+ *    size in bytes
  */
-void Speech_Decode_Frame_exit( void **st )
+int Speech_Decode_Frame_state_size( void )
 {
-   if ( (( Speech_Decode_FrameState * )( st )) == NULL )
-      return;
-   Decoder_amr_exit( &( ( ( Speech_Decode_FrameState * ) st )->decoder_amrState
-         ) );
-   Post_Filter_exit( &( ( ( Speech_Decode_FrameState * ) st )->post_state ) );
-   Post_Process_exit( &( ( ( Speech_Decode_FrameState * ) st )->postHP_state ) )
-   ;
-
-   /* deallocate memory */
-   free( (( Speech_Decode_FrameState * )st) );
-   return;
+   return sizeof( Speech_Decode_FrameBlock );
 }
 
 
 /*
- * Speech_Decode_Frame_reset
+ * Speech_Decode_Frame_init_in
  *
  *
  * Parameters:
- *    state             B: state structure
+ *    mem               O: Speech_Decode_Frame_state_size() bytes,
+ *                         aligned as returned by malloc
  *
  * Function:
- *    Resets state memory
+ *    Initializes the state and all its sub-states in the caller's
+ *    memory, nothing is allocated. The state is not passed to
+ *    Speech_Decode_Frame_exit, the caller releases the memory.
+ *    Calling it again on the same memory resets the decoder.
  *
  * Returns:
- *    -1 = failure
+ *    pointer to the state, mem
  */
-int Speech_Decode_Frame_reset( void **st )
+void * Speech_Decode_Frame_init_in( void *mem )
 {
-   Speech_Decode_FrameState * state;
+   Speech_Decode_FrameBlock * b;
 
-   if ( st == NULL || *st == NULL )
-      return (-1);
-   state = ( Speech_Decode_FrameState * )st;
-   Decoder_amr_reset( state->decoder_amrState, ( enum Mode ) 0 );
-   Post_Filter_reset( state->post_state );
-   Post_Process_reset( state->postHP_state );
-   return 0;
+   if ( mem == NULL ) {
+      fprintf( stderr, "Speech_Decode_Frame_init_in: invalid parameter\n" );
+      return NULL;
+   }
+   b = ( Speech_Decode_FrameBlock * )mem;
+   memset( b, 0, sizeof( Speech_Decode_FrameBlock ) );
+   Speech_Decode_Frame_place( b );
+   Decoder_amr_reset( &b->decoder_amr, ( enum Mode ) 0 );
+   Post_Filter_reset( &b->post );
+   Post_Process_reset( &b->postHP );
+   return b;
 }
 
 
@@ -6102,23 +5964,13 @@ int Speech_Decode_Frame_reset( void **st )
  */
 void * Speech_Decode_Frame_init( )
 {
-   Speech_Decode_FrameState * s;
+   void * s;
 
-   /* allocate memory */
-   if ( ( s = ( Speech_Decode_FrameState * ) malloc( sizeof(
-         Speech_Decode_FrameState ) ) ) == NULL ) {
+   /* allocate memory, one block for all the sub-states */
+   if ( ( s = malloc( sizeof( Speech_Decode_FrameBlock ) ) ) == NULL ) {
       fprintf( stderr, "Speech_Decode_Frame_init: can not malloc state "
             "structure\n" );
       return NULL;
    }
-   s->decoder_amrState = NULL;
-   s->post_state = NULL;
-   s->postHP_state = NULL;
-
-   if ( Decoder_amr_init( &s->decoder_amrState ) || Post_Filter_init( &s->
-         post_state ) || Post_Process_init( &s->postHP_state ) ) {
-      Speech_Decode_Frame_exit( ( void ** )( &s ) );
-      return NULL;
-   }
-   return s;
+   return Speech_Decode_Frame_init_in( s );
 }
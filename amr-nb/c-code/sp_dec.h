@@ -64,6 +64,19 @@ enum RXFrameType { RX_SPEECH_GOOD = 0,
  */
 void* Speech_Decode_Frame_init ();
 
+/*
+ * size in bytes of one decoder state with all its sub-states
+ */
+int Speech_Decode_Frame_state_size (void);
+
+/*
+ * initialize one instance of the speech decoder in mem, which holds
+ * Speech_Decode_Frame_state_size() bytes aligned like malloc, without
+ * allocating. The caller owns mem, do not call Speech_Decode_Frame_exit.
+ * Calling it again on the same memory resets the decoder.
+ */
+void* Speech_Decode_Frame_init_in (void *mem);
+
 /*
  * free status struct
  */
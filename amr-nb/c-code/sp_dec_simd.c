@@ -0,0 +1,553 @@
+/*
+ * ===================================================================
+ *  TS 26.104
+ *  REL-5 V5.4.0 2004-03
+ *  REL-6 V6.1.0 2004-03
+ *  3GPP AMR Floating-point Speech Codec
+ * ===================================================================
+ *
+ */
+
+/*
+ * sp_dec_simd.c
+ *
+ *
+ * Project:
+ *    AMR Floating-Point Codec
+ *
+ * Contains:
+ *    AVX2 / NEON versions of the decoder synthesis filter, the
+ *    residual and interpolation filters, phase dispersion and the
+ *    post-filter energy and preemphasis loops.
+ *
+ *    The decoder computes in 32 bit integers. A sum of products is the
+ *    same modulo 2^32 in any order, so the lanes may add the products
+ *    in another order than the reference code; the rounding, shifts and
+ *    saturations are done on the same sums and the output is bit exact.
+ *    Loops that saturate partial sums (the safe modes of Residu40,
+ *    Syn_filt_overflow) stay in the reference code.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "sp_dec_simd.h"
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#include <immintrin.h>
+#define SIMD_AVX2
+#define SIMD_TARGET __attribute__((target("avx2")))
+#define VL 8
+typedef __m256i vint;
+#define VI_LOAD( p )      _mm256_loadu_si256( ( __m256i * )( p ) )
+#define VI_STORE( p, v )  _mm256_storeu_si256( ( __m256i * )( p ), v )
+#define VI_DUP( s )       _mm256_set1_epi32( s )
+#define VI_ADD( a, b )    _mm256_add_epi32( a, b )
+#define VI_SUB( a, b )    _mm256_sub_epi32( a, b )
+#define VI_MUL( a, b )    _mm256_mullo_epi32( a, b )
+#define VI_SRA( a, n )    _mm256_srai_epi32( a, n )
+#define VI_MIN( a, b )    _mm256_min_epi32( a, b )
+#define VI_MAX( a, b )    _mm256_max_epi32( a, b )
+#define VI_ZERO()         _mm256_setzero_si256()
+/* s in lane 0, lanes 0 .. VL - 2 of v in lanes 1 .. VL - 1 */
+#define VI_SHIFT_IN( v, s ) _mm256_blend_epi32( _mm256_permutevar8x32_epi32( v, \
+      _mm256_setr_epi32( 0, 0, 1, 2, 3, 4, 5, 6 ) ), _mm256_set1_epi32( s ), 1 )
+/* b in the lanes where the sign bit of m is set, else a */
+#define VI_BLEND( a, b, m ) _mm256_castps_si256( _mm256_blendv_ps( \
+      _mm256_castsi256_ps( a ), _mm256_castsi256_ps( b ), _mm256_castsi256_ps( m ) ) )
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SIMD_NEON
+#define SIMD_TARGET
+#define VL 4
+typedef int32x4_t vint;
+#define VI_LOAD( p )      vld1q_s32( p )
+#define VI_STORE( p, v )  vst1q_s32( p, v )
+#define VI_DUP( s )       vdupq_n_s32( s )
+#define VI_ADD( a, b )    vaddq_s32( a, b )
+#define VI_SUB( a, b )    vsubq_s32( a, b )
+#define VI_MUL( a, b )    vmulq_s32( a, b )
+#define VI_SRA( a, n )    vshrq_n_s32( a, n )
+#define VI_MIN( a, b )    vminq_s32( a, b )
+#define VI_MAX( a, b )    vmaxq_s32( a, b )
+#define VI_ZERO()         vdupq_n_s32( 0 )
+#define VI_SHIFT_IN( v, s ) vextq_s32( vdupq_n_s32( s ), v, 3 )
+#endif
+
+#define M 10
+#define L_SUBFR 40
+
+SimdDecKernels simd_dec_kernels = { NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+
+#ifdef VL
+
+/*
+ * Out_of_range
+ *
+ *
+ * Parameters:
+ *    v                 I: vector
+ *    lo, hi            I: range
+ *
+ * Function:
+ *    Tests the lanes of v against [lo, hi]
+ *
+ * Returns:
+ *    nonzero if a lane is out of the range
+ */
+SIMD_TARGET static int Out_of_range( vint v, Word32 lo, Word32 hi )
+{
+#ifdef SIMD_AVX2
+   __m256i out = _mm256_or_si256( _mm256_cmpgt_epi32( v, VI_DUP( hi ) ),
+         _mm256_cmpgt_epi32( VI_DUP( lo ), v ) );
+   return !_mm256_testz_si256( out, out );
+#else
+   uint32x4_t out = vorrq_u32( vcgtq_s32( v, VI_DUP( hi ) ), vcltq_s32( v,
+         VI_DUP( lo ) ) );
+   uint32x2_t out2 = vorr_u32( vget_low_u32( out ), vget_high_u32( out ) );
+   return ( vget_lane_u32( out2, 0 ) | vget_lane_u32( out2, 1 ) ) != 0;
+#endif
+}
+
+
+/*
+ * Syn_out
+ *
+ *
+ * Parameters:
+ *    s                 I: sum of products of an output of Syn_filt
+ *    ovf               B: overflow bits
+ *    bit               I: bit set in ovf if the output saturates
+ *
+ * Function:
+ *    Rounding and saturation of Syn_filt
+ *
+ * Returns:
+ *    output sample
+ */
+static Word32 Syn_out( Word32 s, Word32 *ovf, Word32 bit )
+{
+   if ( labs( s ) < 0x7ffffff )
+      return( s + 0x800L ) >> 12;
+   *ovf |= bit;
+   return s > 0 ? 32767 : -32768;
+}
+
+
+/*
+ * Syn_filt_simd
+ *
+ *
+ * Parameters:
+ *    a                 I: prediction coefficients [M+1]
+ *    x                 I: input signal
+ *    y                 O: output signal
+ *    lg                I: size of filtering, at most L_SUBFR
+ *    mem               B: memory associated with this filtering
+ *    update            I: 0=no update, 1=update of memory.
+ *
+ * Function:
+ *    Synthesis filtering through 1/A(z), VL outputs per block. The
+ *    lanes first sum the products with the M outputs before the block,
+ *    lane k of coef[m] holds a[m + k]. The products with the outputs of
+ *    the block are then added one output after the other in registers,
+ *    each output rounded and saturated as in Syn_filt before it is fed
+ *    back.
+ *
+ *    The earlier outputs are broadcast one at a time, a vector load
+ *    over outputs just stored one by one would stall on the store
+ *    forwarding. The last block runs over the zero padded input, only
+ *    the overflows of its first lg outputs are counted.
+ *
+ * Returns:
+ *    overflow flag
+ */
+SIMD_TARGET static Word32 Syn_filt_simd( Word32 a[], Word32 x[], Word32 y[],
+      Word32 lg, Word32 mem[], Word32 update )
+{
+   Word32 tmp[M + L_SUBFR + VL];   /* mem[], then the output */
+   Word32 xs[L_SUBFR + VL], apad[M + 1 + VL], acc[VL];
+   Word32 *yy, *xp;
+   Word32 i, j, n, ovf, overflow = 0;
+   Word32 y0, y1, y2, y3;
+#if VL == 8
+   Word32 y4, y5, y6, y7;
+#endif
+   vint v, coef[M + 1];
+
+
+   memcpy( tmp, mem, M << 2 );
+   yy = tmp + M;
+
+   /*
+    * x[] may be y[], the output is kept in tmp[] until the end. A last
+    * block shorter than VL reads the input from a zero padded copy.
+    */
+   xp = x;
+
+   if ( lg % VL ) {
+      memcpy( xs, x, lg << 2 );
+      memset( &xs[lg], 0, VL << 2 );
+      xp = xs;
+   }
+   memcpy( apad, a, ( M + 1 ) << 2 );
+   memset( &apad[M + 1], 0, VL << 2 );
+
+   for ( j = 1; j <= M; j++ )
+      coef[j] = VI_LOAD( &apad[j] );
+
+   for ( i = 0; i < lg; i += VL ) {
+      v = VI_MUL( VI_LOAD( &xp[i] ), VI_DUP( a[0] ) );
+
+      /* the latest output last, it is the one the block waits for */
+      for ( j = M; j >= 1; j-- )
+         v = VI_SUB( v, VI_MUL( coef[j], VI_DUP( yy[i - j] ) ) );
+      VI_STORE( acc, v );
+      ovf = 0;
+      y0 = Syn_out( acc[0], &ovf, 1 );
+      y1 = Syn_out( acc[1] - a[1] * y0, &ovf, 2 );
+      y2 = Syn_out( acc[2] - a[1] * y1 - a[2] * y0, &ovf, 4 );
+      y3 = Syn_out( acc[3] - a[1] * y2 - a[2] * y1 - a[3] * y0, &ovf, 8 );
+      yy[i] = y0;
+      yy[i + 1] = y1;
+      yy[i + 2] = y2;
+      yy[i + 3] = y3;
+#if VL == 8
+      y4 = Syn_out( acc[4] - a[1] * y3 - a[2] * y2 - a[3] * y1 - a[4] * y0,
+            &ovf, 16 );
+      y5 = Syn_out( acc[5] - a[1] * y4 - a[2] * y3 - a[3] * y2 - a[4] * y1 - a[5]
+            * y0, &ovf, 32 );
+      y6 = Syn_out( acc[6] - a[1] * y5 - a[2] * y4 - a[3] * y3 - a[4] * y2 - a[5]
+            * y1 - a[6] * y0, &ovf, 64 );
+      y7 = Syn_out( acc[7] - a[1] * y6 - a[2] * y5 - a[3] * y4 - a[4] * y3 - a[5]
+            * y2 - a[6] * y1 - a[7] * y0, &ovf, 128 );
+      yy[i + 4] = y4;
+      yy[i + 5] = y5;
+      yy[i + 6] = y6;
+      yy[i + 7] = y7;
+#endif
+      n = lg - i < VL ? lg - i : VL;
+
+      if ( ovf & ( ( 1 << n ) - 1 ) )
+         overflow = 1;
+   }
+   memcpy( y, yy, lg << 2 );
+
+   /* Update of memory if update==1 */
+   if ( update ) {
+      memcpy( mem, &y[lg - M], 40 );
+   }
+   return overflow;
+}
+
+
+/*
+ * Residu40_simd
+ *
+ *
+ * Parameters:
+ *    a                 I: prediction coefficients
+ *    x                 I: speech signal
+ *    y                 O: residual signal
+ *
+ * Function:
+ *    The LP residual, one output per lane
+ *
+ * Returns:
+ *    1 if an output leaves the 16 bit range, Residu40 then recomputes
+ *    all of them in its safe mode
+ */
+SIMD_TARGET static Word32 Residu40_simd( Word32 a[], Word32 x[], Word32 y[] )
+{
+   Word32 i, j;
+   vint v, out[L_SUBFR / VL];
+
+
+   for ( i = 0; i < L_SUBFR / VL; i++ ) {
+      v = VI_MUL( VI_DUP( a[0] ), VI_LOAD( &x[i * VL] ) );
+
+      for ( j = 1; j <= M; j++ )
+         v = VI_ADD( v, VI_MUL( VI_DUP( a[j] ), VI_LOAD( &x[i * VL - j] ) ) );
+      out[i] = VI_SRA( VI_ADD( v, VI_DUP( 0x800 ) ), 12 );
+
+      if ( Out_of_range( out[i], -32767, 32767 ) )
+         return 1;
+   }
+
+   /* x[] and y[] do not overlap in the decoder, stored once all are in range */
+   for ( i = 0; i < L_SUBFR / VL; i++ )
+      VI_STORE( &y[i * VL], out[i] );
+   return 0;
+}
+
+
+/*
+ * Pred_lt_40_simd
+ *
+ *
+ * Parameters:
+ *    exc               B: excitation buffer
+ *    x0                I: exc[-T0] or exc[-T0-1]
+ *    c1, c2            I: the two phases of the interpolation filter
+ *
+ * Function:
+ *    Interpolation of the past excitation, one output per lane. The
+ *    outputs of a block read exc[] up to 10 + VL - 1 - T0 samples past
+ *    the block start, which for T0 >= 18 are outputs of earlier blocks.
+ *
+ * Returns:
+ *    void
+ */
+SIMD_TARGET static void Pred_lt_40_simd( Word32 exc[], Word32 *x0, const
+      Word32 *c1, const Word32 *c2 )
+{
+   Word32 i, j;
+   vint v;
+
+
+   for ( i = 0; i < L_SUBFR; i += VL ) {
+      v = VI_ZERO();
+
+      for ( j = 0; j < 10; j++ ) {
+         v = VI_ADD( v, VI_MUL( VI_LOAD( &x0[i - j] ), VI_DUP( c1[6 * j] ) ) );
+         v = VI_ADD( v, VI_MUL( VI_LOAD( &x0[i + 1 + j] ), VI_DUP( c2[6 * j] ) )
+               );
+      }
+      VI_STORE( &exc[i], VI_SRA( VI_ADD( v, VI_DUP( 0x4000 ) ), 15 ) );
+   }
+}
+
+
+/*
+ * Ph_disp_pulses_simd
+ *
+ *
+ * Parameters:
+ *    inno              O: dispersed innovation, zero on input
+ *    inno_sav          I: innovation
+ *    ps_poss           I: positions of the nze pulses
+ *    nze               I: number of pulses
+ *    ph_imp            I: dispersion impulse response [L_SUBFR]
+ *
+ * Function:
+ *    Circular convolution of the pulses with the impulse response, the
+ *    response is doubled so that the wrap around is one contiguous load
+ *
+ * Returns:
+ *    void
+ */
+SIMD_TARGET static void Ph_disp_pulses_simd( Word32 inno[], Word32 inno_sav[],
+      Word32 ps_poss[], Word32 nze, const Word32 *ph_imp )
+{
+   Word32 imp2[2 * L_SUBFR];   /* imp2[L_SUBFR + i] = ph_imp[i] */
+   Word32 i, n;
+   vint g, sum[L_SUBFR / VL];
+   const Word32 *h;
+
+
+   memcpy( imp2, ph_imp, L_SUBFR << 2 );
+   memcpy( &imp2[L_SUBFR], ph_imp, L_SUBFR << 2 );
+
+   for ( i = 0; i < L_SUBFR / VL; i++ )
+      sum[i] = VI_ZERO();
+
+   for ( n = 0; n < nze; n++ ) {
+      /* inno[i] += inno_sav[ppos] * ph_imp[(i - ppos) mod L_SUBFR] >> 15 */
+      g = VI_DUP( inno_sav[ps_poss[n]] );
+      h = &imp2[L_SUBFR - ps_poss[n]];
+
+      for ( i = 0; i < L_SUBFR / VL; i++ )
+         sum[i] = VI_ADD( sum[i], VI_SRA( VI_MUL( g, VI_LOAD( &h[i * VL] ) ),
+               15 ) );
+   }
+
+   for ( i = 0; i < L_SUBFR / VL; i++ )
+      VI_STORE( &inno[i * VL], sum[i] );
+}
+
+
+/*
+ * Ph_disp_exc_simd
+ *
+ *
+ * Parameters:
+ *    x                 B: LTP excitation in, total excitation out
+ *    inno              I: innovation
+ *    pitch_fac         I: pitch factor
+ *    cbGain            I: codebook gain
+ *    tmp_shift         I: shift applied to the sum before rounding
+ *
+ * Function:
+ *    x[i] = (x[i] * pitch_fac + inno[i] * cbGain) << tmp_shift, rounded
+ *    and saturated as in ph_disp
+ *
+ * Returns:
+ *    void
+ */
+SIMD_TARGET static void Ph_disp_exc_simd( Word32 x[], Word32 inno[], Word32
+      pitch_fac, Word32 cbGain, Word32 tmp_shift )
+{
+   Word32 i;
+   vint t1, t2, r, sat, over;
+#ifdef SIMD_AVX2
+   __m128i shift = _mm_cvtsi32_si128( tmp_shift );
+#else
+   int32x4_t shift = vdupq_n_s32( tmp_shift );
+#endif
+
+
+   for ( i = 0; i < L_SUBFR; i += VL ) {
+      t1 = VI_ADD( VI_MUL( VI_LOAD( &x[i] ), VI_DUP( pitch_fac ) ), VI_MUL(
+            VI_LOAD( &inno[i] ), VI_DUP( cbGain ) ) );
+#ifdef SIMD_AVX2
+      t2 = _mm256_sll_epi32( t1, shift );
+      r = VI_SRA( VI_ADD( t2, VI_DUP( 0x4000 ) ), 15 );
+
+      /* the sign of temp1 if the shift changed it, else of temp2 */
+      sat = VI_BLEND( t2, t1, _mm256_xor_si256( t1, t2 ) );
+      sat = VI_BLEND( VI_DUP( 32767 ), VI_DUP( -32768 ), sat );
+      over = _mm256_or_si256( _mm256_cmpgt_epi32( r, VI_DUP( 32767 ) ),
+            _mm256_cmpgt_epi32( VI_DUP( -32767 ), r ) );
+      VI_STORE( &x[i], VI_BLEND( r, sat, over ) );
+#else
+      t2 = vshlq_s32( t1, shift );
+      r = VI_SRA( VI_ADD( t2, VI_DUP( 0x4000 ) ), 15 );
+      sat = vbslq_s32( vcltq_s32( veorq_s32( t1, t2 ), VI_ZERO() ), t1, t2 );
+      sat = vbslq_s32( vcltq_s32( sat, VI_ZERO() ), VI_DUP( -32768 ), VI_DUP(
+            32767 ) );
+      over = vreinterpretq_s32_u32( vorrq_u32( vcgtq_s32( r, VI_DUP( 32767 ) ),
+            vcltq_s32( r, VI_DUP( -32767 ) ) ) );
+      VI_STORE( &x[i], vbslq_s32( vreinterpretq_u32_s32( over ), sat, r ) );
+#endif
+   }
+}
+
+
+/*
+ * Energy_new_simd
+ *
+ *
+ * Parameters:
+ *    in                I: input value
+ *
+ * Function:
+ *    Energy of signal, as energy_new. With |in[i]| <= 32767 each square
+ *    is below 2^30, so the overflow check of energy_new fires exactly
+ *    when the whole sum reaches 2^30; the sum is taken in 64 bit.
+ *
+ * Returns:
+ *    Energy, -1 if an input is out of the range or the check fires,
+ *    energy_new then runs the reference code
+ */
+SIMD_TARGET static Word32 Energy_new_simd( Word32 in[] )
+{
+   Word32 i;
+   long long s;
+   vint lo = VI_DUP( 0 ), hi = VI_DUP( 0 ), v;
+#ifdef SIMD_AVX2
+   __m256i acc = _mm256_setzero_si256( );
+   __m128i h;
+#else
+   int64x2_t acc = vdupq_n_s64( 0 );
+#endif
+
+
+   for ( i = 0; i < L_SUBFR; i += VL ) {
+      v = VI_LOAD( &in[i] );
+      lo = VI_MIN( lo, v );
+      hi = VI_MAX( hi, v );
+#ifdef SIMD_AVX2
+      /* the squares of the even and of the odd lanes, in 64 bit */
+      acc = _mm256_add_epi64( acc, _mm256_mul_epi32( v, v ) );
+      v = _mm256_srli_epi64( v, 32 );
+      acc = _mm256_add_epi64( acc, _mm256_mul_epi32( v, v ) );
+#else
+      acc = vmlal_s32( acc, vget_low_s32( v ), vget_low_s32( v ) );
+      acc = vmlal_s32( acc, vget_high_s32( v ), vget_high_s32( v ) );
+#endif
+   }
+
+   if ( Out_of_range( lo, -32767, 32767 ) || Out_of_range( hi, -32767, 32767 )
+      )
+      return -1;
+#ifdef SIMD_AVX2
+   h = _mm_add_epi64( _mm256_castsi256_si128( acc ), _mm256_extracti128_si256(
+         acc, 1 ) );
+   s = _mm_cvtsi128_si64( h ) + _mm_extract_epi64( h, 1 );
+#else
+   s = vgetq_lane_s64( acc, 0 ) + vgetq_lane_s64( acc, 1 );
+#endif
+
+   if ( s >= 0x40000000 )
+      return -1;
+   return( Word32 )( s >> 3 );
+}
+
+
+/*
+ * Preemph40_simd
+ *
+ *
+ * Parameters:
+ *    sig               B: signal
+ *    g                 I: preemphasis factor
+ *    mem_pre           I: sample before sig[0]
+ *
+ * Function:
+ *    sig[i] = sig[i] - g * sig[i - 1] >> 15 on the input samples,
+ *    saturated as in Post_Filter
+ *
+ * Returns:
+ *    void
+ */
+SIMD_TARGET static void Preemph40_simd( Word32 sig[], Word32 g, Word32 mem_pre
+      )
+{
+   Word32 i;
+   vint in[L_SUBFR / VL], prev[L_SUBFR / VL];
+
+
+   /* all inputs are loaded before the first store */
+   for ( i = 0; i < L_SUBFR / VL; i++ ) {
+      in[i] = VI_LOAD( &sig[i * VL] );
+      prev[i] = i == 0 ? VI_SHIFT_IN( in[0], mem_pre ) : VI_LOAD( &sig[i * VL - 1]
+            );
+   }
+
+   for ( i = 0; i < L_SUBFR / VL; i++ ) {
+      in[i] = VI_SUB( in[i], VI_SRA( VI_MUL( VI_DUP( g ), prev[i] ), 15 ) );
+      VI_STORE( &sig[i * VL], VI_MAX( VI_MIN( in[i], VI_DUP( 32767 ) ), VI_DUP(
+            -32768 ) ) );
+   }
+}
+#endif
+
+
+/*
+ * Simd_Dec_Set_Kernels
+ *
+ *
+ * Parameters:
+ *    enable            I: fill (1) or clear (0) the table
+ *
+ * Function:
+ *    Fills the kernel table used by the decoder
+ *
+ * Returns:
+ *    void
+ */
+void Simd_Dec_Set_Kernels( int enable )
+{
+   memset( &simd_dec_kernels, 0, sizeof( simd_dec_kernels ) );
+#ifdef VL
+
+   if ( enable ) {
+      simd_dec_kernels.syn_filt = Syn_filt_simd;
+      simd_dec_kernels.residu40 = Residu40_simd;
+      simd_dec_kernels.pred_lt_40 = Pred_lt_40_simd;
+      simd_dec_kernels.ph_disp_pulses = Ph_disp_pulses_simd;
+      simd_dec_kernels.ph_disp_exc = Ph_disp_exc_simd;
+      simd_dec_kernels.energy_new = Energy_new_simd;
+      simd_dec_kernels.preemph40 = Preemph40_simd;
+   }
+#endif
+}
@@ -0,0 +1,73 @@
+/*
+ * ===================================================================
+ *  TS 26.104
+ *  REL-5 V5.4.0 2004-03
+ *  REL-6 V6.1.0 2004-03
+ *  3GPP AMR Floating-point Speech Codec
+ * ===================================================================
+ *
+ */
+
+/*
+ * sp_dec_simd.h
+ *
+ *
+ * Project:
+ *    AMR Floating-Point Codec
+ *
+ * Contains:
+ *    Defines interface to the SIMD (AVX2 / NEON) versions of the
+ *    decoder synthesis and post-filter kernels
+ *
+ */
+#ifndef _SP_DEC_SIMD_H
+#define _SP_DEC_SIMD_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * include files
+ */
+#include "typedef.h"
+
+/*
+ * Kernel table, a NULL entry means the reference C code is used.
+ * The decoder is integer, all kernels are bit exact.
+ */
+typedef struct
+{
+   Word32 ( *syn_filt )( Word32 a[], Word32 x[], Word32 y[], Word32 lg,
+         Word32 mem[], Word32 update );
+   /* returns 1 without output if Residu40 has to use its safe mode */
+   Word32 ( *residu40 )( Word32 a[], Word32 x[], Word32 y[] );
+   /* x0, c1, c2 as set up by Pred_lt_3or6_40, needs T0 >= 18 */
+   void ( *pred_lt_40 )( Word32 exc[], Word32 *x0, const Word32 *c1,
+         const Word32 *c2 );
+   /* the pulses of inno_sav[] at ps_poss[] spread by ph_imp[] into inno[] */
+   void ( *ph_disp_pulses )( Word32 inno[], Word32 inno_sav[], Word32
+         ps_poss[], Word32 nze, const Word32 *ph_imp );
+   /* total excitation of ph_disp */
+   void ( *ph_disp_exc )( Word32 x[], Word32 inno[], Word32 pitch_fac,
+         Word32 cbGain, Word32 tmp_shift );
+   /* returns -1 if an input is out of the 16 bit range or the overflow
+      check fires, the reference code is used then */
+   Word32 ( *energy_new )( Word32 in[] );
+   /* preemphasis of the Post_Filter */
+   void ( *preemph40 )( Word32 sig[], Word32 g, Word32 mem_pre );
+}SimdDecKernels;
+
+extern SimdDecKernels simd_dec_kernels;
+
+/*
+ * Function prototypes
+ */
+
+/*
+ * Fills (enable != 0) or clears the kernel table, called by
+ * Simd_Set_Mode after the CPU check.
+ */
+void Simd_Dec_Set_Kernels( int enable );
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -27,6 +27,7 @@
 #include <float.h>
 #include "sp_enc.h"
 #include "rom_enc.h"
+#include "sp_enc_simd.h"
 
 /*
  * Definition of structures used in encoding process
@@ -299,6 +300,9 @@ typedef struct
 
    Word32 dtx;
 
+   /* search effort, 0 is the standard search */
+   Word16 search_effort;
+
 
    dtx_encState * dtxEncSt;
 
@@ -319,6 +323,28 @@ typedef struct
 
 }Speech_Encode_FrameState;
 
+/* all states of one encoder in one block, see Speech_Encode_Frame_init_in */
+typedef struct
+{
+   Speech_Encode_FrameState frame;
+   Pre_ProcessState pre;
+   cod_amrState cod;
+   clLtpState clLtp;
+   Pitch_frState pitch;
+   lspState lsp;
+   Q_plsfState qPlsf;
+   gainQuantState gainQuant;
+   gc_predState gcPred;
+   gc_predState gcPredUnc;
+   gain_adaptState adapt;
+   pitchOLWghtState pitchOLWght;
+   tonStabState tonStab;
+   lpcState lpc;
+   LevinsonState Levinson;
+   vadState vad;
+   dtx_encState dtxEnc;
+}Speech_Encode_FrameBlock;
+
 
 /*
  * Dotproduct40
@@ -338,6 +364,8 @@ static Float64 Dotproduct40( Float32 *x, Float32 *y )
    Float64 acc;
 
 
+   if ( simd_kernels.dotproduct40 != NULL )
+      return simd_kernels.dotproduct40( x, y );
    acc = x[0] * y[0] + x[1] * y[1] + x[2] * y[2] + x[3] * y[3];
    acc += x[4] * y[4] + x[5] * y[5] + x[6] * y[6] + x[7] * y[7];
    acc += x[8] * y[8] + x[9] * y[9] + x[10] * y[10] + x[11] * y[11];
@@ -1591,6 +1619,49 @@ static void Int_lpc_1to3( Float32 lsp_old[], Float32 lsp_new[], Float32 az[] )
 }
 
 
+/*
+ * lsp_unq
+ *
+ *
+ * Parameters:
+ *    req_mode          I: requested mode
+ *    lsp_old           I: old LSP vector
+ *    az                B: interpolated LP parameters
+ *    lsp_mid           O: lsp vector of the 2nd subframe, MR122 only
+ *    lsp_new           O: new lsp vector
+ *
+ * Function:
+ *    From A(z) to lsp. Interpolation of the unquantized LP parameters
+ *
+ * Returns:
+ *    void
+ */
+static void lsp_unq( enum Mode req_mode, Float32 *lsp_old, Float32 az[],
+      Float32 lsp_mid[], Float32 lsp_new[] )
+{
+   if ( req_mode == MR122 ) {
+      Az_lsp( &az[MP1], lsp_mid, lsp_old );
+      Az_lsp( &az[MP1 * 3], lsp_new, lsp_mid );
+
+      /*
+       * Find interpolated LPC parameters in all subframes.
+       * The interpolated parameters are in array A_t[] of size (M+1)*4
+       */
+      Int_lpc_1and3_2( lsp_old, lsp_mid, lsp_new, az );
+   }
+   else {
+      /* From A(z) to lsp */
+      Az_lsp( &az[MP1 * 3], lsp_new, lsp_old );
+
+      /*
+       * Find interpolated LPC parameters in all subframes.
+       * The interpolated parameters are in array A_t[] of size (M+1)*4
+       */
+      Int_lpc_1to3_2( lsp_old, lsp_new, az );
+   }
+}
+
+
 /*
  * lsp
  *
@@ -1601,38 +1672,28 @@ static void Int_lpc_1to3( Float32 lsp_old[], Float32 lsp_new[], Float32 az[] )
  *    lsp_old           B: old LSP vector
  *    lsp_old_q         B: old quantized LSP vector
  *    past_rq           B: past quantized residual
- *    az                B: interpolated LP parameters
+ *    lsp_mid           I: lsp vector of the 2nd subframe, MR122 only
+ *    lsp_new           I: new lsp vector
  *    azQ               O: quantization interpol. LP parameters
- *    lsp_new           O: new lsp vector
  *    anap              O: analysis parameters
  *
  * Function:
- *    From A(z) to lsp. LSP quantization and interpolation
+ *    LSP quantization and interpolation, the unquantized
+ *    LSPs are found by lsp_unq
  *
  * Returns:
  *    void
  */
 static void lsp( enum Mode req_mode, enum Mode used_mode, Float32 *lsp_old,
-      Float32 *lsp_old_q, Float32 *past_rq, Float32 az[], Float32 azQ[], Float32
-      lsp_new[], Word16 **anap )
+      Float32 *lsp_old_q, Float32 *past_rq, Float32 lsp_mid[], Float32
+      lsp_new[], Float32 azQ[], Word16 **anap )
 {
    Float32 lsp_new_q[M];   /* LSPs at 4th subframe */
-   Float32 lsp_mid[M], lsp_mid_q[M];   /* LSPs at 2nd subframe */
+   Float32 lsp_mid_q[M];   /* LSPs at 2nd subframe */
    Word32 pred_init_i;   /* init index for MA prediction in DTX mode */
 
 
    if ( req_mode == MR122 ) {
-      Az_lsp( &az[MP1], lsp_mid, lsp_old );
-      Az_lsp( &az[MP1 * 3], lsp_new, lsp_mid );
-
-      /*
-       * Find interpolated LPC parameters in all subframes
-       * (both quantized and unquantized).
-       * The interpolated parameters are in array A_t[] of size (M+1)*4
-       * and the quantized interpolated parameters are in array Aq_t[]
-       */
-      Int_lpc_1and3_2( lsp_old, lsp_mid, lsp_new, az );
-
       if ( used_mode != MRDTX ) {
          /* LSP quantization (lsp_mid[] and lsp_new[] jointly quantized) */
          Q_plsf_5( past_rq, lsp_mid, lsp_new, lsp_mid_q, lsp_new_q, *anap );
@@ -1643,17 +1704,6 @@ static void lsp( enum Mode req_mode, enum Mode used_mode, Float32 *lsp_old,
       }
    }
    else {
-      /* From A(z) to lsp */
-      Az_lsp( &az[MP1 * 3], lsp_new, lsp_old );
-
-      /*
-       * Find interpolated LPC parameters in all subframes
-       * (both quantized and unquantized).
-       * The interpolated parameters are in array A_t[] of size (M+1)*4
-       * and the quantized interpolated parameters are in array Aq_t[]
-       */
-      Int_lpc_1to3_2( lsp_old, lsp_new, az );
-
       /* LSP quantization */
       if ( used_mode != MRDTX ) {
          Q_plsf_3( req_mode, past_rq, lsp_new, lsp_new_q, *anap, &pred_init_i );
@@ -1975,6 +2025,58 @@ static void Syn_filt( Float32 a[], Float32 x[], Float32 y[], Float32 mem[],
 }
 
 
+/*
+ * Syn_filt_pair
+ *
+ *
+ * Parameters:
+ *    a0, a1            I: prediction coefficients [M+1] of each filter
+ *    x0, x1            I: input signal of each filter
+ *    y0, y1            O: output signal of each filter
+ *    mem0, mem1        I: memory associated with each filtering
+ *
+ * Function:
+ *    Perform two independent synthesis filterings through 1/A(z)
+ *    in lock-step, memory is not updated. Every output of Syn_filt
+ *    waits on the sum of the previous one, interleaving two
+ *    independent filters hides that latency. Each filter is
+ *    bit exact with Syn_filt.
+ *
+ * Returns:
+ *    void
+ */
+static void Syn_filt_pair( Float32 a0[], Float32 x0[], Float32 y0[], Float32
+      mem0[], Float32 a1[], Float32 x1[], Float32 y1[], Float32 mem1[] )
+{
+   Float64 tmp0[M + L_SUBFR], tmp1[M + L_SUBFR];
+   Float64 sum0, sum1;
+   Word32 i, j;
+
+
+   /* Copy mem[] to tmp[] */
+   for ( i = 0; i < M; i++ ) {
+      tmp0[i] = mem0[i];
+      tmp1[i] = mem1[i];
+   }
+
+   /* Do the filtering, one sample of both filters at a time */
+   for ( i = 0; i < L_SUBFR; i++ ) {
+      sum0 = x0[i] * a0[0];
+      sum1 = x1[i] * a1[0];
+
+      for ( j = 1; j <= M; j++ ) {
+         sum0 -= a0[j] * tmp0[M + i - j];
+         sum1 -= a1[j] * tmp1[M + i - j];
+      }
+      tmp0[M + i] = sum0;
+      tmp1[M + i] = sum1;
+      y0[i] = ( Float32 )sum0;
+      y1[i] = ( Float32 )sum1;
+   }
+   return;
+}
+
+
 /*
  * pre_big
  *
@@ -2088,6 +2190,11 @@ static void comp_corr( Float32 sig[], Word32 L_frame, Word32 lag_max, Word32
    Float32 T0;
 
 
+   if ( simd_kernels.comp_corr != NULL ) {
+      simd_kernels.comp_corr( sig, L_frame, lag_max, lag_min, corr );
+      return;
+   }
+
    for ( i = lag_max; i >= lag_min; i-- ) {
       p = sig;
       p1 = &sig[ - i];
@@ -2118,6 +2225,52 @@ static void comp_corr( Float32 sig[], Word32 L_frame, Word32 lag_max, Word32
 }
 
 
+/*
+ * comp_corr_coarse
+ *
+ *
+ * Parameters:
+ *    sig               I: signal
+ *    L_frame           I: length of frame to compute pitch
+ *    lag_max           I: maximum lag
+ *    lag_min           I: minimum lag
+ *    corr              O: correlation of selected lag
+ *
+ * Function:
+ *    As comp_corr, but only every second lag is computed, the lags
+ *    in between are interpolated. The closed-loop search around the
+ *    open-loop lag corrects the error.
+ *
+ * Returns:
+ *    void
+ */
+static void comp_corr_coarse( Float32 sig[], Word32 L_frame, Word32 lag_max,
+      Word32 lag_min, Float32 corr[] )
+{
+   Word32 i, j;
+   Float32 T0;
+
+
+   for ( i = lag_max; i >= lag_min; i -= 2 ) {
+      T0 = 0.0F;
+
+      for ( j = 0; j < L_frame; j += 40 ) {
+         T0 += (Float32)Dotproduct40( &sig[j], &sig[j - i] );
+      }
+      corr[ - i] = T0;
+   }
+
+   for ( i = lag_max - 1; i > lag_min; i -= 2 ) {
+      corr[ - i] = 0.5F * ( corr[ - i - 1] + corr[ - i + 1] );
+   }
+
+   if ( ( ( lag_max - lag_min ) & 1 ) != 0 ) {
+      corr[ - lag_min] = corr[ - lag_min - 1];
+   }
+   return;
+}
+
+
 /*
  * vad_tone_detection
  *
@@ -2339,6 +2492,7 @@ static void vad_tone_detection_update( vadState *st, Word16 one_lag_per_frame )
  *    L_frame        I: length of frame to compute pitch
  *    dtx            I: DTX flag
  *    idx            I: frame index
+ *    effort         I: search effort, 0 is the standard search
  *
  * Function:
  *    Compute the open loop pitch lag.
@@ -2385,7 +2539,8 @@ static void vad_tone_detection_update( vadState *st, Word16 one_lag_per_frame )
  *    void
  */
 static Word32 Pitch_ol( enum Mode mode, vadState *vadSt, Float32 signal[],
-      Word32 pit_min, Word32 pit_max, Word16 L_frame, Word32 dtx, Word16 idx )
+      Word32 pit_min, Word32 pit_max, Word16 L_frame, Word32 dtx, Word16 idx,
+      Word16 effort )
 {
    Float32 corr[PIT_MAX + 1];
    Float32 max1, max2, max3, p_max1, p_max2, p_max3;
@@ -2416,7 +2571,10 @@ static Word32 Pitch_ol( enum Mode mode, vadState *vadSt, Float32 signal[],
    /*        79             */
    /* O(k) = SUM Sw(n)*Sw(n-k)   */
    /*        n=0               */
-   comp_corr( signal, L_frame, pit_max, pit_min, corr_ptr );
+   if ( effort > 1 )
+      comp_corr_coarse( signal, L_frame, pit_max, pit_min, corr_ptr );
+   else
+      comp_corr( signal, L_frame, pit_max, pit_min, corr_ptr );
 
 #ifdef VAD2
    /* Find a maximum for each section.	*/
@@ -2649,6 +2807,7 @@ static Word32 gmed_n( Word32 ind[], Word32 n )
  *    ol_gain_flg    I: OL gain flag
  *    idx            I: frame index
  *    dtx            I: DTX flag
+ *    effort         I: search effort, 0 is the standard search
  *
  * Function:
  *    Open-loop pitch search with weight
@@ -2675,7 +2834,7 @@ static Word32 gmed_n( Word32 ind[], Word32 n )
  */
 static Word32 Pitch_ol_wgh( Word32 *old_T0_med, Word16 *wght_flg, Float32 *ada_w,
       vadState *vadSt, Float32 signal[], Word32 old_lags[], Float32 ol_gain_flg[],
-      Word16 idx, Word32 dtx )
+      Word16 idx, Word32 dtx, Word16 effort )
 {
    Float32 corr[PIT_MAX + 1];
 #ifndef VAD2
@@ -2687,7 +2846,10 @@ static Word32 Pitch_ol_wgh( Word32 *old_T0_med, Word16 *wght_flg, Float32 *ada_w
 
    /* calculate all coreelations of signal, from pit_min to pit_max */
    corrPtr = &corr[PIT_MAX];
-   comp_corr( signal, L_FRAME_BY2, PIT_MAX, PIT_MIN, corrPtr );
+   if ( effort > 1 )
+      comp_corr_coarse( signal, L_FRAME_BY2, PIT_MAX, PIT_MIN, corrPtr );
+   else
+      comp_corr( signal, L_FRAME_BY2, PIT_MAX, PIT_MIN, corrPtr );
    p_max1 = Lag_max_wght( vadSt, corrPtr, signal, *old_T0_med,
          &max1, *wght_flg, &ol_gain_flg[idx], dtx );
 
@@ -2745,6 +2907,7 @@ static Word32 Pitch_ol_wgh( Word32 *old_T0_med, Word16 *wght_flg, Float32 *ada_w
  *    ol_gain_flg       I: OL gain flag
  *    dtx               I: DTX flag
  *    idx               I: frame index
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Compute the open loop pitch lag.
@@ -2769,7 +2932,7 @@ static Word32 Pitch_ol_wgh( Word32 *old_T0_med, Word16 *wght_flg, Float32 *ada_w
  */
 static void ol_ltp( enum Mode mode, vadState *vadSt, Float32 wsp[], Word32 *T_op
       , Float32 ol_gain_flg[], Word32 *old_T0_med, Word16 *wght_flg, Float32 *ada_w
-      , Word32 *old_lags, Word32 dtx, Word16 idx )
+      , Word32 *old_lags, Word32 dtx, Word16 idx, Word16 effort )
 {
    if ( mode != MR102 ) {
       ol_gain_flg[0] = 0;
@@ -2777,20 +2940,21 @@ static void ol_ltp( enum Mode mode, vadState *vadSt, Float32 wsp[], Word32 *T_op
    }
 
    if ( ( mode == MR475 ) || ( mode == MR515 ) ) {
-      *T_op = Pitch_ol( mode, vadSt, wsp, PIT_MIN, PIT_MAX, L_FRAME, dtx, idx );
+      *T_op = Pitch_ol( mode, vadSt, wsp, PIT_MIN, PIT_MAX, L_FRAME, dtx, idx,
+            effort );
    }
    else {
       if ( mode <= MR795 ) {
          *T_op = Pitch_ol( mode, vadSt, wsp, PIT_MIN, PIT_MAX, L_FRAME_BY2, dtx,
-               idx );
+               idx, effort );
       }
       else if ( mode == MR102 ) {
          *T_op = Pitch_ol_wgh( old_T0_med, wght_flg, ada_w, vadSt, wsp, old_lags,
-            ol_gain_flg, idx, dtx );
+            ol_gain_flg, idx, dtx, effort );
       }
       else {
          *T_op = Pitch_ol( mode, vadSt, wsp, PIT_MIN_MR122, PIT_MAX, L_FRAME_BY2
-               , dtx, idx );
+               , dtx, idx, effort );
       }
    }
 }
@@ -2879,14 +3043,7 @@ static void subframePreProc( enum Mode mode, const Float32 gamma1[], const
    /* Find the weighted LPC coefficients for the weighting filter. */
    Weight_Ai( A, g1, Ap1 );
    Weight_Ai( A, gamma2, Ap2 );
-
-   /*
-    * Compute impulse response, h1[],
-    * of weighted synthesis filter A(z/g1)/A(z/g2)
-    */
    memcpy( ai_zero, Ap1, MP1 <<2 );
-   Syn_filt( Aq, ai_zero, h1, zero, 0 );
-   Syn_filt( Ap2, h1, h1, zero, 0 );
 
    /*
     * Find the target vector for pitch search:
@@ -2895,12 +3052,17 @@ static void subframePreProc( enum Mode mode, const Float32 gamma1[], const
    Residu( Aq, speech, res2 );
    memcpy( exc, res2, L_SUBFR <<2 );
 
-   /* Synthesis filter */
-   Syn_filt( Aq, exc, error, mem_err, 0 );
+   /*
+    * Compute impulse response, h1[],
+    * of weighted synthesis filter A(z/g1)/A(z/g2)
+    * together with the independent synthesis and weighting
+    * of the residual for the target vector
+    */
+   Syn_filt_pair( Aq, ai_zero, h1, zero, Aq, exc, error, mem_err );
    Residu( Ap1, error, xn );
 
-   /* target signal xn[] */
-   Syn_filt( Ap2, xn, xn, mem_w0, 0 );
+   /* second stage of h1[] and target signal xn[] */
+   Syn_filt_pair( Ap2, h1, h1, zero, Ap2, xn, xn, mem_w0 );
 }
 
 
@@ -3121,6 +3283,7 @@ static Float32 Interpol_3or6( Float32 *x, Word32 frac, Word16 flag3 )
  *    last_frac         I: endpoint of search
  *    corr              I: normalized correlation
  *    flag3             I: if set, upsampling rate = 3 (6 otherwise)
+ *    step              I: distance of the tested fractions
  *
  * Function:
  *    Find fractional pitch
@@ -3135,7 +3298,7 @@ static Float32 Interpol_3or6( Float32 *x, Word32 frac, Word16 flag3 )
  *    void
  */
 static void searchFrac( Word32 *lag, Word32 *frac, Word16 last_frac, Float32
-      corr[], Word16 flag3 )
+      corr[], Word16 flag3, Word16 step )
 {
    Float32 max, corr_int;
    Word32 i;
@@ -3147,7 +3310,7 @@ static void searchFrac( Word32 *lag, Word32 *frac, Word16 last_frac, Float32
     */
    max = Interpol_3or6( &corr[ * lag], *frac, flag3 );
 
-   for ( i = *frac + 1; i <= last_frac; i++ ) {
+   for ( i = *frac + step; i <= last_frac; i += step ) {
       corr_int = Interpol_3or6( &corr[ * lag], i, flag3 );
 
       if ( corr_int > max ) {
@@ -3338,6 +3501,7 @@ static Word32 Enc_lag6( Word32 T0, Word32 T0_frac, Word32 T0_min, Word16
  *    pit_frac          O: pitch period (fractional)
  *    resu3             O: subsample resolution 1/3 (=1) or 1/6 (=0)
  *    ana_index         O: index of encoding
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Closed-loop pitch search
@@ -3397,7 +3561,7 @@ static Word32 Enc_lag6( Word32 T0, Word32 T0_frac, Word32 T0_min, Word16
  */
 static Word32 Pitch_fr( Word32 *T0_prev_subframe, enum Mode mode, Word32 T_op[],
       Float32 exc[], Float32 xn[], Float32 h[], Word16 i_subfr, Word32 *pit_frac
-      , Word16 *resu3, Word32 *ana_index )
+      , Word16 *resu3, Word32 *ana_index, Word16 effort )
 {
    Float32 corr_v[40];
    Float32 max;
@@ -3407,8 +3571,8 @@ static Word32 Pitch_fr( Word32 *T0_prev_subframe, enum Mode mode, Word32 T_op[],
    Word16 max_frac_lag, flag3, flag4, last_frac;
    Word16 delta_int_low, delta_int_range, delta_frc_low, delta_frc_range;
    Word16 pit_min;
-   Word16 frame_offset;
-   Word16 delta_search;
+   Word16 frame_offset = 0;
+   Word16 delta_search, margin;
 
 
    /* set mode specific variables */
@@ -3466,19 +3630,32 @@ static Word32 Pitch_fr( Word32 *T0_prev_subframe, enum Mode mode, Word32 T_op[],
             PIT_MAX, &T0_min, &T0_max );
    }
 
-   /* Find interval to compute normalized correlation */
-   t_min = T0_min - L_INTER_SRCH;
-   t_max = T0_max + L_INTER_SRCH;
-   corr = &corr_v[ - t_min];
+   /* interval of the integer search */
+   t_min = T0_min;
+   t_max = T0_max;
+
+   if ( effort > 2 ) {
+      /* only the lags next to the open-loop or the previous lag */
+      lag = delta_search != 0 ? *T0_prev_subframe : T_op[frame_offset];
+      t_min = lag - 1 < T0_min ? T0_min : lag - 1;
+      t_max = lag + 1 > T0_max ? T0_max : lag + 1;
+   }
+
+   /*
+    * Find interval to compute normalized correlation,
+    * without fractional search no interpolation margin is needed
+    */
+   margin = ( Word16 )( effort > 1 ? 0 : L_INTER_SRCH );
+   corr = &corr_v[margin - t_min];
 
    /* Compute normalized correlation between target and filtered excitation */
-   Norm_Corr( exc, xn, h, t_min, t_max, corr );
+   Norm_Corr( exc, xn, h, t_min - margin, t_max + margin, corr );
 
    /* Find integer pitch */
-   max = corr[T0_min];
-   lag = T0_min;
+   max = corr[t_min];
+   lag = t_min;
 
-   for ( i = T0_min + 1; i <= T0_max; i++ ) {
+   for ( i = t_min + 1; i <= t_max; i++ ) {
       if ( corr[i] >= max ) {
          max = corr[i];
          lag = i;
@@ -3486,7 +3663,11 @@ static Word32 Pitch_fr( Word32 *T0_prev_subframe, enum Mode mode, Word32 T_op[],
    }
 
    /* Find fractional pitch   */
-   if ( ( delta_search == 0 ) && ( lag > max_frac_lag ) ) {
+   if ( effort > 1 ) {
+      /* integer pitch only */
+      frac = 0;
+   }
+   else if ( ( delta_search == 0 ) && ( lag > max_frac_lag ) ) {
       /*
        * full search and integer pitch greater than max_frac_lag
        * fractional search is not needed, set fractional to zero
@@ -3515,17 +3696,17 @@ static Word32 Pitch_fr( Word32 *T0_prev_subframe, enum Mode mode, Word32 T_op[],
 
          if ( ( lag == tmp_lag ) || ( lag == ( tmp_lag - 1 ) ) ) {
             /* normal search in fractions around T0 */
-            searchFrac( &lag, &frac, last_frac, corr, flag3 );
+            searchFrac( &lag, &frac, last_frac, corr, flag3, 1 );
          }
          else if ( lag == ( tmp_lag - 2 ) ) {
             /* limit search around T0 to the right side */
             frac = 0;
-            searchFrac( &lag, &frac, last_frac, corr, flag3 );
+            searchFrac( &lag, &frac, last_frac, corr, flag3, 1 );
          }
          else if ( lag == ( tmp_lag + 1 ) ) {
             /* limit search around T0 to the left side */
             last_frac = 0;
-            searchFrac( &lag, &frac, last_frac, corr, flag3 );
+            searchFrac( &lag, &frac, last_frac, corr, flag3, 1 );
          }
          else {
             /* no fractional search */
@@ -3534,8 +3715,9 @@ static Word32 Pitch_fr( Word32 *T0_prev_subframe, enum Mode mode, Word32 T_op[],
       }
       else
 
-         /* test the fractions around T0 */
-         searchFrac( &lag, &frac, last_frac, corr, flag3 );
+         /* test the fractions around T0, 1/6 resolution on a 1/3 grid */
+         searchFrac( &lag, &frac, last_frac, corr, flag3, ( Word16 )( ( (
+               effort > 0 ) && ( flag3 == 0 ) ) ? 2 : 1 ) );
    }
 
    /*
@@ -3923,6 +4105,7 @@ static Word16 q_gain_pitch( enum Mode mode, Float32 gp_limit, Float32 *gain,
  *    gCoeff[]          O: Correlations between xn, y1, & y2
  *    anap              O: Analysis parameters
  *    gp_limit          O: pitch gain limit
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Closed-loop ltp search
@@ -3944,7 +4127,7 @@ static void cl_ltp( Word32 *T0_prev_subframe, Float32 *gp, enum Mode mode,
       Word16 frame_offset, Word32 T_op[], Float32 *h1, Float32 *exc, Float32
       res2[], Float32 xn[], Word16 lsp_flag, Float32 xn2[], Float32 y1[], Word32
       *T0, Word32 *T0_frac, Float32 *gain_pit, Float32 gCoeff[], Word16 **anap,
-      Float32 *gp_limit )
+      Float32 *gp_limit, Word16 effort )
 {
    Float32 s;
    Word32 i, n;
@@ -3958,7 +4141,7 @@ static void cl_ltp( Word32 *T0_prev_subframe, Float32 *gp, enum Mode mode,
 
    /* Closed-loop fractional pitch search */
    *T0 = Pitch_fr( T0_prev_subframe, mode, T_op, exc, xn, h1, frame_offset,
-         T0_frac, &resu3, &i );
+         T0_frac, &resu3, &i, effort );
    *( *anap )++ = ( Word16 )i;
 
    /*
@@ -4086,6 +4269,10 @@ static void cor_h_x( Float32 h[], Float32 x[], Float32 dn[] )
    Word32 i;
 
 
+   if ( simd_kernels.cor_h_x != NULL ) {
+      simd_kernels.cor_h_x( h, x, dn );
+      return;
+   }
    dn[0] = (Float32)Dotproduct40( h, x );
 
    for ( i = 1; i < L_CODE; i++ )
@@ -4178,6 +4365,10 @@ static void cor_h( Float32 h[], Float32 sign[], Float32 rr[][L_CODE] )
    Word32 ii, total_loops, four_loops;
 
 
+   if ( simd_kernels.cor_h != NULL ) {
+      simd_kernels.cor_h( h, sign, rr );
+      return;
+   }
    sum = 0.0F;
 
    /* Compute diagonal matrix of autocorrelation of h */
@@ -4458,6 +4649,36 @@ static void cor_h( Float32 h[], Float32 sign[], Float32 rr[][L_CODE] )
 }
 
 
+/*
+ * max_pos
+ *
+ *
+ * Parameters:
+ *    dn                I: correlation between target and h[], sign included
+ *    pos               I: first position of the track
+ *    step              I: distance between the track positions
+ *    skip              I: position already taken, -1 for none
+ *
+ * Function:
+ *    Finds the position of the largest dn[] in a track. Search effort 3
+ *    places the pulses with it one at a time, without rr[][].
+ *
+ * Returns:
+ *    pulse position
+ */
+static Word32 max_pos( Float32 dn[], Word32 pos, Word32 step, Word32 skip )
+{
+   Word32 i, best = -1;
+
+
+   for ( i = pos; i < L_CODE; i += step ) {
+      if ( ( i != skip ) && ( ( best < 0 ) || ( dn[i] > dn[best] ) ) )
+         best = i;
+   }
+   return best;
+}
+
+
 /*
  * search_2i40_9bits
  *
@@ -4467,6 +4688,7 @@ static void cor_h( Float32 h[], Float32 sign[], Float32 rr[][L_CODE] )
  *    dn                I: correlation between target and h[]
  *    rr                I: matrix of autocorrelation
  *    codvec            O: algebraic codebook vector
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Search the best codevector; determine positions of the 2 pulses
@@ -4500,14 +4722,15 @@ static void cor_h( Float32 h[], Float32 sign[], Float32 rr[][L_CODE] )
  *    void
  */
 static void search_2i40_9bits( Word16 subNr, Float32 dn[], Float32 rr[][L_CODE],
-      Word32 codvec[] )
+      Word32 codvec[], Word16 effort )
 {
    Float32 ps0, ps1, psk, alp, alp0, alp1, alpk, sq, sq1;
    Word32 i0, i1, ix, i;
    Word16 ipos[2];
-   Word16 track1;
+   Word16 track1, nb_track1;
 
 
+   nb_track1 = ( Word16 )( effort > 0 ? 1 : 2 );
    psk = -1;
    alpk = 1;
 
@@ -4515,8 +4738,25 @@ static void search_2i40_9bits( Word16 subNr, Float32 dn[], Float32 rr[][L_CODE],
       codvec[i] = i;
    }
 
+   if ( effort > 2 ) {
+      /* largest dn[] of each track, the better track pair */
+      for ( track1 = 0; track1 < 2; track1++ ) {
+         i0 = max_pos( dn, startPos[( subNr << 1 ) + ( track1 << 3 )], STEP,
+               -1 );
+         i1 = max_pos( dn, startPos[( subNr << 1 ) + 1 + ( track1 << 3 )], STEP,
+               -1 );
+
+         if ( ( dn[i0] + dn[i1] ) > psk ) {
+            psk = dn[i0] + dn[i1];
+            codvec[0] = i0;
+            codvec[1] = i1;
+         }
+      }
+      return;
+   }
+
    /* main loop: try 2x4  tracks	*/
-   for ( track1 = 0; track1 < 2; track1++ ) {
+   for ( track1 = 0; track1 < nb_track1; track1++ ) {
       ipos[0] = startPos[( subNr << 1 ) + ( track1 << 3 )];
       ipos[1] = startPos[( subNr << 1 ) + 1 + ( track1 << 3 )];
 
@@ -4666,6 +4906,7 @@ static void build_code_2i40_9bits( Word16 subNr, Word32 codvec[], Float32
  *    code              O: innovative codebook
  *    y                 O: filtered fixed codebook excitation
  *    anap              O: analysis parameters
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Searches a 9 bit algebraic codebook containing 2 pulses
@@ -4681,7 +4922,8 @@ static void build_code_2i40_9bits( Word16 subNr, Word32 codvec[], Float32
  *    void
  */
 static void code_2i40_9bits( Word16 subNr, Float32 x[], Float32 h[], Word32 T0,
-      Float32 pitch_sharp, Float32 code[], Float32 y[], Word16 *anap )
+      Float32 pitch_sharp, Float32 code[], Float32 y[], Word16 *anap, Word16
+      effort )
 {
    Float32 rr[L_CODE][L_CODE];
    Float32 dn[L_CODE], dn_sign[L_CODE], dn2[L_CODE];
@@ -4695,8 +4937,9 @@ static void code_2i40_9bits( Word16 subNr, Float32 x[], Float32 h[], Word32 T0,
       }
    cor_h_x( h, x, dn );
    set_sign( dn, dn_sign, dn2, 8 );
-   cor_h( h, dn_sign, rr );
-   search_2i40_9bits( subNr, dn, rr, codvec );
+   if ( effort < 3 )
+      cor_h( h, dn_sign, rr );
+   search_2i40_9bits( subNr, dn, rr, codvec, effort );
    build_code_2i40_9bits( subNr, codvec, dn_sign, code, h, y, anap );
 
       /*
@@ -4718,6 +4961,7 @@ static void code_2i40_9bits( Word16 subNr, Float32 x[], Float32 h[], Word32 T0,
  *    dn                I: correlation between target and h[]
  *    rr                I: matrix of autocorrelation
  *    codvec            O: algebraic codebook vector
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Search the best codevector; determine positions of the 2 pulses
@@ -4727,15 +4971,34 @@ static void code_2i40_9bits( Word16 subNr, Float32 x[], Float32 h[], Word32 T0,
  *    void
  */
 static void search_2i40_11bits( Float32 dn[], Float32 rr[][L_CODE], Word32
-      codvec[] )
+      codvec[], Word16 effort )
 {
    Float64 alpk, alp, alp0, alp1;
    Float32 psk, ps0, ps1, sq, sq1;
    Word32 i, i0, i1, ix = 0;
    Word16 ipos[2];
-   Word16 track1, track2;
+   Word16 track1, track2, nb_track1, nb_track2;
+
+
+   if ( effort > 2 ) {
+      /* largest dn[] over the start positions of each pulse */
+      codvec[0] = max_pos( dn, startPos1[0], STEP, -1 );
+      i0 = max_pos( dn, startPos1[1], STEP, -1 );
 
+      if ( dn[i0] > dn[codvec[0]] )
+         codvec[0] = i0;
+      codvec[1] = max_pos( dn, startPos2[0], STEP, -1 );
 
+      for ( track2 = 1; track2 < 4; track2++ ) {
+         i1 = max_pos( dn, startPos2[track2], STEP, -1 );
+
+         if ( dn[i1] > dn[codvec[1]] )
+            codvec[1] = i1;
+      }
+      return;
+   }
+   nb_track1 = ( Word16 )( effort > 1 ? 1 : 2 );
+   nb_track2 = ( Word16 )( 4 >> effort );
    psk = -1;
    alpk = 1;
 
@@ -4746,8 +5009,8 @@ static void search_2i40_11bits( Float32 dn[], Float32 rr[][L_CODE], Word32
    /*
     * main loop: try 2x4  tracks.
     */
-   for ( track1 = 0; track1 < 2; track1++ ) {
-      for ( track2 = 0; track2 < 4; track2++ ) {
+   for ( track1 = 0; track1 < nb_track1; track1++ ) {
+      for ( track2 = 0; track2 < nb_track2; track2++ ) {
          /* fix starting position */
          ipos[0] = startPos1[track1];
          ipos[1] = startPos2[track2];
@@ -4898,6 +5161,7 @@ static void build_code_2i40_11bits( Word32 codvec[], Float32 dn_sign[], Float32
  *    code              O: innovative codebook
  *    y                 O: filtered fixed codebook excitation
  *    anap              O: analysis parameters
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Searches a 11 bit algebraic codebook containing 2 pulses
@@ -4919,7 +5183,7 @@ static void build_code_2i40_11bits( Word32 codvec[], Float32 dn_sign[], Float32
  *    void
  */
 static void code_2i40_11bits( Float32 x[], Float32 h[], Word32 T0, Float32
-      pitch_sharp, Float32 code[], Float32 y[], Word16 *anap )
+      pitch_sharp, Float32 code[], Float32 y[], Word16 *anap, Word16 effort )
 {
    Float32 rr[L_CODE][L_CODE];
    Float32 dn[L_CODE], dn2[L_CODE], dn_sign[L_CODE];
@@ -4934,8 +5198,9 @@ static void code_2i40_11bits( Float32 x[], Float32 h[], Word32 T0, Float32
    }
    cor_h_x( h, x, dn );
    set_sign( dn, dn_sign, dn2, 8 );
-   cor_h( h, dn_sign, rr );
-   search_2i40_11bits( dn, rr, codvec );
+   if ( effort < 3 )
+      cor_h( h, dn_sign, rr );
+   search_2i40_11bits( dn, rr, codvec, effort );
    build_code_2i40_11bits( codvec, dn_sign, code, h, y, anap );
 
    /*
@@ -4959,6 +5224,7 @@ static void code_2i40_11bits( Float32 x[], Float32 h[], Word32 T0, Float32
  *    dn2               I: maximum of corr. in each track
  *    rr                I: matrix of autocorrelation
  *    codvec            O: algebraic codebook vector
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Searches a 14 bit algebraic codebook containing 3 pulses in
@@ -4968,26 +5234,39 @@ static void code_2i40_11bits( Float32 x[], Float32 h[], Word32 T0, Float32
  *    void
  */
 static void search_3i40( Float32 dn[], Float32 dn2[], Float32 rr[][L_CODE],
-      Word32 codvec[] )
+      Word32 codvec[], Word16 effort )
 {
    Float32 psk, ps0, ps1, sq, sq1, alpk, alp, alp0, alp1, ps = 0.0F;
    Float32 *rr2, *rr1, *rr0, *pdn, *pdn_max;
    Word32 ipos[3];
-   Word32 i0, i1, i2, ix, i, pos, track1, track2;
+   Word32 i0, i1, i2, ix, i, pos, track1, track2, max_track, nb_perm;
+
 
+   if ( effort > 2 ) {
+      /* largest dn[] of track 0, of tracks 1 and 3 and of tracks 2 and 4 */
+      codvec[0] = max_pos( dn, 0, STEP, -1 );
 
+      for ( i = 1; i < 3; i++ ) {
+         i0 = max_pos( dn, i, STEP, -1 );
+         i1 = max_pos( dn, i + 2, STEP, -1 );
+         codvec[i] = dn[i1] > dn[i0] ? i1 : i0;
+      }
+      return;
+   }
+   max_track = effort > 1 ? 3 : 5;
+   nb_perm = effort > 0 ? 1 : 3;
    psk = -1.0F;
    alpk = 1.0F;
 
-   for ( track1 = 1; track1 < 4; track1 += 2 ) {
-      for ( track2 = 2; track2 < 5; track2 += 2 ) {
+   for ( track1 = 1; track1 < max_track - 1; track1 += 2 ) {
+      for ( track2 = 2; track2 < max_track; track2 += 2 ) {
          /* fix starting position */
          ipos[0] = 0;
          ipos[1] = track1;
          ipos[2] = track2;
 
          /* main loop: try 3 tracks */
-         for ( i = 0; i < 3; i++ ) {
+         for ( i = 0; i < nb_perm; i++ ) {
             /* i0 loop: try 8 positions */
             for ( i0 = ipos[0]; i0 < L_CODE; i0 += STEP ) {
                if ( dn2[i0] >= 0 ) {
@@ -5174,6 +5453,7 @@ static void build_code_3i40_14bits( Word32 codvec[], Float32 dn_sign[], Float32
  *    code              O: innovative codebook
  *    y                 O: filtered fixed codebook excitation
  *    anap              O: analysis parameters
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Searches a 14 bit algebraic codebook containing 3 pulses
@@ -5194,7 +5474,7 @@ static void build_code_3i40_14bits( Word32 codvec[], Float32 dn_sign[], Float32
  *    void
  */
 static void code_3i40_14bits( Float32 x[], Float32 h[], Word32 T0, Float32
-      pitch_sharp, Float32 code[], Float32 y[], Word16 *anap )
+      pitch_sharp, Float32 code[], Float32 y[], Word16 *anap, Word16 effort )
 {
    Float32 rr[L_CODE][L_CODE];
    Float32 dn[L_CODE], dn2[L_CODE], dn_sign[L_CODE];
@@ -5209,8 +5489,9 @@ static void code_3i40_14bits( Float32 x[], Float32 h[], Word32 T0, Float32
    }
    cor_h_x( h, x, dn );
    set_sign( dn, dn_sign, dn2, 6 );
-   cor_h( h, dn_sign, rr );
-   search_3i40( dn, dn2, rr, codvec );
+   if ( effort < 3 )
+      cor_h( h, dn_sign, rr );
+   search_3i40( dn, dn2, rr, codvec, effort );
 
    /* function result */
    build_code_3i40_14bits( codvec, dn_sign, code, h, y, anap );
@@ -5236,6 +5517,7 @@ static void code_3i40_14bits( Float32 x[], Float32 h[], Word32 T0, Float32
  *    dn2               I: maximum of corr. in each track.
  *    rr                I: matrix of autocorrelation
  *    codvec            O: algebraic codebook vector
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Search the best codevector; determine positions of the 4 pulses
@@ -5245,13 +5527,26 @@ static void code_3i40_14bits( Float32 x[], Float32 h[], Word32 T0, Float32
  *    void
  */
 static void search_4i40( Float32 dn[], Float32 dn2[], Float32 rr[][L_CODE],
-      Word32 codvec[] )
+      Word32 codvec[], Word16 effort )
 {
    Float64 alpk, alp, alp0, alp1;
    Float32 ps, psk, ps0, ps1, sq, sq1;
    Word32 ipos[4];
-   Word32 i0, i1, i2, i3, ix, i, pos, track;
+   Word32 i0, i1, i2, i3, ix, i, pos, track, max_track, nb_perm;
+
 
+   if ( effort > 2 ) {
+      /* largest dn[] of tracks 0, 1, 2 and of tracks 3 and 4 */
+      for ( i = 0; i < 3; i++ ) {
+         codvec[i] = max_pos( dn, i, STEP, -1 );
+      }
+      i0 = max_pos( dn, 3, STEP, -1 );
+      i1 = max_pos( dn, 4, STEP, -1 );
+      codvec[3] = dn[i1] > dn[i0] ? i1 : i0;
+      return;
+   }
+   max_track = effort > 1 ? 4 : 5;
+   nb_perm = 4 >> effort;
 
    /* Default value */
    psk = -1;
@@ -5261,7 +5556,7 @@ static void search_4i40( Float32 dn[], Float32 dn2[], Float32 rr[][L_CODE],
       codvec[i] = i;
    }
 
-   for ( track = 3; track < 5; track++ ) {
+   for ( track = 3; track < max_track; track++ ) {
       /* fix starting position */
       ipos[0] = 0;
       ipos[1] = 1;
@@ -5271,7 +5566,7 @@ static void search_4i40( Float32 dn[], Float32 dn2[], Float32 rr[][L_CODE],
       /*
        * main loop: try 4 tracks.
        */
-      for ( i = 0; i < 4; i++ ) {
+      for ( i = 0; i < nb_perm; i++ ) {
       /*
        * i0 loop: try 4 positions (use position with max of corr.).
        */
@@ -5482,6 +5777,7 @@ static void build_code_4i40( Word32 codvec[], Float32 dn_sign[], Float32 cod[],
  *    code              O: innovative codebook
  *    y                 O: filtered fixed codebook excitation
  *    anap              O: analysis parameters
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Searches a 17 bit algebraic codebook containing 4 pulses
@@ -5502,7 +5798,7 @@ static void build_code_4i40( Word32 codvec[], Float32 dn_sign[], Float32 cod[],
  *    void
  */
 static void code_4i40_17bits( Float32 x[], Float32 h[], Word32 T0, Float32
-      pitch_sharp, Float32 code[], Float32 y[], Word16 *anap )
+      pitch_sharp, Float32 code[], Float32 y[], Word16 *anap, Word16 effort )
 {
    Float32 rr[L_CODE][L_CODE];
    Float32 dn[L_CODE], dn2[L_CODE], dn_sign[L_CODE];
@@ -5517,8 +5813,9 @@ static void code_4i40_17bits( Float32 x[], Float32 h[], Word32 T0, Float32
    }
    cor_h_x( h, x, dn );
    set_sign( dn, dn_sign, dn2, 4 );
-   cor_h( h, dn_sign, rr );
-   search_4i40( dn, dn2, rr, codvec );
+   if ( effort < 3 )
+      cor_h( h, dn_sign, rr );
+   search_4i40( dn, dn2, rr, codvec, effort );
    build_code_4i40( codvec, dn_sign, code, h, y, anap );
 
    /*
@@ -5654,6 +5951,7 @@ static void set_sign12k2( Float32 dn[], Float32 cn[], Float32 sign[], Word32
  *    ipos              I: starting position for each pulse
  *    pos_max           I: maximum of correlation position
  *    codvec            O: algebraic codebook vector
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Search the best codevector; determine positions of the 8 pulses
@@ -5663,7 +5961,7 @@ static void set_sign12k2( Float32 dn[], Float32 cn[], Float32 sign[], Word32
  *    void
  */
 static void search_8i40( Float32 dn[], Float32 rr[][L_CODE], Word32 ipos[],
-      Word32 pos_max[], Word32 codvec[] )
+      Word32 pos_max[], Word32 codvec[], Word16 effort )
 {
    Float32 rrv[L_CODE];
    Float32 psk, ps, ps0, ps1, ps2, sq, sq2, alpk, alp, alp0, alp1, alp2;
@@ -5671,6 +5969,14 @@ static void search_8i40( Float32 dn[], Float32 rr[][L_CODE], Word32 ipos[],
    Float32 *p_rrv, *p_rrv0, *p_dn, *p_dn0, *p_dn1, *p_dn_max;
    Word32 i0, i1, i2, i3, i4, i5, i6, i7, j, k, ia, ib, i, pos;
 
+   if ( effort > 2 ) {
+      /* maximum of correlation and largest other dn[] of each track */
+      for ( i = 0; i < NB_TRACK_MR102; i++ ) {
+         codvec[i] = pos_max[i];
+         codvec[i + NB_TRACK_MR102] = max_pos( dn, i, STEP_MR102, pos_max[i] );
+      }
+      return;
+   }
    p_dn_max = &dn[39];
 
    /* fix i0 on maximum of correlation position */
@@ -5688,7 +5994,8 @@ static void search_8i40( Float32 dn[], Float32 rr[][L_CODE], Word32 ipos[],
    }
    p_r = &rr[i0][i0];
 
-   for ( i = 1; i < 5; i++ ) {
+   /* 4 iterations, effort 1: 2, effort 2: 1 */
+   for ( i = 1; i < 1 + ( 4 >> effort ); i++ ) {
       i1 = pos_max[ipos[1]];
       i2 = ipos[2];
       i3 = ipos[3];
@@ -6202,6 +6509,7 @@ static void compress_code( Word32 sign_indx[], Word32 pos_indx[], Word16 indx[]
  *    code              O: algebraic (fixed) codebook excitation
  *    y                 O: filtered fixed codebook excitation
  *    anap              O: 7 Word16, index of 8 pulses (signs+positions)
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Searches a 31 bit algebraic codebook containing 8 pulses
@@ -6230,7 +6538,7 @@ static void compress_code( Word32 sign_indx[], Word32 pos_indx[], Word16 indx[]
  */
 static void code_8i40_31bits( Float32 x[], Float32 cn[], Float32 h[],
                              Word32 T0, Float32 pitch_sharp, Float32 code[],
-                             Float32 y[], Word16 anap[] )
+                             Float32 y[], Word16 anap[], Word16 effort )
 {
    Float32 rr[L_CODE][L_CODE];
    Float32 dn[L_CODE], sign[L_CODE];
@@ -6250,8 +6558,9 @@ static void code_8i40_31bits( Float32 x[], Float32 cn[], Float32 h[],
 
    cor_h_x( h, x, dn );
    set_sign12k2( dn, cn, sign, pos_max, NB_TRACK_MR102, ipos, STEP_MR102 );
-   cor_h( h, sign, rr );
-   search_8i40( dn, rr, ipos, pos_max, codvec );
+   if ( effort < 3 )
+      cor_h( h, sign, rr );
+   search_8i40( dn, rr, ipos, pos_max, codvec, effort );
    build_code_8i40_31bits( codvec, sign, code, h, y, linear_signs,
       linear_codewords );
    compress_code( linear_signs, linear_codewords, anap );
@@ -6276,6 +6585,7 @@ static void code_8i40_31bits( Float32 x[], Float32 cn[], Float32 h[],
  *    ipos              I: starting position for each pulse
  *    pos_max           I: maximum of correlation position
  *    codvec            O: algebraic codebook vector
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Search the best codevector; determine positions of the 10
@@ -6303,7 +6613,7 @@ static void code_8i40_31bits( Float32 x[], Float32 cn[], Float32 h[],
  *    void
  */
 static void search_10i40( Float32 dn[], Float32 rr[][L_CODE], Word32 ipos[],
-      Word32 pos_max[], Word32 codvec[] )
+      Word32 pos_max[], Word32 codvec[], Word16 effort )
 {
    Float32 rrv[L_CODE];
    Float32 psk, ps, ps0, ps1, ps2, sq, sq2, alpk, alp, alp0, alp1, alp2;
@@ -6312,6 +6622,14 @@ static void search_10i40( Float32 dn[], Float32 rr[][L_CODE], Word32 ipos[],
    Float32 *p_rrv, *p_rrv0, *p_dn, *p_dn0, *p_dn1, *p_dn_max;
    Word32 i0, i1, i2, i3, i4, i5, i6, i7, i8, i9, j, k, ia, ib, i, pos;
 
+   if ( effort > 2 ) {
+      /* maximum of correlation and largest other dn[] of each track */
+      for ( i = 0; i < NB_TRACK; i++ ) {
+         codvec[i] = pos_max[i];
+         codvec[i + NB_TRACK] = max_pos( dn, i, STEP, pos_max[i] );
+      }
+      return;
+   }
    p_dn_max = &dn[39];
 
    /* fix i0 on maximum of correlation position */
@@ -6328,7 +6646,8 @@ static void search_10i40( Float32 dn[], Float32 rr[][L_CODE], Word32 ipos[],
    }
    p_r = &rr[i0][i0];
 
-   for ( i = 1; i < 5; i++ ) {
+   /* 4 iterations, effort 1: 2, effort 2: 1 */
+   for ( i = 1; i < 1 + ( 4 >> effort ); i++ ) {
       i1 = pos_max[ipos[1]];
       i2 = ipos[2];
       i3 = ipos[3];
@@ -6847,6 +7166,7 @@ static void q_p( Word16 *ind, Word32 n )
  *    code              O: algebraic (fixed) codebook excitation
  *    y                 O: filtered fixed codebook excitation
  *    anap              O: 7 Word16, index of 8 pulses (signs+positions)
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Searches a 35 bit algebraic codebook containing 10 pulses
@@ -6925,7 +7245,7 @@ static void q_p( Word16 *ind, Word32 n )
  */
 static void code_10i40_35bits( Float32 x[], Float32 cn[], Float32 h[],
     Word32 T0, Float32 gain_pit, Float32 code[],
-    Float32 y[], Word16 anap[] )
+    Float32 y[], Word16 anap[], Word16 effort )
  {
     Float32 rr[L_CODE][L_CODE];
     Float32 dn[L_CODE], sign[L_CODE];
@@ -6952,8 +7272,9 @@ static void code_10i40_35bits( Float32 x[], Float32 cn[], Float32 h[],
     set_sign12k2( dn, cn, sign, pos_max, NB_TRACK, ipos, STEP );
 
     /* Matrix of correlations */
-    cor_h( h, sign, rr );
-    search_10i40( dn, rr, ipos, pos_max, codvec );
+    if ( effort < 3 )
+       cor_h( h, sign, rr );
+    search_10i40( dn, rr, ipos, pos_max, codvec, effort );
     build_code_10i40_35bits( codvec, sign, code, h, y, anap );
 
     for ( i = 0; i < 10; i++ ) {
@@ -6986,6 +7307,7 @@ static void code_10i40_35bits( Float32 x[], Float32 cn[], Float32 h[],
  *    y                 O: Filtered fixed codebook excitation
  *    res2              I: residual after long term prediction
  *    anap              O: Signs and positions of the pulses
+ *    effort            I: search effort, 0 is the standard search
  *
  * Function:
  *    Innovative codebook search (find index and gain)
@@ -6996,33 +7318,35 @@ static void code_10i40_35bits( Float32 x[], Float32 cn[], Float32 h[],
 static void cbsearch( enum Mode mode, Word16 subnr, Float32 x[],
                      Float32 h[], Word32 T0, Float32 pitch_sharp,
                      Float32 gain_pit, Float32 code[], Float32 y[],
-                     Float32 *res2, Word16 **anap )
+                     Float32 *res2, Word16 **anap, Word16 effort )
 {
    switch (mode){
    case MR475:
    case MR515:
-      code_2i40_9bits( subnr, x, h, T0, pitch_sharp, code, y, *anap );
+      code_2i40_9bits( subnr, x, h, T0, pitch_sharp, code, y, *anap, effort );
       ( *anap ) += 2;
       break;
    case MR59:
-      code_2i40_11bits( x, h, T0, pitch_sharp, code, y, *anap );
+      code_2i40_11bits( x, h, T0, pitch_sharp, code, y, *anap, effort );
       ( *anap ) += 2;
       break;
    case MR67:
-      code_3i40_14bits( x, h, T0, pitch_sharp, code, y, *anap );
+      code_3i40_14bits( x, h, T0, pitch_sharp, code, y, *anap, effort );
       ( *anap ) += 2;
       break;
    case MR74:
    case MR795:
-      code_4i40_17bits( x, h, T0, pitch_sharp, code, y, *anap );
+      code_4i40_17bits( x, h, T0, pitch_sharp, code, y, *anap, effort );
       ( *anap ) += 2;
       break;
    case MR102:
-      code_8i40_31bits( x, res2, h, T0, pitch_sharp, code, y, *anap );
+      code_8i40_31bits( x, res2, h, T0, pitch_sharp, code, y, *anap,
+            effort );
       *anap += 7;
       break;
    default:
-      code_10i40_35bits( x, res2, h, T0, gain_pit, code, y, *anap );
+      code_10i40_35bits( x, res2, h, T0, gain_pit, code, y, *anap, effort
+            );
       *anap += 10;
    }
 }
@@ -8658,6 +8982,11 @@ static void Convolve( Float32 x[], Float32 h[], Float32 y[] )
    Float32 s;
 
 
+   if ( simd_kernels.convolve != NULL ) {
+      simd_kernels.convolve( x, h, y );
+      return;
+   }
+
    for ( n = 0; n < L_SUBFR; n++ ) {
       s = 0.0F;
 
@@ -9744,6 +10073,9 @@ static void vad_pitch_detection( vadState *st, Word32 T_op[] )
 
 #ifdef VAD2
 
+static void real_fft (float *farray_ptr, int isign);
+static void cmplx_fft (float *farray_ptr, int isign);
+
 /***************************************************************************
  *
  *   FUNCTION NAME: vad2()
@@ -9784,7 +10116,7 @@ int		vad2 (vadState *st, Float32 *farray_ptr)
      with numbers 0 (DC), 1, and 64 (Foldover frequency).  For
      these coefficients, the gain is always set at 1.0 (0 dB). */
 
-  static int	ch_tbl [NUM_CHAN][2] = {
+  static const int	ch_tbl [NUM_CHAN][2] = {
 
     { 2,  3},
     { 4,  5},
@@ -9810,7 +10142,7 @@ int		vad2 (vadState *st, Float32 *farray_ptr)
      index (quantized SNR value) to a number that is a measure
      of voice quality. */
 
-  static int	vm_tbl [90] = {
+  static const int	vm_tbl [90] = {
     2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
     3, 3, 3, 3, 3, 4, 4, 4, 5, 5, 5, 6, 6, 7, 7, 7,
     8, 8, 9, 9, 10, 10, 11, 12, 12, 13, 13, 14, 15,
@@ -9822,19 +10154,19 @@ int		vad2 (vadState *st, Float32 *farray_ptr)
   };
 
   /* hangover as a function of peak SNR (3 dB steps) */
-  static Word16 hangover_table[20] =
+  static const Word16 hangover_table[20] =
   {
     30, 30, 30, 30, 30, 30, 28, 26, 24, 22, 20, 18, 16, 14, 12, 10, 8, 8, 8, 8
   };
 
   /* burst sensitivity as a function of peak SNR (3 dB steps) */
-  static Word16 burstcount_table[20] =
+  static const Word16 burstcount_table[20] =
   {
     8, 8, 8, 8, 8, 8, 8, 8, 7, 6, 5, 4, 4, 4, 4, 4, 4, 4, 4, 4
   };
 
   /* voice metric sensitivity as a function of peak SNR (3 dB steps) */
-  static Word16 vm_threshold_table[20] =
+  static const Word16 vm_threshold_table[20] =
   {
     34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 34, 40, 51, 71, 100, 139, 191, 257, 337, 432
   };
@@ -9867,11 +10199,6 @@ int		vad2 (vadState *st, Float32 *farray_ptr)
   int	ivad;
 
 
-  /* Functions */
-
-  void real_fft (float *, int);
-
-
   /****** Executable code starts here ******/
 
   /* Increment frame counter */
@@ -10152,24 +10479,80 @@ int		vad2 (vadState *st, Float32 *farray_ptr)
  *
  *************************************************************************/
 
-static double	phs_tbl [SIZE];		/* holds the complex sinusoids */
-
-void		real_fft (float *farray_ptr, int isign)
+/* the complex sinusoids cos(-PI i / SIZE_BY_TWO), sin(-PI i / SIZE_BY_TWO),
+   read only so that any number of encoders can run in parallel */
+static const double	phs_tbl [SIZE] = {
+  1.0, -0.0,
+  0.99879545620517241, -0.049067674327418015,
+  0.99518472667219693, -0.098017140329560604,
+  0.98917650996478101, -0.14673047445536175,
+  0.98078528040323043, -0.19509032201612825,
+  0.97003125319454397, -0.24298017990326387,
+  0.95694033573220882, -0.29028467725446233,
+  0.94154406518302081, -0.33688985339222005,
+  0.92387953251128674, -0.38268343236508978,
+  0.90398929312344334, -0.42755509343028208,
+  0.88192126434835505, -0.47139673682599764,
+  0.85772861000027212, -0.51410274419322166,
+  0.83146961230254524, -0.55557023301960218,
+  0.80320753148064494, -0.59569930449243336,
+  0.77301045336273699, -0.63439328416364549,
+  0.74095112535495911, -0.67155895484701833,
+  0.70710678118654757, -0.70710678118654746,
+  0.67155895484701833, -0.74095112535495911,
+  0.63439328416364549, -0.77301045336273699,
+  0.59569930449243347, -0.80320753148064483,
+  0.55557023301960229, -0.83146961230254524,
+  0.51410274419322166, -0.85772861000027212,
+  0.47139673682599781, -0.88192126434835494,
+  0.4275550934302822, -0.90398929312344334,
+  0.38268343236508984, -0.92387953251128674,
+  0.33688985339222005, -0.94154406518302081,
+  0.29028467725446233, -0.95694033573220894,
+  0.24298017990326398, -0.97003125319454397,
+  0.19509032201612833, -0.98078528040323043,
+  0.14673047445536175, -0.98917650996478101,
+  0.09801714032956077, -0.99518472667219682,
+  0.049067674327418126, -0.99879545620517241,
+  6.123233995736766e-17, -1,
+  -0.049067674327418008, -0.99879545620517241,
+  -0.098017140329560645, -0.99518472667219693,
+  -0.14673047445536164, -0.98917650996478101,
+  -0.19509032201612819, -0.98078528040323043,
+  -0.24298017990326387, -0.97003125319454397,
+  -0.29028467725446216, -0.95694033573220894,
+  -0.33688985339221994, -0.94154406518302081,
+  -0.38268343236508973, -0.92387953251128674,
+  -0.42755509343028186, -0.90398929312344345,
+  -0.4713967368259977, -0.88192126434835505,
+  -0.51410274419322166, -0.85772861000027212,
+  -0.55557023301960196, -0.83146961230254546,
+  -0.59569930449243336, -0.80320753148064494,
+  -0.63439328416364538, -0.7730104533627371,
+  -0.67155895484701844, -0.74095112535495899,
+  -0.70710678118654746, -0.70710678118654757,
+  -0.74095112535495888, -0.67155895484701855,
+  -0.77301045336273699, -0.63439328416364549,
+  -0.80320753148064483, -0.59569930449243347,
+  -0.83146961230254535, -0.55557023301960218,
+  -0.85772861000027201, -0.51410274419322177,
+  -0.88192126434835494, -0.47139673682599786,
+  -0.90398929312344334, -0.42755509343028203,
+  -0.92387953251128674, -0.38268343236508989,
+  -0.9415440651830207, -0.33688985339222033,
+  -0.95694033573220882, -0.29028467725446239,
+  -0.97003125319454397, -0.24298017990326407,
+  -0.98078528040323043, -0.19509032201612861,
+  -0.98917650996478101, -0.1467304744553618,
+  -0.99518472667219682, -0.098017140329560826,
+  -0.99879545620517241, -0.049067674327417966
+};
+
+static void		real_fft (float *farray_ptr, int isign)
 {
 
   float		ftmp1_real, ftmp1_imag, ftmp2_real, ftmp2_imag;
   int		i, j;
-  static int	first = TRUE;
-
-  void		cmplx_fft (float *, int);
-  void		fill_tbl ();
-
-  /* If this is the first call to the function, fill up the
-     phase table  */
-  if (first == TRUE) {
-    fill_tbl ();
-    first = FALSE;
-  }
 
   /* The FFT part */
   if (isign == 1) {
@@ -10248,11 +10631,17 @@ void		real_fft (float *farray_ptr, int isign)
  * imaginary part for each sample.  The counters are therefore
  * incremented by two to access the complex valued samples.
  */
-void		cmplx_fft (float *farray_ptr, int isign)
+static void		cmplx_fft (float *farray_ptr, int isign)
 {
   int		i, j, k, ii, jj, kk, ji, kj;
   float		ftmp, ftmp_real, ftmp_imag;
 
+  /* forward FFT by the SIMD kernel, bit exact */
+  if (isign == 1 && simd_kernels.cmplx_fft != NULL) {
+    simd_kernels.cmplx_fft (farray_ptr, phs_tbl);
+    return;
+  }
+
   /* Rearrange the input array in bit reversed order */
   for (i = 0, j = 0; i < SIZE-2; i = i + 2) {
     if (j > i) {
@@ -10331,22 +10720,6 @@ void		cmplx_fft (float *farray_ptr, int isign)
 }		/* end of cmplx_fft () */
 
 
-/* Function to fill the phase table values
- */
-
-void		fill_tbl ()
-{
-  int		i;
-  double	delta_f, theta;
-
-  delta_f = - PI / (double) SIZE_BY_TWO;
-  for (i = 0; i < SIZE_BY_TWO; i++) {
-    theta = delta_f * (double) i;
-    phs_tbl[2*i] = cos(theta);
-    phs_tbl[2*i+1] = sin(theta);
-  }
-  return;
-}		/* end fill_tbl () */
 
 
 /***************************************************************************
@@ -10425,6 +10798,7 @@ static void cod_amr( cod_amrState *st, enum Mode mode, Float32 new_speech[],
    Float32 Aq_t[( MP1 ) * 4];   /* A(z)   quantized for the 4 subframes */
    Float32 *A, *Aq;   /* Pointer on Aq_t */
    Float32 lsp_new[M];
+   Float32 lsp_mid[M];
 
 
    /* Other vectors */
@@ -10510,12 +10884,15 @@ static void cod_amr( cod_amrState *st, enum Mode mode, Float32 new_speech[],
     * the line spectral pair (LSP) representation for
     * quantization and interpolation purposes.
     */
+   lsp_unq( mode, st->lspSt->lsp_old, A_t, lsp_mid, lsp_new );
    lsp( mode, *used_mode, st->lspSt->lsp_old, st->lspSt->lsp_old_q, st->lspSt->
-         qSt->past_rq, A_t, Aq_t, lsp_new, &ana );
+         qSt->past_rq, lsp_mid, lsp_new, Aq_t, &ana );
 
-   /* Buffer lsp's and energy */
-   dtx_buffer( &st->dtxEncSt->hist_ptr, st->dtxEncSt->lsp_hist, lsp_new, st->
-         new_speech, st->dtxEncSt->log_en_hist );
+   /* Buffer lsp's and energy, only read by dtx_enc */
+   if ( st->dtx ) {
+      dtx_buffer( &st->dtxEncSt->hist_ptr, st->dtxEncSt->lsp_hist, lsp_new, st
+            ->new_speech, st->dtxEncSt->log_en_hist );
+   }
 
    if ( *used_mode == MRDTX ) {
       dtx_enc( &st->dtxEncSt->log_en_index, st->dtxEncSt->log_en_hist, st->
@@ -10561,7 +10938,7 @@ static void cod_amr( cod_amrState *st, enum Mode mode, Float32 new_speech[],
          ol_ltp( mode, st->vadSt, &st->wsp[i_subfr], &T_op[subfrNr], st->
                ol_gain_flg, &st->pitchOLWghtSt->old_T0_med, &st->pitchOLWghtSt->
                wght_flg, &st->pitchOLWghtSt->ada_w, st->old_lags, st->dtx,
-               subfrNr );
+               subfrNr, st->search_effort );
       }
    }
 
@@ -10572,7 +10949,8 @@ static void cod_amr( cod_amrState *st, enum Mode mode, Float32 new_speech[],
        */
       ol_ltp( mode, st->vadSt, &st->wsp[0], &T_op[0], st->ol_gain_flg, &st->
             pitchOLWghtSt->old_T0_med, &st->pitchOLWghtSt->wght_flg, &st->
-            pitchOLWghtSt->ada_w, st->old_lags, st->dtx, 1 );
+            pitchOLWghtSt->ada_w, st->old_lags, st->dtx, 1, st->search_effort
+            );
       T_op[1] = T_op[0];
    }
 
@@ -10655,7 +11033,7 @@ static void cod_amr( cod_amrState *st, enum Mode mode, Float32 new_speech[],
       cl_ltp( &st->clLtpSt->pitchSt->T0_prev_subframe, st->tonStabSt->gp, *
             used_mode, i_subfr, T_op, st->h1, &st->exc[i_subfr], res2, xn,
             lsp_flag, xn2, y1, &T0, &T0_frac, &gain_pit, gCoeff, &ana, &gp_limit
-            );
+            , st->search_effort );
 
       /* update LTP lag history */
       if ( ( subfrNr == 0 ) && ( st->ol_gain_flg[0] > 0 ) ) {
@@ -10668,7 +11046,7 @@ static void cod_amr( cod_amrState *st, enum Mode mode, Float32 new_speech[],
 
       /* Innovative codebook search (find index and gain) */
       cbsearch( *used_mode, subfrNr, xn2, st->h1, T0, st->sharp, gain_pit, code,
-            y2, res2, &ana );
+            y2, res2, &ana, st->search_effort );
 
       /* Quantization of gains. */
       gainQuant( *used_mode, evenSubfr, st->gainQuantSt->gc_predSt->past_qua_en,
@@ -10791,66 +11169,6 @@ static Word32 Pre_Process_reset( Pre_ProcessState *state )
 }
 
 
-/*
- * Pre_Process_exit
- *
- *
- * Parameters:
- *    state             I: state structure
- *
- * Function:
- *    The memory used for state memory is freed
- *
- * Returns:
- *    Void
- */
-static void Pre_Process_exit( Pre_ProcessState **state )
-{
-   if ( state == NULL || *state == NULL )
-      return;
-
-   /* deallocate memory */
-   free( *state );
-   *state = NULL;
-   return;
-}
-
-
-/*
- * Pre_Process_init
- *
- *
- * Parameters:
- *    state             O: state structure
- *
- * Function:
- *    Allocates state memory and initializes state memory
- *
- * Returns:
- *    succeed = 0
- */
-static Word32 Pre_Process_init( Pre_ProcessState **state )
-{
-   Pre_ProcessState * s;
-
-   if ( state == ( Pre_ProcessState * * )NULL ) {
-      fprintf( stderr, "Pre_Process_init: invalid parameter\n" );
-      return-1;
-   }
-   *state = NULL;
-
-   /* allocate memory */
-   if ( ( s = ( Pre_ProcessState * ) malloc( sizeof( Pre_ProcessState ) ) ) ==
-         NULL ) {
-      fprintf( stderr, "Pre_Process_init: can not malloc state structure\n" );
-      return-1;
-   }
-   Pre_Process_reset( s );
-   *state = s;
-   return 0;
-}
-
-
 /*
  * Pre_Process
  *
@@ -11079,162 +11397,94 @@ static void cod_amr_reset( cod_amrState *s, Word32 dtx )
 
 
 /*
- * cod_amr_init
+ * cod_amr_place
  *
  *
  * Parameters:
- *    state             O: state structure
- *    dtx               I: dtx mode used
+ *    b                 B: state block
  *
  * Function:
- *    Allocates state memory and initializes state memory
+ *    Links the sub-states of the block to the encoder state
  *
  * Returns:
- *    succeed = 0
+ *    void
  */
-static Word32 cod_amr_init( cod_amrState **state, Word32 dtx )
-{
-   cod_amrState * s;
-
-   if ( ( s = ( cod_amrState * ) malloc( sizeof( cod_amrState ) ) ) == NULL ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* init clLtpState */
-   if ( ( s->clLtpSt = ( clLtpState * ) malloc( sizeof( clLtpState ) ) ) == NULL
-         ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* init Pitch_frState */
-   if ( ( s->clLtpSt->pitchSt = ( Pitch_frState * ) malloc( sizeof(
-         Pitch_frState ) ) ) == NULL ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* init lspState */
-   if ( ( s->lspSt = ( lspState * ) malloc( sizeof( lspState ) ) ) == NULL ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* init Q_plsfState */
-   if ( ( s->lspSt->qSt = ( Q_plsfState * ) malloc( sizeof( Q_plsfState ) ) ) ==
-         NULL ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* init gainQuantState */
-   if ( ( s->gainQuantSt = ( gainQuantState * ) malloc( sizeof( gainQuantState )
-         ) ) == NULL ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* init gc_predState x2 */
-   if ( ( s->gainQuantSt->gc_predSt = ( gc_predState * ) malloc( sizeof(
-         gc_predState ) ) ) == NULL ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
-
-   if ( ( s->gainQuantSt->gc_predUncSt = ( gc_predState * ) malloc( sizeof(
-         gc_predState ) ) ) == NULL ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* init gain_adaptState */
-   if ( ( s->gainQuantSt->adaptSt = ( gain_adaptState * ) malloc( sizeof(
-         gain_adaptState ) ) ) == NULL ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* init pitchOLWghtState */
-   if ( ( s->pitchOLWghtSt = ( pitchOLWghtState * ) malloc( sizeof(
-         pitchOLWghtState ) ) ) == NULL ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* init tonStabState */
-   if ( ( s->tonStabSt = ( tonStabState * ) malloc( sizeof( tonStabState ) ) )
-         == NULL ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* init lpcState */
-   if ( ( s->lpcSt = ( lpcState * ) malloc( sizeof( lpcState ) ) ) == NULL ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
-
-   /* init LevinsonState */
-   if ( ( s->lpcSt->LevinsonSt = ( LevinsonState * ) malloc( sizeof(
-         LevinsonState ) ) ) == NULL ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
+static void cod_amr_place( Speech_Encode_FrameBlock *b )
+{
+   cod_amrState * s = &b->cod;
+
+
+   s->clLtpSt = &b->clLtp;
+   s->clLtpSt->pitchSt = &b->pitch;
+   s->lspSt = &b->lsp;
+   s->lspSt->qSt = &b->qPlsf;
+   s->gainQuantSt = &b->gainQuant;
+   s->gainQuantSt->gc_predSt = &b->gcPred;
+   s->gainQuantSt->gc_predUncSt = &b->gcPredUnc;
+   s->gainQuantSt->adaptSt = &b->adapt;
+   s->pitchOLWghtSt = &b->pitchOLWght;
+   s->tonStabSt = &b->tonStab;
+   s->lpcSt = &b->lpc;
+   s->lpcSt->LevinsonSt = &b->Levinson;
+   s->vadSt = &b->vad;
+   s->dtxEncSt = &b->dtxEnc;
+}
 
-   if ( ( s->vadSt = ( vadState * ) malloc( sizeof( vadState ) ) ) == NULL ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
 
-   /* Init dtx_encState */
-   if ( ( s->dtxEncSt = ( dtx_encState * ) malloc( sizeof( dtx_encState ) ) ) ==
-         NULL ) {
-      fprintf( stderr, "can not malloc state structure\n" );
-      return-1;
-   }
-   cod_amr_reset( s, dtx );
-   *state = s;
-   return 0;
+/*
+ * Speech_Encode_Frame_state_size
+ *
+ *
+ * Parameters:
+ *    void
+ *
+ * Function:
+ *    Size of the memory taken by Speech_Encode_Frame_init_in
+ *
+ * Returns:
+ *    size in bytes
+ */
+int Speech_Encode_Frame_state_size( void )
+{
+   return sizeof( Speech_Encode_FrameBlock );
 }
 
 
 /*
- * cod_amr_exit
+ * Speech_Encode_Frame_init_in
  *
  *
  * Parameters:
- *    state             I: state structure
+ *    mem               O: Speech_Encode_Frame_state_size() bytes,
+ *                         aligned as returned by malloc
+ *    dtx               I: dtx mode used
  *
  * Function:
- *    The memory used for state memory is freed
+ *    Initializes the state and all its sub-states in the caller's
+ *    memory, nothing is allocated. The state is not passed to
+ *    Speech_Encode_Frame_exit, the caller releases the memory.
+ *    Calling it again on the same memory resets the state.
  *
  * Returns:
- *    Void
+ *    pointer to the state, mem
  */
-static void cod_amr_exit( cod_amrState **state )
+void * Speech_Encode_Frame_init_in( void *mem, int dtx )
 {
-   if ( state == NULL || *state == NULL )
-      return;
+   Speech_Encode_FrameBlock * b;
 
-   /* deallocate memory */
-   free( ( *state )->vadSt );
-   free( ( *state )->gainQuantSt->gc_predSt );
-   free( ( *state )->gainQuantSt->gc_predUncSt );
-   free( ( *state )->gainQuantSt->adaptSt );
-   free( ( *state )->clLtpSt->pitchSt );
-   free( ( *state )->lspSt->qSt );
-   free( ( *state )->lpcSt->LevinsonSt );
-   free( ( *state )->lpcSt );
-   free( ( *state )->lspSt );
-   free( ( *state )->clLtpSt );
-   free( ( *state )->gainQuantSt );
-   free( ( *state )->pitchOLWghtSt );
-   free( ( *state )->tonStabSt );
-   free( ( *state )->dtxEncSt );
-   free( *state );
-   *state = NULL;
-   return;
+   if ( mem == NULL ) {
+      fprintf( stderr, "Speech_Encode_Frame_init_in: invalid parameter\n" );
+      return NULL;
+   }
+   b = ( Speech_Encode_FrameBlock * )mem;
+   memset( b, 0, sizeof( Speech_Encode_FrameBlock ) );
+   b->frame.pre_state = &b->pre;
+   b->frame.cod_amr_state = &b->cod;
+   b->frame.dtx = dtx;
+   cod_amr_place( b );
+   Pre_Process_reset( &b->pre );
+   cod_amr_reset( &b->cod, dtx );
+   return b;
 }
 
 
@@ -11254,25 +11504,15 @@ static void cod_amr_exit( cod_amrState **state )
  */
 void * Speech_Encode_Frame_init( int dtx )
 {
-   Speech_Encode_FrameState * s;
+   void * s;
 
-   /* allocate memory */
-   if ( ( s = ( Speech_Encode_FrameState * ) malloc( sizeof(
-         Speech_Encode_FrameState ) ) ) == NULL ) {
+   /* allocate memory, one block for all the sub-states */
+   if ( ( s = malloc( sizeof( Speech_Encode_FrameBlock ) ) ) == NULL ) {
       fprintf( stderr, "Speech_Encode_Frame_init: can not malloc state "
             "structure\n" );
       return NULL;
    }
-   s->pre_state = NULL;
-   s->cod_amr_state = NULL;
-   s->dtx = dtx;
-
-   if ( Pre_Process_init( &s->pre_state ) || cod_amr_init( &s->cod_amr_state,
-         dtx ) ) {
-      Speech_Encode_Frame_exit( ( void ** )( &s ) );
-      return NULL;
-   }
-   return s;
+   return Speech_Encode_Frame_init_in( s, dtx );
 }
 
 
@@ -11304,6 +11544,54 @@ int Speech_Encode_Frame_reset( void *st, int dtx )
 }
 
 
+/*
+ * Speech_Encode_Frame_set_search_effort
+ *
+ *
+ * Parameters:
+ *    st                B: state structure
+ *    effort            I: search effort
+ *
+ * Function:
+ *    Sets the effort of the pitch and codebook searches.
+ *    0  standard search (bit exact)
+ *    1  half of the codebook starting positions, fractional
+ *       pitch of 1/6 resolution on a 1/3 grid
+ *    2  one codebook starting position, integer closed-loop pitch,
+ *       open-loop correlation on every second lag
+ *    3  as 2, but the pulses are placed greedily on the largest
+ *       correlation of each track without rr[][], and the closed-loop
+ *       pitch only tests the open-loop or previous lag and its neighbours
+ *    The bit stream stays valid, only the choice of parameters is worse.
+ *
+ *    Measured on 21 s of synthetic voiced speech (-O3, x86-64), against
+ *    level 0:
+ *       level   pitch and codebook   whole encoder   segmental SNR of
+ *               searches                             local synthesis
+ *       1       up to 1.3x faster    1.0 - 1.3x      -0.1 to -0.9 dB
+ *       2       1.5 - 2.7x           1.0 - 1.6x      -2.3 to -4.6 dB
+ *       3       2.3 - 3.4x           1.2 - 2.0x      -2.2 to -8.6 dB
+ *    LPC analysis, LSF quantization, VAD and the subframe filtering do
+ *    not depend on the effort and take most of the time at level 3.
+ *
+ * Returns:
+ *    0 on success
+ */
+int Speech_Encode_Frame_set_search_effort( void *st, int effort )
+{
+   Speech_Encode_FrameState * state;
+   state = ( Speech_Encode_FrameState * )st;
+
+   if ( ( state == NULL ) || ( effort < 0 ) || ( effort > 3 ) ) {
+      fprintf( stderr, "Speech_Encode_Frame_set_search_effort: invalid "
+            "parameter\n" );
+      return-1;
+   }
+   state->cod_amr_state->search_effort = ( Word16 )effort;
+   return 0;
+}
+
+
 /*
  * Speech_Encode_Frame_exit
  *
@@ -11321,12 +11609,8 @@ void Speech_Encode_Frame_exit( void **st )
 {
    if ( ( Speech_Encode_FrameState * )( *st ) == NULL )
       return;
-   Pre_Process_exit( &( ( ( Speech_Encode_FrameState * )( *st ) )->pre_state ) )
-   ;
-   cod_amr_exit( &( ( ( Speech_Encode_FrameState * )( *st ) )->cod_amr_state ) )
-   ;
 
-   /* deallocate memory */
+   /* deallocate memory, the sub-states are in the same block */
    free( *st );
    *st = NULL;
    return;
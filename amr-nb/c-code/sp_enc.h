@@ -54,12 +54,31 @@ enum Mode { MR475 = 0,
  * returns 0 on success
  */
 void *Speech_Encode_Frame_init (int dtx);
+/*
+ * size in bytes of one encoder state with all its sub-states
+ */
+int Speech_Encode_Frame_state_size (void);
+/*
+ * initialize one instance of the speech encoder in mem, which holds
+ * Speech_Encode_Frame_state_size() bytes aligned like malloc, without
+ * allocating. The caller owns mem, do not call Speech_Encode_Frame_exit.
+ * Calling it again on the same memory resets the encoder.
+ * returns the state (mem)
+ */
+void *Speech_Encode_Frame_init_in (void *mem, int dtx);
 /*
  * reset speech encoder (i.e. set state memory to zero)
  * returns 0 on success
  */
 int Speech_Encode_Frame_reset(void *st, int dtx);
 
+/*
+ * set the effort of the pitch and codebook searches, 0 is the standard
+ * search, 1 and 2 are faster and no longer bit exact
+ * returns 0 on success
+ */
+int Speech_Encode_Frame_set_search_effort(void *st, int effort);
+
 /*
  * de-initialize speech encoder (i.e. free status struct)
  * stores NULL in *st
@@ -0,0 +1,628 @@
+/*
+ * ===================================================================
+ *  TS 26.104
+ *  REL-5 V5.4.0 2004-03
+ *  REL-6 V6.1.0 2004-03
+ *  3GPP AMR Floating-point Speech Codec
+ * ===================================================================
+ *
+ */
+
+/*
+ * sp_enc_simd.c
+ *
+ *
+ * Project:
+ *    AMR Floating-Point Codec
+ *
+ * Contains:
+ *    AVX2 / NEON versions of the encoder correlation kernels and
+ *    an AVX2 version of the FFT of the VAD option 2.
+ *
+ *    The kernels run the lags (or output samples) in the vector lanes,
+ *    so every lane adds its products in the same order as the reference
+ *    code and the result is bit exact. Only Dotproduct40 of SIMD_FAST
+ *    reassociates the sum. Padding lanes add products of zero, which can
+ *    only change the sign of an exact zero.
+ *
+ *    Bit exactness assumes that neither this file nor sp_enc.c contracts
+ *    a * b + c into fused multiply-add, see -ffp-contract in CMakeLists.txt.
+ *
+ */
+#include <string.h>
+#include "sp_enc_simd.h"
+#include "sp_dec_simd.h"
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#include <immintrin.h>
+#define SIMD_AVX2
+#define SIMD_TARGET __attribute__((target("avx2")))
+#define VL 8
+typedef __m256 vfloat;
+#define V_LOAD( p )       _mm256_loadu_ps( p )
+#define V_STORE( p, v )   _mm256_storeu_ps( p, v )
+#define V_DUP( s )        _mm256_set1_ps( s )
+#define V_ADD( a, b )     _mm256_add_ps( a, b )
+#define V_MUL( a, b )     _mm256_mul_ps( a, b )
+#define V_ZERO()          _mm256_setzero_ps()
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SIMD_NEON
+#define SIMD_TARGET
+#define VL 4
+typedef float32x4_t vfloat;
+#define V_LOAD( p )       vld1q_f32( p )
+#define V_STORE( p, v )   vst1q_f32( p, v )
+#define V_DUP( s )        vdupq_n_f32( s )
+#define V_ADD( a, b )     vaddq_f32( a, b )
+#define V_MUL( a, b )     vmulq_f32( a, b )
+#define V_ZERO()          vdupq_n_f32( 0.0F )
+#endif
+
+#define L_CODE 40
+#define L_SUBFR 40
+
+#define FFT_SIZE 128   /* floats, 64 complex values */
+
+SimdKernels simd_kernels = { NULL, NULL, NULL, NULL, NULL, NULL };
+
+#ifdef VL
+
+/*
+ * Transpose_tile
+ *
+ *
+ * Parameters:
+ *    src               I: VL x VL tile, rows are stride floats apart
+ *    dst               O: transposed tile, same stride
+ *
+ * Function:
+ *    Transposes a VL x VL tile of a row major matrix
+ *
+ * Returns:
+ *    void
+ */
+SIMD_TARGET static void Transpose_tile( Float32 *src, Float32 *dst, Word32
+      stride )
+{
+#ifdef SIMD_AVX2
+   __m256 r0, r1, r2, r3, r4, r5, r6, r7;
+   __m256 t0, t1, t2, t3, t4, t5, t6, t7;
+
+
+   r0 = V_LOAD( src );
+   r1 = V_LOAD( src + stride );
+   r2 = V_LOAD( src + 2 * stride );
+   r3 = V_LOAD( src + 3 * stride );
+   r4 = V_LOAD( src + 4 * stride );
+   r5 = V_LOAD( src + 5 * stride );
+   r6 = V_LOAD( src + 6 * stride );
+   r7 = V_LOAD( src + 7 * stride );
+   t0 = _mm256_unpacklo_ps( r0, r1 );
+   t1 = _mm256_unpackhi_ps( r0, r1 );
+   t2 = _mm256_unpacklo_ps( r2, r3 );
+   t3 = _mm256_unpackhi_ps( r2, r3 );
+   t4 = _mm256_unpacklo_ps( r4, r5 );
+   t5 = _mm256_unpackhi_ps( r4, r5 );
+   t6 = _mm256_unpacklo_ps( r6, r7 );
+   t7 = _mm256_unpackhi_ps( r6, r7 );
+   r0 = _mm256_shuffle_ps( t0, t2, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+   r1 = _mm256_shuffle_ps( t0, t2, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+   r2 = _mm256_shuffle_ps( t1, t3, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+   r3 = _mm256_shuffle_ps( t1, t3, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+   r4 = _mm256_shuffle_ps( t4, t6, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+   r5 = _mm256_shuffle_ps( t4, t6, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+   r6 = _mm256_shuffle_ps( t5, t7, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+   r7 = _mm256_shuffle_ps( t5, t7, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+   V_STORE( dst, _mm256_permute2f128_ps( r0, r4, 0x20 ) );
+   V_STORE( dst + stride, _mm256_permute2f128_ps( r1, r5, 0x20 ) );
+   V_STORE( dst + 2 * stride, _mm256_permute2f128_ps( r2, r6, 0x20 ) );
+   V_STORE( dst + 3 * stride, _mm256_permute2f128_ps( r3, r7, 0x20 ) );
+   V_STORE( dst + 4 * stride, _mm256_permute2f128_ps( r0, r4, 0x31 ) );
+   V_STORE( dst + 5 * stride, _mm256_permute2f128_ps( r1, r5, 0x31 ) );
+   V_STORE( dst + 6 * stride, _mm256_permute2f128_ps( r2, r6, 0x31 ) );
+   V_STORE( dst + 7 * stride, _mm256_permute2f128_ps( r3, r7, 0x31 ) );
+#else
+   float32x4x2_t t01, t23;
+
+
+   t01 = vtrnq_f32( V_LOAD( src ), V_LOAD( src + stride ) );
+   t23 = vtrnq_f32( V_LOAD( src + 2 * stride ), V_LOAD( src + 3 * stride ) );
+   V_STORE( dst, vcombine_f32( vget_low_f32( t01.val[0] ), vget_low_f32(
+         t23.val[0] ) ) );
+   V_STORE( dst + stride, vcombine_f32( vget_low_f32( t01.val[1] ),
+         vget_low_f32( t23.val[1] ) ) );
+   V_STORE( dst + 2 * stride, vcombine_f32( vget_high_f32( t01.val[0] ),
+         vget_high_f32( t23.val[0] ) ) );
+   V_STORE( dst + 3 * stride, vcombine_f32( vget_high_f32( t01.val[1] ),
+         vget_high_f32( t23.val[1] ) ) );
+#endif
+}
+
+
+/*
+ * Dotproduct40_exact
+ *
+ *
+ * Parameters:
+ *    x                 I: First input
+ *    y                 I: Second input
+ * Function:
+ *    Computes dot product size 40, the ten sums of four products are
+ *    done in float one group per lane, then added in double
+ *
+ * Returns:
+ *    acc                dot product
+ */
+SIMD_TARGET static Float64 Dotproduct40_exact( Float32 *x, Float32 *y )
+{
+   Float32 group[10];
+   Float64 acc;
+   Word32 i;
+
+#ifdef SIMD_AVX2
+   Float32 lane[VL];
+   vfloat p0, p1, p2, p3, t0, t1, t2, t3;
+
+
+   /* p0 holds the products of groups 0, 1, p1 of groups 2, 3, ... */
+   p0 = V_MUL( V_LOAD( x ), V_LOAD( y ) );
+   p1 = V_MUL( V_LOAD( &x[8] ), V_LOAD( &y[8] ) );
+   p2 = V_MUL( V_LOAD( &x[16] ), V_LOAD( &y[16] ) );
+   p3 = V_MUL( V_LOAD( &x[24] ), V_LOAD( &y[24] ) );
+
+   /*
+    * 4x4 transpose in each 128 bit half, afterwards p<k> holds product k
+    * of the groups 0, 2, 4, 6 | 1, 3, 5, 7
+    */
+   t0 = _mm256_unpacklo_ps( p0, p1 );
+   t1 = _mm256_unpackhi_ps( p0, p1 );
+   t2 = _mm256_unpacklo_ps( p2, p3 );
+   t3 = _mm256_unpackhi_ps( p2, p3 );
+   p0 = _mm256_shuffle_ps( t0, t2, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+   p1 = _mm256_shuffle_ps( t0, t2, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+   p2 = _mm256_shuffle_ps( t1, t3, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+   p3 = _mm256_shuffle_ps( t1, t3, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+   V_STORE( lane, V_ADD( V_ADD( V_ADD( p0, p1 ), p2 ), p3 ) );
+
+   for ( i = 0; i < 4; i++ ) {
+      group[2 * i] = lane[i];
+      group[2 * i + 1] = lane[4 + i];
+   }
+   i = 8;
+#else
+   float32x4x4_t vx, vy;
+   vfloat s;
+
+
+   for ( i = 0; i < 8; i += 4 ) {
+      vx = vld4q_f32( &x[4 * i] );
+      vy = vld4q_f32( &y[4 * i] );
+      s = V_MUL( vx.val[0], vy.val[0] );
+      s = V_ADD( s, V_MUL( vx.val[1], vy.val[1] ) );
+      s = V_ADD( s, V_MUL( vx.val[2], vy.val[2] ) );
+      s = V_ADD( s, V_MUL( vx.val[3], vy.val[3] ) );
+      V_STORE( &group[i], s );
+   }
+#endif
+
+   for ( ; i < 10; i++ ) {
+      group[i] = x[4 * i] * y[4 * i] + x[4 * i + 1] * y[4 * i + 1] + x[4 * i + 2]
+            * y[4 * i + 2] + x[4 * i + 3] * y[4 * i + 3];
+   }
+   acc = group[0];
+
+   for ( i = 1; i < 10; i++ )
+      acc += group[i];
+   return( acc );
+}
+
+
+/*
+ * Dotproduct40_fast
+ *
+ *
+ * Parameters:
+ *    x                 I: First input
+ *    y                 I: Second input
+ * Function:
+ *    Computes dot product size 40 with a vector accumulator,
+ *    not bit exact
+ *
+ * Returns:
+ *    acc                dot product
+ */
+SIMD_TARGET static Float64 Dotproduct40_fast( Float32 *x, Float32 *y )
+{
+   Float32 lane[VL];
+   Float32 acc;
+   vfloat s;
+   Word32 i;
+
+
+   s = V_MUL( V_LOAD( x ), V_LOAD( y ) );
+
+   for ( i = VL; i < 40; i += VL )
+      s = V_ADD( s, V_MUL( V_LOAD( &x[i] ), V_LOAD( &y[i] ) ) );
+   V_STORE( lane, s );
+   acc = lane[0];
+
+   for ( i = 1; i < VL; i++ )
+      acc += lane[i];
+   return( acc );
+}
+
+
+/*
+ * comp_corr_simd
+ *
+ *
+ * Parameters:
+ *    sig               I: signal
+ *    L_frame           I: length of frame to compute pitch
+ *    lag_max           I: maximum lag
+ *    lag_min           I: minimum lag
+ *    corr              O: correlation of selected lag
+ *
+ * Function:
+ *    Calculate all correlations in a given delay range,
+ *    lane l of a block holds lag i - l
+ *
+ * Returns:
+ *    void
+ */
+SIMD_TARGET static void comp_corr_simd( Float32 sig[], Word32 L_frame, Word32
+      lag_max, Word32 lag_min, Float32 corr[] )
+{
+   Word32 i, j, k;
+   Float32 *p, *p1;
+   Float32 T0;
+   vfloat s, t;
+
+
+   for ( i = lag_max; i - ( VL - 1 ) >= lag_min; i -= VL ) {
+      s = V_ZERO();
+
+      for ( j = 0; j < L_frame; j += 4 ) {
+         p = &sig[j];
+         p1 = &sig[j - i];
+         t = V_MUL( V_DUP( p[0] ), V_LOAD( &p1[0] ) );
+         t = V_ADD( t, V_MUL( V_DUP( p[1] ), V_LOAD( &p1[1] ) ) );
+         t = V_ADD( t, V_MUL( V_DUP( p[2] ), V_LOAD( &p1[2] ) ) );
+         t = V_ADD( t, V_MUL( V_DUP( p[3] ), V_LOAD( &p1[3] ) ) );
+         s = V_ADD( s, t );
+      }
+      V_STORE( &corr[ - i], s );
+   }
+
+   for ( ; i >= lag_min; i-- ) {
+      p = sig;
+      p1 = &sig[ - i];
+      T0 = 0.0F;
+
+      for ( k = 0; k < L_frame; k += 4 ) {
+         T0 += p[k] * p1[k] + p[k + 1] * p1[k + 1] + p[k + 2] * p1[k + 2] + p[k
+               + 3] * p1[k + 3];
+      }
+      corr[ - i] = T0;
+   }
+   return;
+}
+
+
+/*
+ * cor_h_x_simd
+ *
+ *
+ * Parameters:
+ *    h                 I: impulse response of weighted synthesis filter
+ *    x                 I: target
+ *    dn                O: correlation between target and impulse response
+ *
+ * Function:
+ *    Computes correlation between target signal and impulse response,
+ *    lane l of a block holds dn[i + l]
+ *
+ * Returns:
+ *    void
+ */
+SIMD_TARGET static void cor_h_x_simd( Float32 h[], Float32 x[], Float32 dn[] )
+{
+   Float32 xpad[L_CODE + VL], out[VL];
+   Word32 i, k, n;
+   vfloat s;
+
+
+   memcpy( xpad, x, L_CODE * sizeof( Float32 ) );
+   memset( &xpad[L_CODE], 0, VL * sizeof( Float32 ) );
+   dn[0] = (Float32)simd_kernels.dotproduct40( h, x );
+
+   for ( i = 1; i < L_CODE; i += VL ) {
+      s = V_ZERO();
+
+      for ( k = 0; k < L_CODE - i; k++ )
+         s = V_ADD( s, V_MUL( V_DUP( h[k] ), V_LOAD( &xpad[i + k] ) ) );
+      n = L_CODE - i < VL ? L_CODE - i : VL;
+      V_STORE( out, s );
+      memcpy( &dn[i], out, n * sizeof( Float32 ) );
+   }
+}
+
+
+/*
+ * cor_h_simd
+ *
+ *
+ * Parameters:
+ *    h                I: h[]
+ *    sign             I: sign information
+ *    rr               O: correlations
+ *
+ * Function:
+ *    Computes correlations of h[] needed for the codebook search,
+ *    and includes the sign information into the correlations.
+ *    Lane l of a block holds the diagonal ii - l, so a block is stored
+ *    to a contiguous part of row 39 - k of the lower triangle, which is
+ *    mirrored at the end. The main diagonal is the block lane with
+ *    ii = 0, as sign[i] * sign[i] = 1 it gets the plain sum.
+ *
+ * Returns:
+ *    void
+ */
+SIMD_TARGET static void cor_h_simd( Float32 h[], Float32 sign[], Float32 rr[][
+      L_CODE] )
+{
+   /* hr[m] = h[39 - m] and sp[m] = sign[m], both for m = -VL .. 39 */
+   Float32 hbuf[VL + L_CODE], sbuf[VL + L_CODE], out[VL];
+   Float32 *hr = &hbuf[VL], *sp = &sbuf[VL];
+   Word32 i, j, ii, k, l;
+   vfloat s, v;
+
+
+   memset( hbuf, 0, VL * sizeof( Float32 ) );
+   memset( sbuf, 0, VL * sizeof( Float32 ) );
+
+   for ( i = 0; i < L_CODE; i++ )
+      hr[i] = h[39 - i];
+   memcpy( sp, sign, L_CODE * sizeof( Float32 ) );
+
+   /*
+    * for lane l, ii = ii0 - l:
+    * sum += h[k] * h[k + ii];
+    * rr[39 - k][39 - ii - k] = sum * sign[39 - ii - k] * sign[39 - k];
+    */
+   for ( ii = L_CODE - 1; ii >= 0; ii -= VL ) {
+      s = V_ZERO();
+
+      for ( k = 0; k < L_CODE - ( ii - VL + 1 ); k++ ) {
+         j = 39 - k - ii;
+         s = V_ADD( s, V_MUL( V_DUP( h[k] ), V_LOAD( &hr[j] ) ) );
+         v = V_MUL( V_MUL( s, V_LOAD( &sp[j] ) ), V_DUP( sign[39 - k] ) );
+
+         if ( j >= 0 )
+            V_STORE( &rr[39 - k][j], v );
+         else {
+            V_STORE( out, v );
+
+            for ( l = - j; l < VL; l++ )
+               rr[39 - k][j + l] = out[l];
+         }
+      }
+   }
+   rr[0][0] = (Float32)simd_kernels.dotproduct40( h, h );
+
+   /* mirror, whole tiles below the diagonal are transposed */
+   for ( i = 0; i < L_CODE; i += VL ) {
+      for ( j = 0; j < i; j += VL )
+         Transpose_tile( &rr[i][j], &rr[j][i], L_CODE );
+
+      for ( k = i + 1; k < i + VL; k++ ) {
+         for ( l = i; l < k; l++ )
+            rr[l][k] = rr[k][l];
+      }
+   }
+   return;
+}
+
+
+/*
+ * Convolve_simd
+ *
+ *
+ * Parameters:
+ *    x                 I: First input
+ *    h                 I: second input
+ *    y                 O: output
+ *
+ * Function:
+ *    Convolution, lane l of a block holds y[n + l]
+ *
+ * Returns:
+ *    void
+ */
+SIMD_TARGET static void Convolve_simd( Float32 x[], Float32 h[], Float32 y[] )
+{
+   Float32 hpad[VL + L_SUBFR];
+   Word32 i, n;
+   vfloat s;
+
+
+   /* h[-VL .. -1] = 0 */
+   memset( hpad, 0, VL * sizeof( Float32 ) );
+   memcpy( &hpad[VL], h, L_SUBFR * sizeof( Float32 ) );
+
+   for ( n = 0; n < L_SUBFR; n += VL ) {
+      s = V_ZERO();
+
+      for ( i = 0; i < n + VL; i++ )
+         s = V_ADD( s, V_MUL( V_DUP( x[i] ), V_LOAD( &hpad[VL + n - i] ) ) );
+      V_STORE( &y[n], s );
+   }
+   return;
+}
+#endif
+
+
+#ifdef SIMD_AVX2
+/* pairs of complex values swapped into bit reversed order, float offsets */
+static const unsigned char fft_swap[28][2] = {
+   { 2, 64 }, { 4, 32 }, { 6, 96 }, { 8, 16 }, { 10, 80 }, { 12, 48 },
+   { 14, 112 }, { 18, 72 }, { 20, 40 }, { 22, 104 }, { 26, 88 }, { 28, 56 },
+   { 30, 120 }, { 34, 68 }, { 38, 100 }, { 42, 84 }, { 44, 52 }, { 46, 116 },
+   { 50, 76 }, { 54, 108 }, { 58, 92 }, { 62, 124 }, { 70, 98 }, { 74, 82 },
+   { 78, 114 }, { 86, 106 }, { 94, 122 }, { 110, 118 }
+};
+
+
+/*
+ * Fft_butterfly2
+ *
+ *
+ * Parameters:
+ *    top               I: two complex values of the butterfly tops
+ *    bot               I: two complex values of the butterfly bottoms
+ *    tr, ti            I: real and imaginary twiddles, each twice
+ *    out_top, out_bot  O: halved butterfly outputs
+ *
+ * Function:
+ *    Two butterflies of the forward FFT. The twiddle products are
+ *    taken in double as in the reference code and rounded to float,
+ *    halving the float sum is exact in both versions.
+ *
+ * Returns:
+ *    void
+ */
+SIMD_TARGET static void Fft_butterfly2( __m128 top, __m128 bot, __m256d tr,
+      __m256d ti, __m128 *out_top, __m128 *out_bot )
+{
+   __m256d b, swp;
+   __m128 ft, half = _mm_set1_ps( 0.5F );
+
+
+   /* re * tr - im * ti, im * tr + re * ti */
+   b = _mm256_cvtps_pd( bot );
+   swp = _mm256_permute_pd( b, 0x5 );
+   ft = _mm256_cvtpd_ps( _mm256_addsub_pd( _mm256_mul_pd( b, tr ),
+         _mm256_mul_pd( swp, ti ) ) );
+   *out_bot = _mm_mul_ps( _mm_sub_ps( top, ft ), half );
+   *out_top = _mm_mul_ps( _mm_add_ps( top, ft ), half );
+}
+
+
+/*
+ * cmplx_fft_simd
+ *
+ *
+ * Parameters:
+ *    data              B: 64 complex values, real part first, replaced
+ *                         by their FFT divided by 64
+ *    phs_tbl           I: complex sinusoids of the FFT
+ *
+ * Function:
+ *    Forward decimation-in-time FFT of cmplx_fft in vad2, two
+ *    butterflies of a stage in a vector, bit exact
+ *
+ * Returns:
+ *    void
+ */
+SIMD_TARGET static void cmplx_fft_simd( Float32 *data, const Float64 *phs_tbl )
+{
+   Word32 i, j, k, ii, jj, ji;
+   Float64 swap;
+   __m256d tr, ti;
+   __m128 lo, hi, top, bot;
+
+
+   /* Rearrange the input array in bit reversed order */
+   for ( i = 0; i < 28; i++ ) {
+      memcpy( &swap, &data[fft_swap[i][0]], sizeof( Float64 ) );
+      memcpy( &data[fft_swap[i][0]], &data[fft_swap[i][1]], sizeof( Float64 ) );
+      memcpy( &data[fft_swap[i][1]], &swap, sizeof( Float64 ) );
+   }
+
+   /* first stage, the butterflies of complex values 4n, 4n+1 and 4n+2, 4n+3 */
+   tr = _mm256_set1_pd( phs_tbl[0] );
+   ti = _mm256_set1_pd( phs_tbl[1] );
+
+   for ( k = 0; k < FFT_SIZE; k += 8 ) {
+      lo = _mm_loadu_ps( &data[k] );
+      hi = _mm_loadu_ps( &data[k + 4] );
+      Fft_butterfly2( _mm_shuffle_ps( lo, hi, _MM_SHUFFLE( 1, 0, 1, 0 ) ),
+            _mm_shuffle_ps( lo, hi, _MM_SHUFFLE( 3, 2, 3, 2 ) ), tr, ti, &top,
+            &bot );
+      _mm_storeu_ps( &data[k], _mm_shuffle_ps( top, bot, _MM_SHUFFLE( 1, 0, 1,
+            0 ) ) );
+      _mm_storeu_ps( &data[k + 4], _mm_shuffle_ps( top, bot, _MM_SHUFFLE( 3, 2,
+            3, 2 ) ) );
+   }
+
+   /* remaining stages, jj floats between top and bottom */
+   for ( jj = 4; jj < FFT_SIZE; jj <<= 1 ) {
+      ii = FFT_SIZE / jj;
+
+      for ( j = 0; j < jj; j += 4 ) {
+         ji = j * ii;
+         tr = _mm256_setr_pd( phs_tbl[ji], phs_tbl[ji], phs_tbl[ji + 2 * ii],
+               phs_tbl[ji + 2 * ii] );
+         ti = _mm256_setr_pd( phs_tbl[ji + 1], phs_tbl[ji + 1], phs_tbl[ji + 2 *
+               ii + 1], phs_tbl[ji + 2 * ii + 1] );
+
+         for ( k = j; k < FFT_SIZE; k += jj << 1 ) {
+            Fft_butterfly2( _mm_loadu_ps( &data[k] ), _mm_loadu_ps( &data[k + jj]
+                  ), tr, ti, &top, &bot );
+            _mm_storeu_ps( &data[k], top );
+            _mm_storeu_ps( &data[k + jj], bot );
+         }
+      }
+   }
+   return;
+}
+#endif
+
+
+/*
+ * Simd_Set_Mode
+ *
+ *
+ * Parameters:
+ *    mode              I: SIMD_OFF, SIMD_EXACT or SIMD_FAST
+ *
+ * Function:
+ *    Fills the kernel tables used by the encoder and the decoder
+ *
+ * Returns:
+ *    mode in use
+ */
+int Simd_Set_Mode( int mode )
+{
+   int supported = 0;
+
+
+#if defined(SIMD_AVX2)
+   __builtin_cpu_init( );
+   supported = __builtin_cpu_supports( "avx2" );
+#elif defined(SIMD_NEON)
+   supported = 1;
+#endif
+
+   if ( mode == SIMD_OFF || !supported ) {
+      memset( &simd_kernels, 0, sizeof( simd_kernels ) );
+      Simd_Dec_Set_Kernels( 0 );
+      return SIMD_OFF;
+   }
+#ifdef VL
+   simd_kernels.dotproduct40 = mode == SIMD_FAST ? Dotproduct40_fast :
+         Dotproduct40_exact;
+   simd_kernels.comp_corr = comp_corr_simd;
+   simd_kernels.cor_h_x = cor_h_x_simd;
+   simd_kernels.cor_h = cor_h_simd;
+   simd_kernels.convolve = Convolve_simd;
+#endif
+#ifdef SIMD_AVX2
+   simd_kernels.cmplx_fft = cmplx_fft_simd;
+#endif
+
+   /* the decoder is integer, its kernels are bit exact in both modes */
+   Simd_Dec_Set_Kernels( 1 );
+   return mode;
+}
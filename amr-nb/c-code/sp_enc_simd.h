@@ -0,0 +1,77 @@
+/*
+ * ===================================================================
+ *  TS 26.104
+ *  REL-5 V5.4.0 2004-03
+ *  REL-6 V6.1.0 2004-03
+ *  3GPP AMR Floating-point Speech Codec
+ * ===================================================================
+ *
+ */
+
+/*
+ * sp_enc_simd.h
+ *
+ *
+ * Project:
+ *    AMR Floating-Point Codec
+ *
+ * Contains:
+ *    Defines interface to the SIMD (AVX2 / NEON) versions of the
+ *    encoder correlation and VAD kernels
+ *
+ */
+#ifndef _SP_ENC_SIMD_H
+#define _SP_ENC_SIMD_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * include files
+ */
+#include "typedef.h"
+
+/*
+ * definition of kernel modes
+ *
+ * SIMD_OFF     reference C code
+ * SIMD_EXACT   vector code, bit exact with the reference C code
+ * SIMD_FAST    as SIMD_EXACT, but dot products are reassociated,
+ *              the output is no longer bit exact
+ */
+enum SimdMode { SIMD_OFF = 0,
+                SIMD_EXACT,
+                SIMD_FAST
+              };
+
+/*
+ * Kernel table, a NULL entry means the reference C code is used
+ */
+typedef struct
+{
+   Float64 ( *dotproduct40 )( Float32 *x, Float32 *y );
+   void ( *comp_corr )( Float32 sig[], Word32 L_frame, Word32 lag_max,
+         Word32 lag_min, Float32 corr[] );
+   void ( *cor_h_x )( Float32 h[], Float32 x[], Float32 dn[] );
+   void ( *cor_h )( Float32 h[], Float32 sign[], Float32 rr[][40] );
+   void ( *convolve )( Float32 x[], Float32 h[], Float32 y[] );
+   /* forward 64 point complex FFT of the VAD option 2 */
+   void ( *cmplx_fft )( Float32 *data, const Float64 *phs_tbl );
+}SimdKernels;
+
+extern SimdKernels simd_kernels;
+
+/*
+ * Function prototypes
+ */
+
+/*
+ * Selects the kernels for the whole process. It is not thread safe,
+ * call it before any encoder or decoder is running. It also sets the
+ * decoder kernels of sp_dec_simd.h. Returns the mode in use, that
+ * is SIMD_OFF if the CPU has neither AVX2 nor NEON.
+ */
+int Simd_Set_Mode( int mode );
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "amr-nb-file-decoder.h"
+#include "sp_enc_simd.h"
+#include "base/kaldi-common.h"
+#include "util/common-utils.h"
+#include "feat/wave-reader.h"
+#include "base/timer.h"
+
+static bool DecodeAmr(const std::string &amr_filename, bool use_mmap, kaldi::Matrix<kaldi::BaseFloat> *output_data) {
+  AmrNbFileDecoder decoder;
+  if (!decoder.Open(amr_filename, use_mmap)) {
+    KALDI_WARN << "Can not open " << amr_filename << " as an .amr file";
+    return false;
+  }
+  std::vector<short> pcm_out;
+  decoder.ReadAll(&pcm_out);
+  output_data->Resize(1, pcm_out.size());
+  for (size_t isample = 0; isample < pcm_out.size(); isample++) {
+    (*output_data)(0, isample) = pcm_out[isample];
+  }
+  return true;
+}
+
+int main(int argc, char *argv[] ) {
+  try {
+    using namespace kaldi;
+    const char *usage =
+      "decode AMR-NB .amr storage format (RFC 4867) files to 8kHz wav\n"
+      "Usage: decode-amr-nb [options] <amr-in-file> <wav-out-file>\n"
+      "   or: decode-amr-nb [options] --batch <amr-scp> <wav-wspecifier>\n"
+      " e.g.: decode-amr-nb input.amr output.wav\n"
+      "       decode-amr-nb --batch amr.scp ark,scp:wav.ark,wav.scp\n"
+      " where amr.scp has lines <utterance-id> <amr-file>\n";
+    ParseOptions po(usage);
+    bool use_mmap = true;
+    bool batch = false;
+    bool simd = true;
+    po.Register("mmap", &use_mmap, "map the .amr files into memory instead of reading them frame by frame");
+    po.Register("batch", &batch, "decode all the files of an scp table into a wav table");
+    po.Register("simd", &simd, "use the SIMD synthesis and post-filter kernels, bit exact with the reference C code");
+    po.Read(argc, argv);
+    if (po.NumArgs() != 2) {
+      po.PrintUsage();
+      exit(1);
+    }
+
+    if (simd && Simd_Set_Mode(SIMD_EXACT) != SIMD_EXACT) {
+      KALDI_WARN << "SIMD kernels not supported by this CPU, using the reference C code";
+    }
+    kaldi::Timer ATimer;
+    double total_seconds = 0.0;
+    int num_done = 0, num_err = 0;
+    kaldi::Matrix<kaldi::BaseFloat> output_data;
+    if (batch) {
+      std::vector<std::pair<std::string, std::string> > amr_table;
+      if (!ReadScriptFile(po.GetArg(1), true, &amr_table)) {
+        KALDI_ERR << "Can not read the table " << po.GetArg(1);
+      }
+      kaldi::TableWriter<kaldi::WaveHolder> wav_writer(po.GetArg(2));
+      for (size_t iutt = 0; iutt < amr_table.size(); iutt++) {
+        if (!DecodeAmr(amr_table[iutt].second, use_mmap, &output_data)) {
+          num_err++;
+          continue;
+        }
+        wav_writer.Write(amr_table[iutt].first, kaldi::WaveData(8000, output_data));
+        total_seconds += output_data.NumCols() / 8000.0;
+        num_done++;
+      }
+    } else {
+      if (!DecodeAmr(po.GetArg(1), use_mmap, &output_data)) {
+        return -1;
+      }
+      kaldi::WaveData wave_data_output(8000, output_data);
+      kaldi::Output ko(po.GetArg(2), true, false);
+      wave_data_output.Write(ko.Stream());
+      total_seconds = output_data.NumCols() / 8000.0;
+      num_done++;
+    }
+    std::cout << "decoded " << num_done << " files (" << num_err << " errors), RTF:"
+              << ATimer.Elapsed() / std::max(total_seconds, 1e-3) << "\n";
+    return num_done > 0 ? 0 : -1;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << "\n";
+    return -1;
+  }
+}
@@ -1,25 +1,84 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <cmath>
+#include <algorithm>
 #include "amr-nb-wrapper.h"
 #include "base/kaldi-common.h"
 #include "util/common-utils.h"
 #include "feat/wave-reader.h"
 #include "base/timer.h"
+#include "c-code/sp_enc_simd.h"
+#include "c-code/interf_enc.h"
 // #include "c-code/sp_enc.h"
 
+// segmental SNR of test against ref over 20ms segments, clamped to [-10, 35]dB
+static float SegmentalSnr(const short *ref, const short *test, int num_samples) {
+  const int seg_len = 160;
+  int num_segs = 0;
+  double snr_sum = 0.0;
+  for (int start = 0; start + seg_len <= num_samples; start += seg_len) {
+    double sig = 0.0, err = 0.0;
+    for (int i = start; i < start + seg_len; i++) {
+      double d = ref[i] - test[i];
+      sig += (double)ref[i] * ref[i];
+      err += d * d;
+    }
+    double snr = 10.0 * std::log10((sig + 1e-6) / (err + 1e-6));
+    snr_sum += std::max(-10.0, std::min(35.0, snr));
+    num_segs++;
+  }
+  return num_segs > 0 ? snr_sum / num_segs : 0.0f;
+}
+
 int main(int argc, char *argv[] ) {
   try {
     using namespace kaldi;
     const char *usage =
       "simulate GSM-EFR(8kHz) codec\n"
       "Usage: simulate-gsm-efr [options] <wav-in-file> <wav-out-file>\n"
-      " e.g.: simulate-gsm-efr input.wav output.wav\n";
+      " e.g.: simulate-gsm-efr input.wav output.wav\n"
+      "   or: simulate-amr-nb --modes=0,5,7 input.wav out-mr475.wav out-mr795.wav out-mr122.wav\n";
     ParseOptions po(usage);
     int mode_int = 0;
+    int simd_int = SIMD_EXACT;
+    int search_effort = 0;
+    bool dtx = false;
+    bool compare_effort = false;
+    bool pipeline = false;
+    std::string mode_trace_rxfilename;
+    float switch_prob = 0.0f;
+    int min_mode = 0, max_mode = 7, seed = 0;
+    std::string modes_str;
+    AmrNbChannelOptions channel;
+    int channel_seed = 0;
     po.Register("mode", &mode_int, "rate mode[0, 7], [worst]0:4.75kbps, [best]7:12.2kbps");
+    po.Register("simd", &simd_int, "codec kernels, 0:reference C, 1:SIMD bit exact, 2:SIMD fast (encoder not bit exact, the decoder kernels are always bit exact)");
+    po.Register("modes", &modes_str, "comma separated rate modes encoded in one pass, one <wav-out-file> per mode");
+    po.Register("mode-trace", &mode_trace_rxfilename, "text file with one rate mode[0, 7] per frame, overrides --mode");
+    po.Register("switch-prob", &switch_prob, "per-frame probability of a one step rate switch, starting from --mode");
+    po.Register("min-mode", &min_mode, "lowest rate mode reachable with --switch-prob");
+    po.Register("max-mode", &max_mode, "highest rate mode reachable with --switch-prob");
+    po.Register("seed", &seed, "random seed for --switch-prob");
+    po.Register("channel-p-gb", &channel.p_gb, "Gilbert-Elliott channel, per-frame probability of going from the good to the bad state");
+    po.Register("channel-p-bg", &channel.p_bg, "Gilbert-Elliott channel, per-frame probability of going from the bad to the good state");
+    po.Register("loss-good", &channel.loss_good, "frame loss rate in the good channel state");
+    po.Register("loss-bad", &channel.loss_bad, "frame loss rate in the bad channel state");
+    po.Register("ber-good", &channel.ber_good, "bit error rate in the good channel state");
+    po.Register("ber-bad", &channel.ber_bad, "bit error rate in the bad channel state");
+    po.Register("crc-class-a", &channel.crc_class_a, "decode frames with class A bit errors as bad frames, as the CRC of a real channel would");
+    po.Register("channel-seed", &channel_seed, "random seed for the channel");
+    po.Register("dtx", &dtx, "discontinuous transmission, inactive frames are sent as SID/NO_DATA and decoded as comfort noise");
+    po.Register("search-effort", &search_effort, "encoder search effort, 0:standard, 1:pruned, 2:integer pitch, 3:greedy pulses (1 to 3 are not bit exact)");
+    po.Register("pipeline", &pipeline, "run the encoder and the decoder on two threads, overlapping the encoding and the decoding of the utterance");
+    po.Register("compare-effort", &compare_effort, "also run the standard encoder with the same mode, DTX and channel options and report speed and segmental SNR against it");
     po.Read(argc, argv);
-    if (po.NumArgs() != 2) {
+    channel.seed = channel_seed;
+    std::vector<int32> mode_list;
+    if (!modes_str.empty() && !SplitStringToIntegers(modes_str, ",", true, &mode_list)) {
+      KALDI_ERR << "Invalid --modes " << modes_str;
+    }
+    if (po.NumArgs() != (mode_list.empty() ? 2 : 1 + (int)mode_list.size())) {
       po.PrintUsage();
       exit(1);
     }
@@ -34,7 +93,55 @@ int main(int argc, char *argv[] ) {
     kaldi::SubVector<kaldi::BaseFloat> data(wave_data.Data(), 0);
 
     kaldi::Matrix<kaldi::BaseFloat> output_data(1, data.Dim());
+    if (Simd_Set_Mode(simd_int) != simd_int) {
+      KALDI_WARN << "SIMD kernels not supported by this CPU, using the reference C code";
+    }
+    if (!mode_list.empty()) {
+      AmrNbWrapper amrnb_simulator(mode_int);
+      amrnb_simulator.SetSearchEffort(search_effort);
+      amrnb_simulator.SetDtx(dtx);
+      amrnb_simulator.SetChannel(channel);
+      std::vector<short> pcm_in(data.Dim());
+      std::vector<std::vector<short> > pcm_outs(mode_list.size(), std::vector<short>(data.Dim(), 0));
+      std::vector<char *> p_pcm_outs;
+      for (int isample = 0; isample < data.Dim(); isample++) {
+        pcm_in[isample] = (short) data(isample);
+      }
+      for (size_t imode = 0; imode < mode_list.size(); imode++) {
+        p_pcm_outs.push_back((char*)pcm_outs[imode].data());
+      }
+      std::vector<int> mode_ints(mode_list.begin(), mode_list.end());
+      kaldi::Timer ATimer;
+      amrnb_simulator.SimulateModes((const char*)pcm_in.data(), data.Dim(), mode_ints, p_pcm_outs);
+      std::cout << "RTF:" << ATimer.Elapsed() / (data.Dim() / 8000.0f) << " for " << mode_list.size() << " modes\n";
+      for (size_t imode = 0; imode < mode_list.size(); imode++) {
+        for (int isample = 0; isample < data.Dim(); isample++) {
+          output_data(0, isample) = pcm_outs[imode][isample];
+        }
+        kaldi::WaveData wave_data_output(wave_data.SampFreq(), output_data);
+        kaldi::Output ko(po.GetArg(2 + imode), true, false);
+        wave_data_output.Write(ko.Stream());
+      }
+      return 0;
+    }
+    std::vector<int> mode_trace;
+    if (!mode_trace_rxfilename.empty()) {
+      kaldi::Input ki(mode_trace_rxfilename);
+      int frame_mode;
+      while (ki.Stream() >> frame_mode) mode_trace.push_back(frame_mode);
+    }
+    // everything but the search effort, shared with the --compare-effort reference
+    // so that both runs see the same rate modes and the same channel realisation
+    auto configure = [&](AmrNbWrapper &simulator) {
+      if (!mode_trace_rxfilename.empty()) simulator.SetModeTrace(mode_trace);
+      simulator.SetRateAdaptation(switch_prob, min_mode, max_mode, seed);
+      simulator.SetDtx(dtx);
+      simulator.SetChannel(channel);
+      simulator.SetPipeline(pipeline);
+    };
     AmrNbWrapper amrnb_simulator(mode_int);
+    amrnb_simulator.SetSearchEffort(search_effort);
+    configure(amrnb_simulator);
     short *pcm_in = new short [data.Dim()];
     short *pcm_out = new short [data.Dim()];
     for (int isample = 0; isample < data.Dim(); isample++) {
@@ -47,6 +154,42 @@ int main(int argc, char *argv[] ) {
     amrnb_simulator.Simulate((const char*)pcm_in, in_samples, (char*)pcm_out);
     float time_elapsed = ATimer.Elapsed();
     std::cout << "RTF:" <<  time_elapsed / (data.Dim() / 8000.0f) << "\n";
+    if (dtx) {
+      std::cout << "SID frames:" << amrnb_simulator.NumSidFrames()
+                << ", NO_DATA frames:" << amrnb_simulator.NumNoDataFrames() << "\n";
+    }
+    if (channel.Enabled()) {
+      std::cout << "lost frames:" << amrnb_simulator.NumLostFrames()
+                << ", bad frames:" << amrnb_simulator.NumBadFrames()
+                << ", bit errors:" << amrnb_simulator.NumBitErrors() << "\n";
+    }
+    if (!mode_trace_rxfilename.empty() || switch_prob > 0.0f) {
+      const float mode_kbps[8] = {4.75f, 5.15f, 5.90f, 6.70f, 7.40f, 7.95f, 10.2f, 12.2f};
+      const std::vector<int> &frame_modes = amrnb_simulator.FrameModes();
+      int num_switches = 0;
+      float kbps_sum = 0.0f;
+      for (size_t iframe = 0; iframe < frame_modes.size(); iframe++) {
+        kbps_sum += mode_kbps[frame_modes[iframe]];
+        if (iframe > 0 && frame_modes[iframe] != frame_modes[iframe - 1]) num_switches++;
+      }
+      if (!frame_modes.empty()) {
+        std::cout << "rate switches:" << num_switches << ", average kbps:"
+                  << kbps_sum / frame_modes.size() << "\n";
+      }
+    }
+    if (compare_effort) {
+      AmrNbWrapper amrnb_reference(mode_int);
+      configure(amrnb_reference);
+      short *pcm_ref = new short [data.Dim()];
+      std::memset(pcm_ref, 0x0, sizeof(short) * data.Dim());
+      ATimer.Reset();
+      amrnb_reference.Simulate((const char*)pcm_in, in_samples, (char*)pcm_ref);
+      float ref_time_elapsed = ATimer.Elapsed();
+      std::cout << "reference RTF:" << ref_time_elapsed / (data.Dim() / 8000.0f)
+                << ", speedup:" << ref_time_elapsed / time_elapsed
+                << ", segSNR vs reference:" << SegmentalSnr(pcm_ref, pcm_out, in_samples) << "dB\n";
+      delete [] pcm_ref;
+    }
     for (int isample = 0; isample < data.Dim(); isample++) {
       output_data(0, isample) = pcm_out[isample];
     }
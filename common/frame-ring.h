@@ -0,0 +1,40 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <atomic>
+#include <thread>
+
+// lock free ring of frames from one producer thread (the encoder) to one
+// consumer thread (the decoder). head_ is written only by the producer and
+// tail_ only by the consumer, each on its own cache line; a full or empty
+// ring makes the waiting side yield
+template <typename Frame, unsigned int kCapacity>
+class FrameRing {
+  static_assert((kCapacity & (kCapacity - 1)) == 0, "kCapacity must be a power of 2");
+ public:
+  FrameRing(): head_(0), tail_(0) {};
+  // the slot of the next frame, filled in place and published by EndPush
+  Frame *BeginPush() {
+    unsigned int head = head_.load(std::memory_order_relaxed);
+    while (head - tail_.load(std::memory_order_acquire) == kCapacity) std::this_thread::yield();
+    return &frames_[head & (kCapacity - 1)];
+  }
+  void EndPush() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+  // the oldest frame, its slot is handed back to the producer by EndPop
+  Frame *BeginPop() {
+    unsigned int tail = tail_.load(std::memory_order_relaxed);
+    while (head_.load(std::memory_order_acquire) == tail) std::this_thread::yield();
+    return &frames_[tail & (kCapacity - 1)];
+  }
+  void EndPop() {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+ private:
+  alignas(64) std::atomic<unsigned int> head_;
+  alignas(64) std::atomic<unsigned int> tail_;
+  alignas(64) Frame frames_[kCapacity];
+};
+
+#endif
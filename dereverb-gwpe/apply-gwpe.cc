@@ -43,8 +43,8 @@ int main(int argc, char** argv) {
       float frame_shift_ms = 0.008;
       float frame_len_ms = frame_shift_ms * 4;
       int frame_len_samples = frame_len_ms * fs;
-      int fftlen = 1;
-      while (fftlen < frame_len_samples) {fftlen <<= 1;}
+      // no zero padding unless the frame length has a factor other than 2, 3, 5
+      int fftlen = RoundUpRealFftLength(frame_len_samples);
       spicax::WolaOptions wola_opts(num_chan, num_chan, fs, frame_shift_ms, frame_len_ms, fftlen);
       spicax::Wola wola(wola_opts);
 
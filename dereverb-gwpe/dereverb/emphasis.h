@@ -3,25 +3,85 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 namespace spicax {
+#if defined(__SSE2__)
+// floor of 4 floats as int32, exact for |x| < 2^31
+inline __m128i FloorToInt(__m128 x) {
+  __m128i t = _mm_cvttps_epi32(x);
+  __m128 back = _mm_cvtepi32_ps(t);
+  return _mm_add_epi32(t, _mm_castps_si128(_mm_cmpgt_ps(back, x)));
+}
+
+// sign-extended int16 -> float, low and high 4 lanes
+inline __m128 LowShortToFloat(__m128i v) {
+  return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+}
+inline __m128 HighShortToFloat(__m128i v) {
+  return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+}
+
+// shift lanes up by one float, lane 0 becomes 0
+inline __m128 ShiftUp1(__m128 v) {
+  return _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4));
+}
+inline __m128 ShiftUp2(__m128 v) {
+  return _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8));
+}
+#endif
+
+// y[n] = x[n] - alpha * x[n-1], x[-1] is the last input sample of the previous block,
+// so a stream can be filtered in blocks of any size.
 class PreEmphasis {
  public:
   PreEmphasis(float alpha = 0.9) : alpha_(alpha), last_(0), lastf_(0.0f) {}
   void Compute(short *in, int len) {
-    short tmp = in[len - 1];
-    for (int i = len - 1; i > 0; i--) {
-      in[i] -= (short)(std::floor((in[i - 1]) * alpha_));
+    if (len <= 0) return;
+    short prev = last_;
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 alpha = _mm_set1_ps(alpha_);
+    for (; i + 8 <= len; i += 8) {
+      __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+      __m128i shifted = _mm_insert_epi16(_mm_slli_si128(cur, 2), prev, 0);
+      prev = (short)_mm_extract_epi16(cur, 7);
+      __m128i lo = FloorToInt(_mm_mul_ps(LowShortToFloat(shifted), alpha));
+      __m128i hi = FloorToInt(_mm_mul_ps(HighShortToFloat(shifted), alpha));
+      cur = _mm_sub_epi16(cur, _mm_packs_epi32(lo, hi));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(in + i), cur);
     }
-    in[0] -= (short)(std::floor((last_ * alpha_)));
-    last_ = tmp;
+#endif
+    for (; i < len; i++) {
+      short tmp = in[i];
+      in[i] -= (short)(std::floor(prev * alpha_));
+      prev = tmp;
+    }
+    last_ = prev;
   }
   void Compute(float *in, int len) {
-    float tmp = in[len - 1];
-    for (int i = len - 1; i > 0; i--) {
-      in[i] -= in[i - 1] * alpha_;
+    if (len <= 0) return;
+    float prev = lastf_;
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 alpha = _mm_set1_ps(alpha_);
+    __m128 carry = _mm_set1_ps(prev);
+    for (; i + 4 <= len; i += 4) {
+      __m128 cur = _mm_loadu_ps(in + i);
+      // [carry, cur0, cur1, cur2]
+      __m128 shifted = _mm_move_ss(_mm_shuffle_ps(cur, cur, _MM_SHUFFLE(2, 1, 0, 3)), carry);
+      carry = _mm_shuffle_ps(cur, cur, _MM_SHUFFLE(3, 3, 3, 3));
+      _mm_storeu_ps(in + i, _mm_sub_ps(cur, _mm_mul_ps(shifted, alpha)));
+    }
+    prev = _mm_cvtss_f32(carry);
+#endif
+    for (; i < len; i++) {
+      float tmp = in[i];
+      in[i] -= prev * alpha_;
+      prev = tmp;
     }
-    in[0] -= (std::floor((lastf_ * alpha_)));
-    lastf_ = tmp;
+    lastf_ = prev;
   }
 
  private:
@@ -30,36 +90,91 @@ class PreEmphasis {
   float lastf_;
 };
 
+// y[n] = x[n] + alpha * y[n-1]. Each overload keeps its own unclipped y[n-1]
+// as state, so a stream can be filtered in blocks of any size.
 class DeEmphasis {
  public:
-  DeEmphasis(float alpha = 0.9) : alpha_(alpha), last_(0), lastf_(0.0f) {}
+  DeEmphasis(float alpha = 0.9) : alpha_(alpha), last_(0), lastf_(0.0f) {
+#if defined(__SSE2__)
+    phase_ = 0;
+    std::fill(quad_, quad_ + 4, 0.0f);
+#endif
+  }
+
+  // int16 in and out, y[n] = x[n] + floor(alpha * y[n-1]) on ints, the output
+  // is saturated to 16 bits. The floor makes it a strict recursion, it stays scalar.
   void Compute(short *in, int len) {
-    int tmp = (int)in[0] + (std::floor((last_ * alpha_)));
-    // in[0] += (short)(std::floor((last_ * alpha_)));
-    in[0] = (short)(std::max(std::min(tmp, 32767), -32768));
-    for (int i = 1; i < len; i++) {
+    int tmp = last_;
+    for (int i = 0; i < len; i++) {
       tmp = (int)in[i] + (std::floor((tmp * alpha_)));
       in[i] = (short)(std::max(std::min(tmp, 32767), -32768));
-      // in[i] += (short)(std::floor((in[i - 1] * alpha_)));
     }
-    last_ = in[len - 1];
+    last_ = tmp;
   }
 
+  // float in and out, the output is clipped to [-1, 1]
   void Compute(float *in, int len) {
-    float tmp = in[0] + last_ * alpha_;
-    in[0] = (std::max(std::min(tmp, 1.0f), -1.0f));
-    for (int i = 1; i < len; i++) {
-      tmp = in[i] + tmp * alpha_;
-      in[i] = std::max(std::min(tmp, 1.0f), -1.0f);
-      // in[i] += (short)(std::floor((in[i - 1] * alpha_)));
+    Filter(in, in, len);
+    for (int i = 0; i < len; i++) {
+      in[i] = std::max(std::min(in[i], 1.0f), -1.0f);
+    }
+  }
+
+  // no clipping, in and out may alias. With SSE2 the stream is cut into
+  // groups of 4 samples counted from its start and each group is solved with
+  // a two-step prefix scan. A group split by a block boundary is kept zero
+  // padded in quad_ and scanned again when it grows, lanes only depend on the
+  // lanes below them, so the output does not depend on the block sizes.
+  void Filter(const float *in, float *out, int len) {
+    int i = 0;
+#if defined(__SSE2__)
+    while (i < len) {
+      __m128 y;
+      if (phase_ == 0 && i + 4 <= len) {
+        y = Scan4(_mm_loadu_ps(in + i), lastf_);
+        _mm_storeu_ps(out + i, y);
+        i += 4;
+      } else {
+        int n = std::min(4 - phase_, len - i);
+        std::copy(in + i, in + i + n, quad_ + phase_);
+        float lanes[4];
+        y = Scan4(_mm_loadu_ps(quad_), lastf_);
+        _mm_storeu_ps(lanes, y);
+        std::copy(lanes + phase_, lanes + phase_ + n, out + i);
+        i += n;
+        phase_ += n;
+        if (phase_ < 4) break;
+        phase_ = 0;
+        std::fill(quad_, quad_ + 4, 0.0f);
+      }
+      lastf_ = _mm_cvtss_f32(_mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 3, 3, 3)));
+    }
+#endif
+    for (; i < len; i++) {
+      lastf_ = in[i] + lastf_ * alpha_;
+      out[i] = lastf_;
     }
-    lastf_ = in[len - 1];
   }
 
  private:
+#if defined(__SSE2__)
+  // y of the 4 samples in x, last is the y before them
+  __m128 Scan4(__m128 x, float last) const {
+    float a2 = alpha_ * alpha_;
+    x = _mm_add_ps(x, _mm_mul_ps(_mm_set1_ps(alpha_), ShiftUp1(x)));
+    x = _mm_add_ps(x, _mm_mul_ps(_mm_set1_ps(a2), ShiftUp2(x)));
+    __m128 powers = _mm_setr_ps(alpha_, a2, a2 * alpha_, a2 * a2);
+    return _mm_add_ps(x, _mm_mul_ps(powers, _mm_set1_ps(last)));
+  }
+
+  // with SSE2 lastf_ is the y before the current group of 4
+  int phase_;      // samples of the current group already output
+  float quad_[4];  // their inputs, zero padded
+#endif
+
   float alpha_;
   int last_;
   float lastf_;
 };
 }  // namespace spicax
-#endif
\ No newline at end of file
+#endif
@@ -16,28 +16,33 @@ bool GeneralizedWpe::Init(const GeneralizedWpeOptions & opts) {
   for (int ibin = startbin_; ibin < upperbin_; ibin++) {
     g_[ibin].setZero(num_chan_ * num_chan_, filterlen_);
   }
-  gbin_.setZero(num_chan_ * num_chan_, filterlen_);
+  gbin_.setZero(num_chan_ * filterlen_, num_chan_);
   R_.setZero(num_chan_ * filterlen_, num_chan_ * filterlen_);
   r_.setZero(num_chan_ * filterlen_, num_chan_);
   return true;
 }
 
+// spec: (num_bins * num_chan) x num_frames -> bins: (num_chan * num_frames) x num_bins
+void GeneralizedWpe::ToBinMajor(const Eigen::MatrixXcf &spec, Eigen::MatrixXcf &bins) {
+  int num_frames = spec.cols();
+  bins.resize(num_chan_ * num_frames, num_bins_);
+  for (int ichan = 0; ichan < num_chan_; ichan++) {
+    StridedMap chan(bins.data() + ichan, num_frames, num_bins_,
+                    Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(num_chan_ * num_frames, num_chan_));
+    chan = spec.middleRows(ichan * num_bins_, num_bins_).transpose();
+  }
+}
+
 //array_spec: FN * num_frames
 void GeneralizedWpe::BuildYTilde(const Eigen::MatrixXcf &array_spec) {
   int num_frames = array_spec.cols();
-  Eigen::VectorXcf y_t;
   for (int ibin = startbin_; ibin < upperbin_; ibin++) {
     y_tilde_[ibin].setZero(num_chan_ * filterlen_, num_frames);
-  }
-
-  for (int iframe = 0; iframe < (num_frames - opts_.delta); iframe++) {
-    Eigen::Map<const Eigen::MatrixXcf> array_frame(&(array_spec(0, iframe)), num_bins_, num_chan_);
-    for (int ibin = startbin_; ibin < upperbin_; ibin++) {
-      y_tilde_[ibin].col(iframe + opts_.delta).head(num_chan_) = array_frame.row(ibin).head(num_chan_);
+    if (num_frames > opts_.delta) {
+      Eigen::Map<const Eigen::MatrixXcf> y_bin(in_bins_.col(ibin).data(), num_chan_, num_frames);
+      y_tilde_[ibin].topRows(num_chan_).rightCols(num_frames - opts_.delta) =
+        y_bin.leftCols(num_frames - opts_.delta);
     }
-  }
-
-  for (int ibin = startbin_; ibin < upperbin_; ibin++) {
     for (int k = 1; k < filterlen_; k++) {
       y_tilde_[ibin].middleRows(k * num_chan_, num_chan_).rightCols(num_frames - 1) =
         y_tilde_[ibin].middleRows((k - 1) * num_chan_, num_chan_).leftCols(num_frames - 1);
@@ -45,70 +50,45 @@ void GeneralizedWpe::BuildYTilde(const Eigen::MatrixXcf &array_spec) {
   }
 }
 
-float GeneralizedWpe::EstimateInvLambda(const Eigen::MatrixXcf &out_spec, int ibin, int iframe) {
+void GeneralizedWpe::EstimateInvLambda(int ibin, int num_frames) {
   int psd_context = opts_.psd_context;
-  Eigen::MatrixXcf psd_mat;
-  // int psd_context_all = psd_context * 2 + 1;
-
-  // psd_mat.setZero(psd_context_all, num_chan_ * psd_context_all);
-  int num_frames = out_spec.cols();
-
-  int frame_start = std::max(iframe - psd_context, 0);
-  int frame_end   = std::min(iframe + psd_context, num_frames - 1);
-  int psd_mat_cols = frame_end - frame_start + 1;
   int bin_start   = std::max(ibin - psd_context, 0);
   int bin_end     = std::min(ibin + psd_context, num_bins_ - 1);
   int psd_mat_rows = bin_end - bin_start + 1;
 
-  psd_mat.setZero(num_chan_ * psd_mat_rows, psd_mat_cols);
-  // KALDI_LOG << "psd_mat.rows()=" << psd_mat.rows() << ",psd_mat.cols()=" << psd_mat.cols() << "\n";
-
-  for (int ichan = 0; ichan < num_chan_; ichan++) {
-    psd_mat.middleRows(ichan * psd_mat_rows, psd_mat_rows)
-      = out_spec.block(ichan * num_bins_ + bin_start, frame_start, psd_mat_rows, psd_mat_cols);
+  // power of the (bin context x channel) block of each frame, every bin is a
+  // contiguous num_chan x num_frames matrix in out_bins_
+  frame_power_.setZero(num_frames);
+  for (int jbin = bin_start; jbin <= bin_end; jbin++) {
+    Eigen::Map<const Eigen::MatrixXcf> out_bin(out_bins_.col(jbin).data(), num_chan_, num_frames);
+    frame_power_ += out_bin.colwise().squaredNorm().transpose();
   }
 
-  // for (int frame_context = -psd_context; frame_context <= psd_context; frame_context++) {
-  //   int current_frame = iframe + frame_context;
-  //   current_frame = std::max(std::min(current_frame, num_frames - 1), 0);
-  //   Eigen::Map<const Eigen::MatrixXcf> output_frame(&(out_spec(0, current_frame)), num_bins_, num_chan_);
-  //   for (int bin_context = -psd_context; bin_context <= psd_context; bin_context++) {
-  //     int current_bin = ibin + bin_context;
-  //     current_bin = std::max(std::min(current_bin, num_bins_ - 1), 0);
-  //     psd_mat.block(bin_context + psd_context, (frame_context + psd_context) * num_chan_, 1, num_chan_) = output_frame.row(current_bin);
-  //   }
-  // }
-
-  // psd_mat.middleCols();
-  float lambda = psd_mat.cwiseAbs2().mean();
-  // lambda = std::max(lambda, 1000.0f);
-  lambda = 1.0f / (lambda + 1.0f);
-  // lambda = std::min(lambda, 5e-8f);
-  return lambda;
+  // mean over the frame context
+  inv_Lamba_.resize(num_frames);
+  for (int iframe = 0; iframe < num_frames; iframe++) {
+    int frame_start = std::max(iframe - psd_context, 0);
+    int frame_end   = std::min(iframe + psd_context, num_frames - 1);
+    int psd_mat_cols = frame_end - frame_start + 1;
+    float lambda = frame_power_.segment(frame_start, psd_mat_cols).sum() /
+                   (num_chan_ * psd_mat_rows * psd_mat_cols);
+    inv_Lamba_(iframe) = 1.0f / (lambda + 1.0f);
+  }
 }
 
-void GeneralizedWpe::CalculateRr(const Eigen::MatrixXcf &array_spec, Eigen::MatrixXcf &out_spec) {
-  Eigen::VectorXcf y_tilde_1;
-  Eigen::VectorXcf y_t, est_reverb;
-  Eigen::VectorXcf est_g;
+void GeneralizedWpe::CalculateRr(const Eigen::MatrixXcf &array_spec) {
   int num_frames = array_spec.cols();
   Eigen::LLT<Eigen::MatrixXcf> qr(num_chan_ * filterlen_);
   for (int ibin = startbin_; ibin < upperbin_; ibin++) {
+    Eigen::Map<const Eigen::MatrixXcf> y_bin(in_bins_.col(ibin).data(), num_chan_, num_frames);
+    Eigen::Map<Eigen::MatrixXcf> out_bin(out_bins_.col(ibin).data(), num_chan_, num_frames);
+    const Eigen::MatrixXcf &y_tilde = y_tilde_[ibin];
     for (int iter = 0; iter < num_iter_; iter++) {
-      R_.setZero(num_chan_ * filterlen_, num_chan_ * filterlen_);
-      r_.setZero(num_chan_ * filterlen_, num_chan_);
-      for (int iframe = 0 ; iframe < num_frames; iframe++) {
-        // Eigen::Map<const Eigen::MatrixXcf> array_frame(&(array_spec(0, iframe)), num_bins_, num_chan_);
-        // y_t = array_frame.row(ibin);
-        y_tilde_1 = y_tilde_[ibin].col(iframe);
-        float Lambda = EstimateInvLambda(out_spec, ibin, iframe);
-
-        R_ +=  y_tilde_1 * y_tilde_1.adjoint() * Lambda;
-        for (int ichan = 0; ichan < num_chan_; ichan++) {
-          // r_.col(ichan) += y_tilde_1 * std::conj(y_t(ichan)) * Lambda;
-          r_.col(ichan) += y_tilde_1 * std::conj(array_spec(ichan * num_bins_ + ibin, iframe)) * Lambda;
-        }
-      }
+      EstimateInvLambda(ibin, num_frames);
+      // R = sum_t lambda_t * y_tilde_t * y_tilde_t^H, r = sum_t lambda_t * y_tilde_t * y_t^H
+      weighted_y_tilde_.noalias() = y_tilde * inv_Lamba_.cast<std::complex<float> >().asDiagonal();
+      R_.noalias() = weighted_y_tilde_ * y_tilde.adjoint();
+      r_.noalias() = weighted_y_tilde_ * y_bin.adjoint();
 
       float R_trace = R_.trace().real() * 1e-4f;
       for (int j = 0; j < num_chan_ * filterlen_; j++) {R_(j, j) += R_trace;}
@@ -116,37 +96,32 @@ void GeneralizedWpe::CalculateRr(const Eigen::MatrixXcf &array_spec, Eigen::Matr
       r_ *= 1e-3f;
       // KALDI_LOG << "iter=" << iter << ",ibin=" << ibin << ",R.trace()=" << R_.trace().real() << ",R.det()=" << R_.determinant().real() << "\n";
       qr.compute(R_);
-      for (int ichan = 0; ichan < num_chan_; ichan++) {
-        // est_g = R_.colPivHouseholderQr().solve(r_.col(ichan));
-        est_g = qr.solve(r_.col(ichan));
-        Eigen::Map<const Eigen::MatrixXcf> est_g_reshape(&(est_g(0, 0)), num_chan_, filterlen_);
-        gbin_.middleRows(ichan * num_chan_, num_chan_) = est_g_reshape;
-      }
+      gbin_ = qr.solve(r_);
 
-      //filter
-      for (int iframe = 0; iframe < num_frames; iframe++) {
-        Eigen::Map<const Eigen::MatrixXcf> array_frame(&(array_spec(0, iframe)), num_bins_, num_chan_);
-        y_t = array_frame.row(ibin);
-        est_reverb.setZero(num_chan_);
-        for (int k = 0; k < filterlen_; k++) {
-          Eigen::Map<const Eigen::MatrixXcf> Gk(&(gbin_(0, k)), num_chan_, num_chan_);
-          Eigen::Map<const Eigen::VectorXcf> y_tilde_2(&(y_tilde_[ibin](k * num_chan_, iframe)), num_chan_);
-          est_reverb += Gk.adjoint() * y_tilde_2;
-        }
-        Eigen::Map<Eigen::MatrixXcf> output_frame(&(out_spec(0, iframe)), num_bins_, num_chan_);
-        output_frame.row(ibin) = y_t - est_reverb;
-      }
+      //filter: out = y - sum_k G_k^H * y_tilde_k = y - gbin^H * y_tilde, all frames at once
+      out_bin = y_bin;
+      out_bin.noalias() -= gbin_.adjoint() * y_tilde;
     }
   }
 }
-void GeneralizedWpe::EstimateG(const Eigen::MatrixXcf &array_spec, Eigen::MatrixXcf &out_spec) {
-  CalculateRr(array_spec, out_spec);
+void GeneralizedWpe::EstimateG(const Eigen::MatrixXcf &array_spec) {
+  CalculateRr(array_spec);
 }
 void GeneralizedWpe::Dereverb(const Eigen::MatrixXcf &array_spec, Eigen::MatrixXcf &out_spec) {
+  int num_frames = array_spec.cols();
+  ToBinMajor(array_spec, in_bins_);
+  out_bins_ = in_bins_;
   BuildYTilde(array_spec);
   out_spec = array_spec.topRows(num_bins_ * num_chan_);
 
-  EstimateG(array_spec, out_spec);
+  EstimateG(array_spec);
+  // write the processed bins back in one pass
+  for (int ichan = 0; ichan < num_chan_; ichan++) {
+    StridedMap chan(out_bins_.data() + ichan, num_frames, num_bins_,
+                    Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(num_chan_ * num_frames, num_chan_));
+    out_spec.middleRows(ichan * num_bins_ + startbin_, upperbin_ - startbin_) =
+      chan.middleCols(startbin_, upperbin_ - startbin_).transpose();
+  }
   for(int ichan = 0; ichan < num_chan_; ichan++){
     out_spec.middleRows(ichan * num_bins_, lowerbin_).setZero();
   }
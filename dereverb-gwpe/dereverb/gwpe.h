@@ -30,10 +30,13 @@ class GeneralizedWpe {
   bool Init(const GeneralizedWpeOptions & opts);
   void Dereverb(const Eigen::MatrixXcf &array_spec, Eigen::MatrixXcf &out_spec);
  private:
+  typedef Eigen::Map<Eigen::MatrixXcf, 0, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic> > StridedMap;
+  void ToBinMajor(const Eigen::MatrixXcf &spec, Eigen::MatrixXcf &bins);
   void BuildYTilde(const Eigen::MatrixXcf &array_spec);
-  float EstimateInvLambda(const Eigen::MatrixXcf &out_spec, int ibin, int iframe);
-  void CalculateRr(const Eigen::MatrixXcf &array_spec, Eigen::MatrixXcf &out_spec);
-  void EstimateG(const Eigen::MatrixXcf &array_spec, Eigen::MatrixXcf &out_spec);
+  // fills inv_Lamba_ with 1 / (psd + 1) of every frame of ibin, from out_bins_
+  void EstimateInvLambda(int ibin, int num_frames);
+  void CalculateRr(const Eigen::MatrixXcf &array_spec);
+  void EstimateG(const Eigen::MatrixXcf &array_spec);
   GeneralizedWpeOptions opts_;
   int num_bins_;
   int lowerbin_;
@@ -44,11 +47,17 @@ class GeneralizedWpe {
   int filterlen_;
   std::vector<Eigen::MatrixXcf> y_tilde_;//num_bins * (NK * num_frames)
   std::vector<Eigen::MatrixXcf> g_; // num_bins * (NN * K)
-  Eigen::MatrixXcf gbin_;
+  Eigen::MatrixXcf gbin_; // NK * N, column n stacks the K taps of output channel n
+  // bin-major copies of the input and output spectrum, column ibin holds the
+  // num_chan * num_frames matrix of that bin, so each bin is read and written contiguously
+  Eigen::MatrixXcf in_bins_;
+  Eigen::MatrixXcf out_bins_;
+  Eigen::MatrixXcf weighted_y_tilde_; // NK * num_frames
   Eigen::MatrixXcf R_;// NK * NK
   Eigen::MatrixXcf r_;//NK * N
   Eigen::MatrixXf inv_x_power_;
   Eigen::VectorXf inv_Lamba_;
+  Eigen::VectorXf frame_power_;
 };
 }
 #endif
\ No newline at end of file
@@ -1,81 +1,96 @@
 #include "r2fft.h"
 #define _USE_MATH_DEFINES
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <map>
+#include <mutex>
 
 #ifndef M_2PI
 #define M_2PI 6.283185307179586476925286766559005
 #endif
 
 template<typename Real>
-void Radix2ComplexFft<Real>::Init(int N) {
-  Release();
-  N_ = N;
-  ComputeTwiddle();
-}
-
-template<typename Real>
-void Radix2ComplexFft<Real>::Release() {
-  N_ = 0;
-  if (NULL != butter_) {
-    delete[] butter_;
-    butter_ = NULL;
-  }
-  if (NULL != twiddle_) {
-    delete[] twiddle_;
-    twiddle_ = NULL;
-  }
-  if (NULL != bitswap_) {
-    delete[] bitswap_;
-    bitswap_ = NULL;
-  }
-}
-
-template<typename Real>
-void Radix2ComplexFft<Real>::ComputeTwiddle() {
+Radix2ComplexTables<Real>::Radix2ComplexTables(int N)
+  : N(N), twiddle(N), butter(std::max(N >> 1, 1)), bitswap(N) {
   int C, L, K;
   Real theta;
-  int N_2 = N_ >> 1;
-  butter_ = new int[N_2];
-  bitswap_ = new int[N_];
-  twiddle_ = new Real[N_];
+  int N_2 = N >> 1;
 
   for (C = 0; C < N_2; C++) {
-    theta = (M_2PI * C) / N_;
-    twiddle_[2 * C] = (Real)cos(theta);
-    twiddle_[2 * C + 1] = (Real)sin(theta);
+    theta = (M_2PI * C) / N;
+    twiddle[2 * C] = (Real)cos(theta);
+    twiddle[2 * C + 1] = (Real)sin(theta);
   }
 
-  butter_[0] = 0;
+  butter[0] = 0;
   L = 1;
-  K = N_ >> 2;
+  K = N >> 2;
   while (K >= 1) {
-    for (C = 0; C < L; C++) butter_[C + L] = butter_[C] + K;
+    for (C = 0; C < L; C++) butter[C + L] = butter[C] + K;
     L <<= 1;
     K >>= 1;
   }
+
+  for (C = 0; C < N_2; C++) {
+    bitswap[C] = butter[C] << 1;
+    bitswap[C + N_2] = 1 + bitswap[C];
+  }
 }
+
 template<typename Real>
-Radix2ComplexFft<Real>::~Radix2ComplexFft() {
-  Release();
+MixedRadixComplexTables<Real>::MixedRadixComplexTables(int N)
+  : N(N), twiddle(2 * N) {
+  int n = N;
+  while (n > 1) {
+    int r = (n % 4 == 0) ? 4 : (n % 2 == 0) ? 2 : (n % 3 == 0) ? 3 : 5;
+    radix.push_back(r);
+    n /= r;
+  }
+
+  double theta;
+  for (int j = 0; j < N; j++) {
+    theta = (M_2PI * j) / N;
+    twiddle[2 * j] = (Real)cos(theta);
+    twiddle[2 * j + 1] = (Real)sin(theta);
+  }
 }
+
 template<typename Real>
-Radix2ComplexFft<Real>::Radix2ComplexFft(const Radix2ComplexFft<Real> &other) {
-  if (NULL != butter_) delete[] butter_;
-  butter_ = NULL;
-  if (NULL != twiddle_) delete[] twiddle_;
-  twiddle_ = NULL;
-  if (NULL != bitswap_) delete[] bitswap_;
-  bitswap_ = NULL;
-  N_ = other.N_;
-
-  ComputeTwiddle();
+RealFftTables<Real>::RealFftTables(int N) : N(N), Wnk(N) {
+  Real *p = &Wnk[0];
+  Real theta;
+  for (int i = 0; i < N / 2; i++) {
+    theta = (M_2PI * i) / N;
+    *p++ = cos(theta);
+    *p++ = sin(theta);
+  }
+}
+
+template<typename Tables>
+std::shared_ptr<const Tables> GetFftTables(int N) {
+  static std::mutex mutex;
+  static std::map<int, std::shared_ptr<const Tables> > cache;
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<const Tables> &tables = cache[N];
+  if (!tables) tables = std::make_shared<const Tables>(N);
+  return tables;
+}
+
+template<typename Real>
+void Radix2ComplexFft<Real>::Init(int N) {
+  N_ = N;
+  tables_ = GetFftTables<Radix2ComplexTables<Real> >(N);
 }
 
 template<typename Real>
 void Radix2ComplexFft<Real>::Compute(Real *x, int N, bool forward) {
   if (N_ != N) Init(N);
+  const Real *twiddle_ = &tables_->twiddle[0];
+  const int *butter_ = &tables_->butter[0];
+  const int *bitswap_ = &tables_->bitswap[0];
 
   int Cycle, C, S, NC;
   int Step = N_ >> 1;
@@ -108,14 +123,8 @@ void Radix2ComplexFft<Real>::Compute(Real *x, int N, bool forward) {
     }
   }
 
-  NC = N_ >> 1;
-  for (C = 0; C < NC; C++) {
-    bitswap_[C] = butter_[C] << 1;
-    bitswap_[C + NC] = 1 + bitswap_[C];
-  }
   for (C = 0; C < N_; C++) {
-    if ((S = bitswap_[C]) != C) {
-      bitswap_[S] = S;
+    if ((S = bitswap_[C]) > C) {
       K1 = C << 1;
       K2 = S << 1;
       R1 = x[K1];
@@ -132,57 +141,179 @@ void Radix2ComplexFft<Real>::Compute(Real *x, int N, bool forward) {
   }
 }
 
+int RoundUpRealFftLength(int n) {
+  int N = std::max(n, 2);
+  if (N % 2 != 0) N++;
+  while (!MixedRadixComplexFft<float>::IsSupportedLength(N / 2)) N += 2;
+  return N;
+}
+
 template<typename Real>
-void Radix2RealFft<Real>::Init(int N) {
-  if (N_ == N) return;
-  if ((N & (N - 1)) != 0)
-    return ;
-  Release();
+bool MixedRadixComplexFft<Real>::IsSupportedLength(int N) {
+  if (N <= 0) return false;
+  while (N % 2 == 0) N /= 2;
+  while (N % 3 == 0) N /= 3;
+  while (N % 5 == 0) N /= 5;
+  return N == 1;
+}
 
+template<typename Real>
+void MixedRadixComplexFft<Real>::Init(int N) {
+  N_ = 0;
+  tables_.reset();
+  if (!IsSupportedLength(N)) {
+    std::cerr << "MixedRadixComplexFft: unsupported length " << N << "\n";
+    std::abort();
+  }
   N_ = N;
-  r2cfft_ = new Radix2ComplexFft<Real>;
-  Wnk_ = new Real[N_];
-  y_ = new Real[N_];
+  tables_ = GetFftTables<MixedRadixComplexTables<Real> >(N);
+  work_.resize(2 * N_);
+}
 
-  Real *p;
-  p = Wnk_;
-  Real theta;
-  for (int i = 0; i < N_ / 2; i++) {
-    theta = (M_2PI * i) / N_;
-    *p++ = cos(theta);
-    *p++ = sin(theta);
+// r-point DFT of a[0 .. r-1] into b[0 .. r-1], both as [re im] pairs.
+// sign is -1 for the forward transform and +1 for the inverse one.
+template<typename Real>
+static inline void SmallDft(int r, Real sign, const Real *a, Real *b) {
+  switch (r) {
+    case 2: {
+      b[0] = a[0] + a[2];
+      b[1] = a[1] + a[3];
+      b[2] = a[0] - a[2];
+      b[3] = a[1] - a[3];
+      break;
+    }
+    case 3: {
+      const Real c = -0.5, sn = sign * (Real)0.866025403784438646763723170753;
+      Real tr = a[2] + a[4], ti = a[3] + a[5];
+      Real dr = a[2] - a[4], di = a[3] - a[5];
+      Real mr = a[0] + c * tr, mi = a[1] + c * ti;
+      b[0] = a[0] + tr;
+      b[1] = a[1] + ti;
+      b[2] = mr - sn * di;
+      b[3] = mi + sn * dr;
+      b[4] = mr + sn * di;
+      b[5] = mi - sn * dr;
+      break;
+    }
+    case 4: {
+      Real s0r = a[0] + a[4], s0i = a[1] + a[5];
+      Real d0r = a[0] - a[4], d0i = a[1] - a[5];
+      Real s1r = a[2] + a[6], s1i = a[3] + a[7];
+      Real d1r = a[2] - a[6], d1i = a[3] - a[7];
+      // (sign * i) * d1
+      Real wr = -sign * d1i, wi = sign * d1r;
+      b[0] = s0r + s1r;
+      b[1] = s0i + s1i;
+      b[2] = d0r + wr;
+      b[3] = d0i + wi;
+      b[4] = s0r - s1r;
+      b[5] = s0i - s1i;
+      b[6] = d0r - wr;
+      b[7] = d0i - wi;
+      break;
+    }
+    case 5: {
+      const Real c1 = 0.309016994374947424102293417183;
+      const Real c2 = -0.809016994374947424102293417183;
+      const Real s1 = sign * (Real)0.951056516295153572116439333379;
+      const Real s2 = sign * (Real)0.587785252292473129168705954639;
+      Real t1r = a[2] + a[8], t1i = a[3] + a[9];
+      Real t2r = a[4] + a[6], t2i = a[5] + a[7];
+      Real d1r = a[2] - a[8], d1i = a[3] - a[9];
+      Real d2r = a[4] - a[6], d2i = a[5] - a[7];
+      Real m1r = a[0] + c1 * t1r + c2 * t2r, m1i = a[1] + c1 * t1i + c2 * t2i;
+      Real m2r = a[0] + c2 * t1r + c1 * t2r, m2i = a[1] + c2 * t1i + c1 * t2i;
+      Real n1r = s1 * d1r + s2 * d2r, n1i = s1 * d1i + s2 * d2i;
+      Real n2r = s2 * d1r - s1 * d2r, n2i = s2 * d1i - s1 * d2i;
+      b[0] = a[0] + t1r + t2r;
+      b[1] = a[1] + t1i + t2i;
+      b[2] = m1r - n1i;
+      b[3] = m1i + n1r;
+      b[8] = m1r + n1i;
+      b[9] = m1i - n1r;
+      b[4] = m2r - n2i;
+      b[5] = m2i + n2r;
+      b[6] = m2r + n2i;
+      b[7] = m2i - n2r;
+      break;
+    }
   }
 }
 
 template<typename Real>
-void Radix2RealFft<Real>::Release() {
-  N_ = 0;
-  if (Wnk_ != NULL) delete[] Wnk_;
-  Wnk_ = NULL;
-  if (y_ != NULL) delete[] y_;
-  y_ = NULL;
-  if (r2cfft_ != NULL) delete r2cfft_;
-  r2cfft_ = NULL;
+void MixedRadixComplexFft<Real>::Compute(Real *x, int N, bool forward) {
+  if (N_ != N) Init(N);
+
+  const Real *twiddle_ = &tables_->twiddle[0];
+  int num_stages = tables_->radix.size();
+
+  Real sign = forward ? -1 : 1;
+  Real a[10], b[10];
+  Real *src = x, *dst = &work_[0];
+  int n = N_, stride = 1;
+  for (int stage = 0; stage < num_stages; stage++) {
+    int r = tables_->radix[stage];
+    int m = n / r;
+    int tw_step = N_ / n;
+    for (int p = 0; p < m; p++) {
+      for (int q = 0; q < stride; q++) {
+        for (int j = 0; j < r; j++) {
+          const Real *in = src + 2 * (q + stride * (p + j * m));
+          a[2 * j] = in[0];
+          a[2 * j + 1] = in[1];
+        }
+        SmallDft(r, sign, a, b);
+        Real *out = dst + 2 * (q + stride * r * p);
+        out[0] = b[0];
+        out[1] = b[1];
+        for (int k = 1; k < r; k++) {
+          const Real *w = twiddle_ + 2 * (p * k * tw_step);
+          Real wr = w[0], wi = sign * w[1];
+          out[2 * stride * k] = b[2 * k] * wr - b[2 * k + 1] * wi;
+          out[2 * stride * k + 1] = b[2 * k] * wi + b[2 * k + 1] * wr;
+        }
+      }
+    }
+    std::swap(src, dst);
+    n = m;
+    stride *= r;
+  }
+  if (src != x) std::memcpy(x, src, 2 * N_ * sizeof(Real));
+
+  if (!forward) {
+    int NC = N_ << 1;
+    for (int C = 0; C < NC;) x[C++] /= N_;
+  }
 }
 
 template<typename Real>
-Radix2RealFft<Real>::~Radix2RealFft() {
-  Release();
+bool Radix2RealFft<Real>::IsSupportedLength(int N) {
+  return N % 2 == 0 && MixedRadixComplexFft<Real>::IsSupportedLength(N / 2);
 }
 
 template<typename Real>
-Radix2RealFft<Real>::Radix2RealFft(const Radix2RealFft &other) : N_(other.N_) {
-  Init(N_);
+void Radix2RealFft<Real>::Init(int N) {
+  if (N_ == N) return;
+  if (!IsSupportedLength(N)) {
+    std::cerr << "Radix2RealFft: unsupported length " << N << "\n";
+    std::abort();
+  }
+
+  N_ = N;
+  use_radix2_ = ((N & (N - 1)) == 0);
+  tables_ = GetFftTables<RealFftTables<Real> >(N);
+  y_.resize(N_);
 }
 
 template<typename Real>
 void Radix2RealFft<Real>::Compute(Real *x, int N, bool forward) {
   if (N_ != N) Init(N);
+  const Real *Wnk_ = &tables_->Wnk[0];
 
   Real forward_backward;
   if (forward) {
     forward_backward = 1;
-    r2cfft_->Compute(x, N / 2, true);
+    ComputeComplex(x, N / 2, true);
   } else {
     forward_backward = -1;
   }
@@ -219,12 +350,35 @@ void Radix2RealFft<Real>::Compute(Real *x, int N, bool forward) {
     y_[1] = (x[0] - x[1]) / 2;
   }
 
-  std::memcpy(x, y_, N_ * sizeof(Real));
+  std::memcpy(x, &y_[0], N_ * sizeof(Real));
+
+  if (!forward) ComputeComplex(x, N / 2, false);
+}
 
-  if (!forward) r2cfft_->Compute(x, N / 2, false);
+template<typename Real>
+void Radix2RealFft<Real>::ComputeComplex(Real *x, int N, bool forward) {
+  if (use_radix2_) {
+    r2cfft_.Compute(x, N, forward);
+  } else {
+    mrcfft_.Compute(x, N, forward);
+  }
 }
 
+template struct Radix2ComplexTables<float>;
+template struct Radix2ComplexTables<double>;
+template struct MixedRadixComplexTables<float>;
+template struct MixedRadixComplexTables<double>;
+template struct RealFftTables<float>;
+template struct RealFftTables<double>;
+template std::shared_ptr<const Radix2ComplexTables<float> > GetFftTables(int N);
+template std::shared_ptr<const Radix2ComplexTables<double> > GetFftTables(int N);
+template std::shared_ptr<const MixedRadixComplexTables<float> > GetFftTables(int N);
+template std::shared_ptr<const MixedRadixComplexTables<double> > GetFftTables(int N);
+template std::shared_ptr<const RealFftTables<float> > GetFftTables(int N);
+template std::shared_ptr<const RealFftTables<double> > GetFftTables(int N);
 template class Radix2ComplexFft<float>;
 template class Radix2ComplexFft<double>;
+template class MixedRadixComplexFft<float>;
+template class MixedRadixComplexFft<double>;
 template class Radix2RealFft<float>;
 template class Radix2RealFft<double>;
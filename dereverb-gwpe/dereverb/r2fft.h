@@ -1,20 +1,51 @@
 #ifndef RADIX2FFT_H
 #define RADIX2FFT_H
 #include <complex>
+#include <memory>
+#include <vector>
 
 using std::complex;
+
+// Immutable tables of one transform length. They are built once per process
+// by GetFftTables() and shared by every fft object of that length, so each
+// object only owns its mutable scratch buffers.
+template<typename Real>
+struct Radix2ComplexTables {
+  explicit Radix2ComplexTables(int N);
+  int N;
+  std::vector<Real> twiddle;  // twiddler factor : same as equation expression Wnk
+  std::vector<int> butter;    // butterfly order
+  std::vector<int> bitswap;   // final permutation, it is an involution
+};
+
+template<typename Real>
+struct MixedRadixComplexTables {
+  explicit MixedRadixComplexTables(int N);
+  int N;
+  std::vector<int> radix;     // radix of each stage, 4 is preferred over 2 * 2
+  std::vector<Real> twiddle;  // W_N^j for j = 0 .. N-1, as [re im]
+};
+
+template<typename Real>
+struct RealFftTables {
+  explicit RealFftTables(int N);
+  int N;
+  std::vector<Real> Wnk;      // W_N^j for j = 0 .. N/2-1, as [re im]
+};
+
+// Returns the shared tables for length N, building them on first use.
+// Thread safe; the tables stay alive for the whole process.
+template<typename Tables>
+std::shared_ptr<const Tables> GetFftTables(int N);
+
 template<typename Real>
 class Radix2ComplexFft {
  public:
   // N is the number of complex points (must be a power of two, or this
-  // will crash).  Note that the constructor does some work so it's best to
+  // will crash).  Note that the first Compute() of a length looks up (and
+  // for the first object in the process, builds) the tables, so it's best to
   // initialize the object once and do the computation many times.
-  Radix2ComplexFft() : N_(0), twiddle_(NULL), butter_(NULL), bitswap_(NULL) {}
-
-  // destructor
-  ~Radix2ComplexFft();
-  // Copy constructor
-  Radix2ComplexFft(const Radix2ComplexFft &other);
+  Radix2ComplexFft() : N_(0) {}
 
   // This version of Compute takes a single array of size N*2,
   // containing [ r0 im0 r1 im1 ... ].  Otherwise its behavior is  the
@@ -22,41 +53,68 @@ class Radix2ComplexFft {
   void Compute(Real *x, int N, bool forward);
 
  private:
-  void ComputeTwiddle();
   void Init(int N);
-  void Release();
 
   int N_;          // fft len
-  Real *twiddle_;      // twiddler factor : same as equation expression Wnk
-  int *butter_;   // butterfly order
-  int *bitswap_;  // for final permutation
+  std::shared_ptr<const Radix2ComplexTables<Real> > tables_;
 
   // Disallow assignment.
   Radix2ComplexFft &operator=(const Radix2ComplexFft &other);
 };
 
+// Smallest length >= n that Radix2RealFft can transform, i.e. an even number
+// whose half factors into 2, 3 and 5.
+int RoundUpRealFftLength(int n);
+
+template<typename Real>
+class MixedRadixComplexFft {
+ public:
+  // N is the number of complex points, it must factor into 2, 3 and 5
+  // (Compute() aborts otherwise).
+  // The transform is an iterative Stockham autosort, so no final permutation
+  // is needed; the output is in natural order.
+  MixedRadixComplexFft() : N_(0) {}
+
+  // Same interface and scaling as Radix2ComplexFft::Compute.
+  void Compute(Real *x, int N, bool forward);
+
+  // true if N > 0 factors into 2, 3 and 5
+  static bool IsSupportedLength(int N);
+
+ private:
+  void Init(int N);
+
+  int N_;          // fft len
+  std::shared_ptr<const MixedRadixComplexTables<Real> > tables_;
+  std::vector<Real> work_;  // ping-pong buffer of N complex points
+
+  // Disallow assignment.
+  MixedRadixComplexFft &operator=(const MixedRadixComplexFft &other);
+};
+
 template<typename Real>
 class Radix2RealFft {
  public:
   // default constructor
-  Radix2RealFft() : N_(0), Wnk_(NULL), y_(NULL), r2cfft_(NULL) {}
-
-  // desctructor
-  ~Radix2RealFft();
-  // Copy constructor
-  Radix2RealFft(const Radix2RealFft &other);
+  Radix2RealFft() : N_(0) {}
 
   /// If forward == true, this function transforms from a sequence of N float
   /// points to its complex fourier
   /// transform; otherwise it goes in the reverse direction.  If you call it
   /// in the forward and then reverse direction and multiply by 1.0/N, you
   /// will get back the original data.
+  /// N must be even; if N/2 is not a power of two it must factor into 2, 3
+  /// and 5 and a mixed-radix complex fft is used (see RoundUpRealFftLength).
   /// The interpretation of the complex-FFT data is as follows: the array
   /// is a sequence of complex numbers C_n of length N/2 with (float, im)
   /// format,
   /// i.e. [real0, real_{N/2}, real1, im1, real2, im2, real3, im3, ...].
   void Compute(Real *x, int N, bool forward);
 
+  /// true if N is even and N/2 factors into 2, 3 and 5, Compute() aborts on
+  /// other lengths
+  static bool IsSupportedLength(int N);
+
   /// This is as the other Compute() function, but it is a const version that
   /// uses a user-supplied buffer.
   // void Compute(float *x, bool forward, std::vector<float> *temp_buffer)
@@ -65,14 +123,16 @@ class Radix2RealFft {
  private:
   // Disallow assignment.
   Radix2RealFft &operator=(const Radix2RealFft &other);
-  // initialize Wnk_ and r2cfft_
+  // look up the shared tables and allocate y_
   void Init(int N);
-  // Release all the allocated buffer
-  void Release();
+  // the N/2 point complex fft on the packed real input
+  void ComputeComplex(Real *x, int N, bool forward);
   int N_;
-  Real *Wnk_;
-  Real *y_;  // a temperal buffer to avoid endless new-delete
-  Radix2ComplexFft<Real> *r2cfft_;
+  bool use_radix2_;  // N/2 is a power of two
+  std::shared_ptr<const RealFftTables<Real> > tables_;
+  std::vector<Real> y_;  // a temperal buffer to avoid endless new-delete
+  Radix2ComplexFft<Real> r2cfft_;
+  MixedRadixComplexFft<Real> mrcfft_;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -2,10 +2,40 @@
 #include <algorithm>
 #include <complex>
 #include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <mutex>
 #include <string>
+#include <utility>
 #include "base/kaldi-common.h"
 
 namespace spicax {
+Wola::Wola(WolaOptions opts) {
+  if (!Init(opts)) {
+    std::cerr << "Wola: unsupported fft length " << opts.fft_len_ << "\n";
+    std::abort();
+  }
+}
+
+std::shared_ptr<const Eigen::VectorXf> Wola::GetWindow(const std::string &win_type, int frame_len) {
+  static std::mutex mutex;
+  static std::map<std::pair<std::string, int>, std::shared_ptr<const Eigen::VectorXf> > cache;
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<const Eigen::VectorXf> &win = cache[std::make_pair(win_type, frame_len)];
+  if (!win) {
+    std::shared_ptr<Eigen::VectorXf> new_win = std::make_shared<Eigen::VectorXf>();
+    new_win->setZero(frame_len);
+    if (win_type == "sqrt_hanning") {
+      for (int i = 0; i < frame_len; i++) {
+        (*new_win)(i) = std::sin(M_PI * i / frame_len);
+      }
+    }
+    win = new_win;
+  }
+  return win;
+}
+
 // Note pcm_in is interleaved
 const Eigen::MatrixXcf& Wola::Decompose(short* pcm_in, int samples_each_chan, bool interleaved) {
   if (pcm_in == nullptr) {
@@ -14,35 +44,32 @@ const Eigen::MatrixXcf& Wola::Decompose(short* pcm_in, int samples_each_chan, bo
   }
   // slice frames according to the overlap_rate
   int num_frames_available = (samples_each_chan - opts_.overlap_len_) / opts_.frame_shift_;
-  Eigen::MatrixXf wave_frames;
-  wave_frames.setZero(opts_.num_chan_ * opts_.frame_len_, num_frames_available);
-  for (int i = 0; i < num_frames_available; i++) {
+  // each channel as a contiguous stream, pre-emphasis runs once per sample here
+  Eigen::MatrixXf chan_wave(samples_each_chan, opts_.num_chan_);
+  for (int j = 0; j < opts_.num_chan_; j++) {
     if (interleaved) {
-      int offset = i * opts_.frame_shift_ * opts_.num_chan_;
-      // channels  sample by sample
-      for (int j = 0; j < opts_.num_chan_; j++) {
-        for (int k = 0; k < opts_.frame_len_; k++) {
-          wave_frames(j * opts_.frame_len_ + k, i) = (float)pcm_in[offset + k * opts_.num_chan_ + j];
-        }
+      for (int k = 0; k < samples_each_chan; k++) {
+        chan_wave(k, j) = (float)pcm_in[k * opts_.num_chan_ + j];
       }
     } else {
-      // channels block by block
-      for (int j = 0; j < opts_.num_chan_; j++) {
-        for (int k = 0; k < opts_.frame_len_; k++) {
-          wave_frames(j * opts_.frame_len_ + k, i) =
-            (float)pcm_in[j * samples_each_chan + i * opts_.frame_shift_ + k];
-        }
+      for (int k = 0; k < samples_each_chan; k++) {
+        chan_wave(k, j) = (float)pcm_in[j * samples_each_chan + k];
       }
     }
+    if (!pre_emph_.empty()) {
+      pre_emph_[j].Compute(chan_wave.col(j).data(), samples_each_chan);
+    }
   }
 
   // transform to frequency domain
+  const Eigen::VectorXf& win = *win_;
   in_spec_.setZero(opts_.num_bins_ * opts_.num_chan_, num_frames_available);
   float* pf = reinterpret_cast<float*>(in_spec_.data());
   for (int i = 0; i < num_frames_available; i++) {
     for (int j = 0; j < opts_.num_chan_; j++) {
+      const float* frame = chan_wave.col(j).data() + i * opts_.frame_shift_;
       for (int k = 0; k < opts_.frame_len_; k++) {
-        pf[k] = wave_frames(j * opts_.frame_len_ + k, i) * win_(k);
+        pf[k] = frame[k] * win(k);
       }
       normal_rfft_.Compute(pf, opts_.fft_len_, true);
       pf += (opts_.num_bins_ * 2);
@@ -68,18 +95,30 @@ int Wola::Reconstruct(short* pcm_out) {
     return 0;
   }
   out_time_.setZero(opts_.out_chan_, opts_.frame_len_);
+  if (opts_.emph_alpha_ > 0.0f && de_emph_.size() != (size_t)opts_.out_chan_) {
+    de_emph_.resize(opts_.out_chan_, DeEmphasis(opts_.emph_alpha_));
+  }
+  emph_buf_.resize(opts_.frame_shift_);
 
   // transform each column of out_spec back to time domain
+  const Eigen::VectorXf& win = *win_;
   float* pf = reinterpret_cast<float*>(out_spec_.data());
   for (int i = 0; i < num_frames_available; i++) {
     for (int ichan = 0; ichan < opts_.out_chan_; ichan++) {
       normal_rfft_.Compute(pf, opts_.fft_len_, false);
       for (int j = 0; j < opts_.frame_len_; j++) {
-        out_time_(ichan, j) += pf[j] * win_[j];
+        out_time_(ichan, j) += pf[j] * win[j];
       }
       pf += (opts_.num_bins_ * 2);
     }
 
+    // de-emphasis on the finished head part, one channel row at a time
+    for (int ichan = 0; ichan < (int)de_emph_.size(); ichan++) {
+      emph_buf_ = out_time_.row(ichan).head(opts_.frame_shift_).transpose();
+      de_emph_[ichan].Filter(emph_buf_.data(), emph_buf_.data(), opts_.frame_shift_);
+      out_time_.row(ichan).head(opts_.frame_shift_) = emph_buf_.transpose();
+    }
+
     // the head part of out_time_ is the output
     short* p_out = pcm_out + i * opts_.out_chan_ * opts_.frame_shift_;
     float* p_overlap = out_time_.data();
@@ -3,7 +3,9 @@
 
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <memory>
 #include <string>
+#include <vector>
 #include "spicax-eigen.h"
 #include "emphasis.h"
 #include "r2fft.h"
@@ -16,11 +18,12 @@ struct WolaOptions {
   int fs_;
   int frame_shift_;
   int frame_len_;
-  int fft_len_;
+  int fft_len_;  // >= frame_len_, see RoundUpRealFftLength for valid values
   int num_bins_;
   int overlap_len_;
   int padding_zero_len_;
   float wola_cons_;
+  float emph_alpha_;  // pre-emphasis before analysis and de-emphasis after synthesis, 0 disables
   std::string win_type_;
 
   WolaOptions(int num_chan = 1, int out_chan = 1, int fs = 16000, float frame_shift_ms = 0.016,
@@ -35,6 +38,7 @@ struct WolaOptions {
       overlap_len_(frame_len_ - frame_shift_),
       padding_zero_len_(fft_len_ - frame_len_),
       wola_cons_(1.0f),
+      emph_alpha_(0.0f),
       win_type_("sqrt_hanning") {
     // 75% overlap rate
     if (frame_len_ == 4 * frame_shift_) {wola_cons_ = 1.0f / 2.38f;}
@@ -60,16 +64,20 @@ struct WolaOptions {
 class Wola {
  public:
   Wola() = default;
-  explicit Wola(WolaOptions opts) {Init(opts);};
+  // aborts with a message if opts.fft_len_ is not supported, Init reports it instead
+  explicit Wola(WolaOptions opts);
+  // false if opts.fft_len_ is not supported, the object is then left unchanged
   bool Init(WolaOptions opts) {
+    if (!Radix2RealFft<float>::IsSupportedLength(opts.fft_len_)) return false;
     opts_ = opts;
-    win_.setZero(opts_.frame_len_);
-    if (opts_.win_type_ == "sqrt_hanning") {
-      for (int i = 0; i < opts_.frame_len_; i++) {
-        win_(i) = std::sin(M_PI * i / opts_.frame_len_);
-      }
-    }
+    win_ = GetWindow(opts_.win_type_, opts_.frame_len_);
     out_time_.setZero(opts_.out_chan_, opts_.frame_len_);
+    pre_emph_.clear();
+    de_emph_.clear();
+    if (opts_.emph_alpha_ > 0.0f) {
+      pre_emph_.resize(opts_.num_chan_, PreEmphasis(opts_.emph_alpha_));
+      de_emph_.resize(opts_.out_chan_, DeEmphasis(opts_.emph_alpha_));
+    }
     return true;
   };
   // decompose a multichannel block, pcm_in is interleaved. samples is the length of each channel
@@ -80,6 +88,11 @@ class Wola {
   // Eigen::MatrixXcf& GetInSpec() { return in_spec_; };
   Eigen::MatrixXcf& GetOutSpec() { return out_spec_; };
 
+  // Process-wide cache of analysis/synthesis windows keyed by (win_type, frame_len).
+  // Thread safe; the returned window is never modified. The fft tables are
+  // shared the same way by length, see GetFftTables.
+  static std::shared_ptr<const Eigen::VectorXf> GetWindow(const std::string &win_type, int frame_len);
+
  private:
   WolaOptions opts_;
   Eigen::MatrixXcf in_spec_;   // (num_chan_ * num_bins_) * num_frames
@@ -87,11 +100,13 @@ class Wola {
   Eigen::MatrixXcf out_spec_;  // (num_bins ) * num_frames
   Eigen::MatrixXf out_time_;
 
-  Eigen::VectorXf win_;
+  std::shared_ptr<const Eigen::VectorXf> win_;
   Radix2RealFft<float> normal_rfft_;
 
-  PreEmphasis pre_emph_;
-  DeEmphasis de_emph_;
+  // one filter per channel, the state is carried across Decompose/Reconstruct calls
+  std::vector<PreEmphasis> pre_emph_;
+  std::vector<DeEmphasis> de_emph_;
+  Eigen::VectorXf emph_buf_;
 };
 }  // namespace spicax
 #endif
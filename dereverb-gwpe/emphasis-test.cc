@@ -0,0 +1,107 @@
+#include "base/kaldi-common.h"
+#include "dereverb/emphasis.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace spicax {
+// the scalar int16 filters before vectorization, the reference outputs
+static void OldPreEmphasis(short *in, int len, float alpha, short *last) {
+  short tmp = in[len - 1];
+  for (int i = len - 1; i > 0; i--) {
+    in[i] -= (short)(std::floor((in[i - 1]) * alpha));
+  }
+  in[0] -= (short)(std::floor((*last * alpha)));
+  *last = tmp;
+}
+
+static void OldDeEmphasis(short *in, int len, float alpha) {
+  int tmp = (int)in[0];
+  in[0] = (short)(std::max(std::min(tmp, 32767), -32768));
+  for (int i = 1; i < len; i++) {
+    tmp = (int)in[i] + (std::floor((tmp * alpha)));
+    in[i] = (short)(std::max(std::min(tmp, 32767), -32768));
+  }
+}
+
+// voiced speech like test signal: harmonics of a drifting pitch under a
+// slow envelope plus some noise, well inside 16 bits after de-emphasis
+static std::vector<short> MakeSignal(int len) {
+  std::vector<short> x(len);
+  unsigned int seed = 12345;
+  double phase = 0.0;
+  for (int i = 0; i < len; i++) {
+    phase += 2.0 * M_PI * (120.0 + 30.0 * std::sin(2.0 * M_PI * i / 8000.0)) / 16000.0;
+    double env = 0.5 + 0.5 * std::sin(2.0 * M_PI * i / 3200.0);
+    double v = 0.0;
+    for (int h = 1; h <= 8; h++) v += std::sin(h * phase) / h;
+    seed = seed * 1103515245 + 12345;
+    v = 900.0 * env * v + (double)((seed >> 16) % 201) - 100.0;
+    x[i] = (short)v;
+  }
+  return x;
+}
+
+static const int kBlockSizes[] = { 1, 3, 4, 5, 7, 160, 16000 };
+
+void UnitTestPreEmphasisInt16() {
+  std::vector<short> x = MakeSignal(16000);
+  std::vector<short> ref(x);
+  short last = 0;
+  OldPreEmphasis(ref.data(), (int)ref.size(), 0.9f, &last);
+  for (int block : kBlockSizes) {
+    std::vector<short> y(x);
+    PreEmphasis pre(0.9f);
+    for (int i = 0; i < (int)y.size(); i += block) {
+      pre.Compute(y.data() + i, std::min(block, (int)y.size() - i));
+    }
+    KALDI_ASSERT(y == ref);
+  }
+}
+
+void UnitTestDeEmphasisInt16() {
+  std::vector<short> x = MakeSignal(16000);
+  std::vector<short> ref(x);
+  OldDeEmphasis(ref.data(), (int)ref.size(), 0.9f);
+  for (int block : kBlockSizes) {
+    std::vector<short> y(x);
+    DeEmphasis de(0.9f);
+    for (int i = 0; i < (int)y.size(); i += block) {
+      de.Compute(y.data() + i, std::min(block, (int)y.size() - i));
+    }
+    KALDI_ASSERT(y == ref);
+  }
+}
+
+// the float output must be identical for any split of the stream, and
+// close to the plain recursion
+void UnitTestDeEmphasisFloatBlocks() {
+  std::vector<short> x16 = MakeSignal(16000);
+  std::vector<float> x(x16.begin(), x16.end());
+  std::vector<float> whole(x.size());
+  DeEmphasis de_whole(0.9f);
+  de_whole.Filter(x.data(), whole.data(), (int)x.size());
+  double y = 0.0;
+  for (size_t i = 0; i < x.size(); i++) {
+    y = x[i] + 0.9f * y;
+    KALDI_ASSERT(std::fabs(whole[i] - y) < 0.05);
+  }
+  for (int block : kBlockSizes) {
+    std::vector<float> out(x.size());
+    DeEmphasis de(0.9f);
+    for (int i = 0; i < (int)x.size(); i += block) {
+      de.Filter(x.data() + i, out.data() + i, std::min(block, (int)x.size() - i));
+    }
+    KALDI_ASSERT(std::memcmp(out.data(), whole.data(), sizeof(float) * x.size()) == 0);
+  }
+}
+}  // namespace spicax
+
+int main() {
+  using namespace spicax;
+  UnitTestPreEmphasisInt16();
+  UnitTestDeEmphasisInt16();
+  UnitTestDeEmphasisFloatBlocks();
+  std::cout << "Tests succeeded.\n";
+  return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ vectorMacros.h
+
+ Copyright (C) 2011 Belledonne Communications, Grenoble, France
+ Author : Johan Pascal
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+#ifndef VECTORMACROS_H
+#define VECTORMACROS_H
+
+/*****************************************************************************/
+/* Vector counterparts of the fixedPointMacros.h operations, on 4 lanes of   */
+/* word32_t (vword32_t), 8 lanes of word16_t (vword16_t) or 2 lanes of       */
+/* word64_t accumulators (vword64_t).                                        */
+/* SSE2 is used on x86 (with SSE4.1 sign extension when available), NEON on  */
+/* ARM; VECTOR_KERNELS is not defined on other targets and the scalar code   */
+/* is used.                                                                  */
+/* The fixed point code adds with ADD32/MAC16_16, without saturation: a sum  */
+/* of products is the same modulo 2^32 in any order, so kernels built on     */
+/* these macros are bit exact with the scalar code.                          */
+/*****************************************************************************/
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+#define VECTOR_SSE2
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define VECTOR_NEON
+#endif
+
+#if defined(VECTOR_SSE2) || defined(VECTOR_NEON)
+#define VECTOR_KERNELS
+
+#ifdef VECTOR_SSE2
+typedef __m128i vword32_t;
+typedef __m128i vword16_t;
+typedef __m128i vword64_t;
+
+#define VLOAD32(p) _mm_loadu_si128((const __m128i *)(p))
+#define VSTORE32(p,a) _mm_storeu_si128((__m128i *)(p), a)
+#define VDUP32(x) _mm_set1_epi32(x)
+#define VADD32(a,b) _mm_add_epi32(a,b)
+#define VSUB32(a,b) _mm_sub_epi32(a,b)
+#define VXOR(a,b) _mm_xor_si128(a,b)
+#define VSHR32_X4(a,shift) _mm_sra_epi32(a,_mm_cvtsi32_si128(shift))
+/* ADD16 on word16_t values held in word32_t lanes: the sum wraps on 16 bits */
+#define VADD16(a,b) _mm_srai_epi32(_mm_slli_epi32(_mm_add_epi32(a,b),16),16)
+/* lanes holding word16_t values: pmaddwd with the high half of b cleared */
+#define VMULT16_16(a,b) _mm_madd_epi16(a,_mm_and_si128(b,_mm_set1_epi32(0xffff)))
+/* 4 word16_t loaded into word32_t lanes */
+#ifdef __SSE4_1__
+#define VLOAD16_32(p) _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)(p)))
+#else
+#define VLOAD16_32(p) _mm_srai_epi32(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(p)),_mm_loadl_epi64((const __m128i *)(p))),16)
+#endif
+
+#define VLOAD16(p) _mm_loadu_si128((const __m128i *)(p))
+/* 8 products of word16_t lanes added into the 4 lanes of c */
+#define VMAC16_16_X8(c,a,b) _mm_add_epi32(c,_mm_madd_epi16(a,b))
+/* the word16_t lanes of even index, the odd ones cleared */
+#define VEVEN16(a) _mm_and_si128(a,_mm_set1_epi32(0xffff))
+
+#define VDUP64(x) _mm_set1_epi64x(x)
+/* 8 products of word16_t lanes added into the 2 lanes of the 64 bits accumulator c: */
+/* the products are summed by pairs on 32 bits, which must not overflow */
+static BCG729_INLINE vword64_t VMAC16_16_X8_64(vword64_t c, vword16_t a, vword16_t b)
+{
+	vword32_t pairs = _mm_madd_epi16(a,b);
+	vword32_t signs = _mm_srai_epi32(pairs,31);
+	c = _mm_add_epi64(c,_mm_unpacklo_epi32(pairs,signs));
+	return _mm_add_epi64(c,_mm_unpackhi_epi32(pairs,signs));
+}
+/* 8 squares of word16_t lanes added into the 2 lanes of c: the pair sums are at most 2^31, read as unsigned */
+static BCG729_INLINE vword64_t VMACSQUARE16_X8_64(vword64_t c, vword16_t a)
+{
+	vword32_t pairs = _mm_madd_epi16(a,a);
+	c = _mm_add_epi64(c,_mm_unpacklo_epi32(pairs,_mm_setzero_si128()));
+	return _mm_add_epi64(c,_mm_unpackhi_epi32(pairs,_mm_setzero_si128()));
+}
+#define VSTORE64(p,a) _mm_storeu_si128((__m128i *)(p), a)
+#else /* VECTOR_NEON */
+typedef int32x4_t vword32_t;
+typedef int16x8_t vword16_t;
+typedef int64x2_t vword64_t;
+
+#define VLOAD32(p) vld1q_s32((const int32_t *)(p))
+#define VSTORE32(p,a) vst1q_s32((int32_t *)(p), a)
+#define VDUP32(x) vdupq_n_s32(x)
+#define VADD32(a,b) vaddq_s32(a,b)
+#define VSUB32(a,b) vsubq_s32(a,b)
+#define VXOR(a,b) veorq_s32(a,b)
+#define VSHR32_X4(a,shift) vshlq_s32(a,vdupq_n_s32(-(shift)))
+#define VADD16(a,b) vshrq_n_s32(vshlq_n_s32(vaddq_s32(a,b),16),16)
+#define VMULT16_16(a,b) vmulq_s32(a,b)
+#define VLOAD16_32(p) vmovl_s16(vld1_s16((const int16_t *)(p)))
+
+#define VLOAD16(p) vld1q_s16((const int16_t *)(p))
+#define VMAC16_16_X8(c,a,b) vmlal_s16(vmlal_s16(c,vget_low_s16(a),vget_low_s16(b)),vget_high_s16(a),vget_high_s16(b))
+#define VEVEN16(a) vreinterpretq_s16_s32(vandq_s32(vreinterpretq_s32_s16(a),vdupq_n_s32(0xffff)))
+
+#define VDUP64(x) vdupq_n_s64(x)
+/* the products are added by pairs on 64 bits, no overflow */
+#define VMAC16_16_X8_64(c,a,b) vpadalq_s32(vpadalq_s32(c,vmull_s16(vget_low_s16(a),vget_low_s16(b))),vmull_s16(vget_high_s16(a),vget_high_s16(b)))
+#define VMACSQUARE16_X8_64(c,a) VMAC16_16_X8_64(c,a,a)
+#define VSTORE64(p,a) vst1q_s64((int64_t *)(p), a)
+#endif
+
+#define VMAC16_16(c,a,b) VADD32(c,VMULT16_16(a,b))
+/* a if the lanes of mask are 0, -a if they are -1 */
+#define VNEGATE_IF(a,mask) VSUB32(VXOR(a,mask),mask)
+
+/* sum of the 4 lanes */
+static BCG729_INLINE word32_t VSUM32(vword32_t a)
+{
+	word32_t lanes[4];
+	VSTORE32(lanes, a);
+	return ADD32(ADD32(lanes[0], lanes[1]), ADD32(lanes[2], lanes[3]));
+}
+
+/* sum of the 2 lanes of a 64 bits accumulator */
+static BCG729_INLINE word64_t VSUM64(vword64_t a)
+{
+	word64_t lanes[2];
+	VSTORE64(lanes, a);
+	return lanes[0] + lanes[1];
+}
+#endif /* if defined(VECTOR_SSE2) || defined(VECTOR_NEON) */
+
+#endif /* ifndef VECTORMACROS_H */
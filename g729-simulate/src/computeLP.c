@@ -23,6 +23,7 @@
 #include "basicOperationsMacros.h"
 #include "codebooks.h"
 #include "utils.h"
+#include "vectorMacros.h"
 
 #include "computeLP.h"
 
@@ -37,7 +38,12 @@
 void computeLP(word16_t signal[], word16_t LPCoefficientsQ12[])
 {
 	int i,j;
+#ifdef VECTOR_KERNELS
+	word16_t windowedSignal[L_LP_ANALYSIS_WINDOW+16]; /* followed by zeros so each autocorrelation coefficient is a sum on the whole window */
+	vword64_t acc64Vector = VDUP64(0);
+#else
 	word16_t windowedSignal[L_LP_ANALYSIS_WINDOW];
+#endif
 	word32_t autoCorrelationCoefficient[NB_LSP_COEFF+1];
 	word64_t acc64=0; /* acc on 64 bits */ 
 	int rightShiftToNormalise=0;
@@ -52,6 +58,11 @@ void computeLP(word16_t signal[], word16_t LPCoefficientsQ12[])
 	for (i=0; i<L_LP_ANALYSIS_WINDOW; i++) {
 		windowedSignal[i] = MULT16_16_P15(signal[i], wlp[i]); /* signal in Q0, wlp in Q0.15, windowedSignal in Q0 */
 	}
+#ifdef VECTOR_KERNELS
+	for (i=L_LP_ANALYSIS_WINDOW; i<L_LP_ANALYSIS_WINDOW+16; i++) {
+		windowedSignal[i] = 0;
+	}
+#endif
 
 	/*********************************************************************************/
 	/* Compute the autoCorrelation coefficients r[0..10] according to spec 3.2.1 eq5 */
@@ -59,9 +70,16 @@ void computeLP(word16_t signal[], word16_t LPCoefficientsQ12[])
 	/* Compute autoCorrelationCoefficient[0] first as it is the highest number and normalise it on 32 bits then apply the same normalisation to the other coefficients */
 	/* autoCorrelationCoefficient are normalised on 32 bits and then considered as Q31 in range [-1,1[ */
 	/* autoCorrelationCoefficient[0] is computed on 64 bits as it is likely to overflow 32 bits */
+#ifdef VECTOR_KERNELS
+	for (i=0; i<L_LP_ANALYSIS_WINDOW; i+=8) {
+		acc64Vector = VMACSQUARE16_X8_64(acc64Vector, VLOAD16(&windowedSignal[i]));
+	}
+	acc64 = VSUM64(acc64Vector);
+#else
 	for (i=0; i<L_LP_ANALYSIS_WINDOW; i++) {
 		acc64 = MAC64(acc64, windowedSignal[i], windowedSignal[i]);
 	}
+#endif
 	if (acc64==0) {
 		acc64 = 1; /* spec 3.2.1: To avoid arithmetic problems for low-level input signals the value of r(0) has a lower boundary of r(0) = 1.0 */
 	}
@@ -81,20 +99,40 @@ void computeLP(word16_t signal[], word16_t LPCoefficientsQ12[])
 	if (rightShiftToNormalise>0) { /* acc64 was not fitting on 32 bits so compute the other sum on 64 bits too */
 		for (i=1; i<NB_LSP_COEFF+1; i++) {
 			/* compute the sum in the 64 bits acc*/
+#ifdef VECTOR_KERNELS
+			/* |windowedSignal| <= 32768: wlp[199] = wlp[200] = 32767 and MULT16_16_P15(-32768, 32767) is -32768. A pair sum of products
+			   saturates only when all four inputs are -32768, and -32768 can only appear at the odd/even indices 199 and 200 which
+			   never form one pair, so the pair sums fit on 32 bits */
+			acc64Vector = VDUP64(0);
+			for (j=0; j<L_LP_ANALYSIS_WINDOW; j+=8) {
+				acc64Vector = VMAC16_16_X8_64(acc64Vector, VLOAD16(&windowedSignal[j]), VLOAD16(&windowedSignal[j+i]));
+			}
+			acc64 = VSUM64(acc64Vector);
+#else
 			acc64=0;
 			for (j=i; j<L_LP_ANALYSIS_WINDOW; j++) {
 				acc64 = ADD64_32(acc64, MULT16_16(windowedSignal[j], windowedSignal[j-i]));
 			}
+#endif
 			/* normalise it */
 			autoCorrelationCoefficient[i] = SHR(acc64 ,rightShiftToNormalise);
 		}
 	} else { /* acc64 was fitting on 32 bits, compute the other sum on 32 bits only as it is faster */
 		for (i=1; i<NB_LSP_COEFF+1; i++) {
 			/* compute the sum in the 64 bits acc*/
+#ifdef VECTOR_KERNELS
+			vword32_t acc32Vector = VDUP32(0);
+			word32_t acc32;
+			for (j=0; j<L_LP_ANALYSIS_WINDOW; j+=8) {
+				acc32Vector = VMAC16_16_X8(acc32Vector, VLOAD16(&windowedSignal[j]), VLOAD16(&windowedSignal[j+i]));
+			}
+			acc32 = VSUM32(acc32Vector);
+#else
 			word32_t acc32=0;
 			for (j=i; j<L_LP_ANALYSIS_WINDOW; j++) {
 				acc32 = MAC16_16(acc32, windowedSignal[j], windowedSignal[j-i]);
 			}
+#endif
 			/* normalise it */
 			autoCorrelationCoefficient[i] = SHL(acc32, -rightShiftToNormalise);
 		}
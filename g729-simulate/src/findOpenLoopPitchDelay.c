@@ -26,6 +26,7 @@
 #include "basicOperationsMacros.h"
 #include "utils.h"
 #include "g729FixedPointMath.h"
+#include "vectorMacros.h"
 
 /* local functions prototypes */
 /* compute eqA.4 from spec A3.4 on the given range and step(1 compute all the correlation in range, 2 only the even ones) return the maximum and set the index giving it in the first parameter */
@@ -61,11 +62,24 @@ uint16_t findOpenLoopPitchDelay(word16_t weightedInputSignal[])
 	word32_t normalisedCorrelationMaxRange2;
 	word32_t normalisedCorrelationMaxRange3;
 	uint16_t indexMultiple;
+#ifdef VECTOR_KERNELS
+	vword64_t autocorrelationAcc = VDUP64(0);
+#endif
 
 	/* compute on 64 bits the autocorrelation on the input signal and if needed scale to have it on 32 bits */
+#ifdef VECTOR_KERNELS
+	for (i=-MAXIMUM_INT_PITCH_DELAY; i+8<=L_FRAME; i+=8) {
+		autocorrelationAcc = VMACSQUARE16_X8_64(autocorrelationAcc, VLOAD16(&weightedInputSignal[i]));
+	}
+	autocorrelation = VSUM64(autocorrelationAcc);
+	for (; i<L_FRAME; i++) {
+		autocorrelation = MAC64(autocorrelation, weightedInputSignal[i], weightedInputSignal[i]);
+	}
+#else
 	for (i=-MAXIMUM_INT_PITCH_DELAY; i<L_FRAME; i++) {
 		autocorrelation = MAC64(autocorrelation, weightedInputSignal[i], weightedInputSignal[i]);
 	}
+#endif
 	if (autocorrelation>MAXINT32) {
 		int overflowScale;
 		scaledWeightedInputSignal = &(scaledWeightedInputSignalBuffer[MAXIMUM_INT_PITCH_DELAY]);
@@ -167,6 +181,16 @@ word32_t getCorrelation(word16_t inputSignal[], uint16_t index)
 {
 	int i,j=-index; /* i will be the [2*i] index and j the [2*i-index] in eqA.4 */
 	
+#ifdef VECTOR_KERNELS
+	/* the odd samples of inputSignal[i] are cleared so only the products of eqA.4 are summed */
+	vword32_t acc = VDUP32(0);
+
+	for (i=0; i<L_FRAME; i+=8,j+=8) {
+		acc = VMAC16_16_X8(acc, VEVEN16(VLOAD16(&inputSignal[i])), VLOAD16(&inputSignal[j]));
+	}
+
+	return VSUM32(acc);
+#else
 	word32_t correlation = 0;
 	
 	for (i=0; i<L_FRAME; i+=2,j+=2) {
@@ -174,6 +198,7 @@ word32_t getCorrelation(word16_t inputSignal[], uint16_t index)
 	}
 
 	return correlation;
+#endif
 }
 
 /*****************************************************************************/
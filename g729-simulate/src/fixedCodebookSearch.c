@@ -23,6 +23,7 @@
 #include "codecParameters.h"
 #include "basicOperationsMacros.h"
 #include "utils.h"
+#include "vectorMacros.h"
 #include <stdlib.h>
 
 #include "fixedCodebookSearch.h"
@@ -30,6 +31,10 @@
 /*** local functions ***/
 void computeImpulseResponseCorrelationMatrix(word16_t impulseResponse[], word16_t correlationSignal[], int correlationSignalSign[], word32_t Phi[L_SUBFRAME][L_SUBFRAME]);
 void computePhiDiagonal(int j, word16_t impulseResponse[], word32_t Phi[L_SUBFRAME][L_SUBFRAME], uint16_t PhiScaling);
+#ifdef VECTOR_KERNELS
+void computePhiDiagonals(int j, word16_t impulseResponse[], word32_t reversedImpulseResponse[], word32_t Phi[L_SUBFRAME][L_SUBFRAME], uint16_t PhiScaling);
+void computeTrackCandidates(word32_t energyBase, word16_t correlationBase, word32_t PhiRow[], int firstIndex, word32_t trackEnergy[], word32_t trackCorrelation[], word32_t energy[], word32_t correlationSquare[]);
+#endif
 
 /*****************************************************************************/
 /* fixedCodebookSearch: compute fixed codebook parameters (codeword and sign)*/
@@ -71,6 +76,11 @@ void fixedCodebookSearch(word16_t targetSignal[], word16_t impulseResponse[], in
 	int mSwitch[2][4] = {{2,3,0,1},{3,0,1,2}};
 	int mIndex;
 	int jx = 0;
+#ifdef VECTOR_KERNELS
+	word16_t paddedTargetSignal[2*L_SUBFRAME];
+	word32_t trackEnergy[8], trackCorrelation[8]; /* terms of the energy and correlation depending only on the position in the searched track */
+	word32_t candidateEnergy[8], candidateCorrelationSquare[8];
+#endif
 
 	/* compute the target signal for fixed codebook spec 3.8.1 eq50 : fixedCodebookTargetSignal[i] = targetSignal[i] - (adaptativeCodebookGain * filteredAdaptativeCodebookVector[i]) */
 	for (i=0; i<L_SUBFRAME; i++) {
@@ -84,11 +94,26 @@ void fixedCodebookSearch(word16_t targetSignal[], word16_t impulseResponse[], in
 
 	/* compute the correlation signal as in spec 3.8.1 eq52 */
 	/* compute on 32 bits and get the maximum */
+#ifdef VECTOR_KERNELS
+	/* the target signal is followed by zeros so every correlation is a 40 terms sum */
+	for (i=0; i<L_SUBFRAME; i++) {
+		paddedTargetSignal[i] = fixedCodebookTargetSignal[i];
+		paddedTargetSignal[L_SUBFRAME+i] = 0;
+	}
+#endif
 	for (n=0; n<L_SUBFRAME; n++) {
+#ifdef VECTOR_KERNELS
+		vword32_t acc = VDUP32(0);
+		for (i=0; i<L_SUBFRAME; i+=8) {
+			acc = VMAC16_16_X8(acc, VLOAD16(&paddedTargetSignal[n+i]), VLOAD16(&impulseResponse[i]));
+		}
+		correlationSignal32[n] = VSUM32(acc);
+#else
 		correlationSignal32[n] = 0;
 		for (i=n; i<L_SUBFRAME; i++) {
 			correlationSignal32[n] = MAC16_16(correlationSignal32[n], fixedCodebookTargetSignal[i], impulseResponse[i-n]);
 		}
+#endif
 		abscCrrelationSignal32 = correlationSignal32[n]>=0?correlationSignal32[n]:-correlationSignal32[n];
 		if (abscCrrelationSignal32>correlationSignalMax) {
 			correlationSignalMax = abscCrrelationSignal32;
@@ -143,10 +168,23 @@ void fixedCodebookSearch(word16_t targetSignal[], word16_t impulseResponse[], in
 				energyM2 = Phi[currentM2][currentM2]; /* compute the energy with terms of eq55 using m2 only: Phi'(m2,m2) */		
 			
 				/* with selected m2, test the 8 m3 possibilities for the current m3 track */
-				for (j=mSwitch[mIndex][1]; j<L_SUBFRAME; j+=5) {
+#ifdef VECTOR_KERNELS
+				for (j=mSwitch[mIndex][1], n=0; j<L_SUBFRAME; j+=5, n++) {
+					trackEnergy[n] = Phi[j][j];
+					trackCorrelation[n] = correlationSignal[j];
+				}
+				computeTrackCandidates(energyM2, correlationM2, Phi[currentM2], mSwitch[mIndex][1], trackEnergy, trackCorrelation, candidateEnergy, candidateCorrelationSquare);
+#endif
+				for (j=mSwitch[mIndex][1], n=0; j<L_SUBFRAME; j+=5, n++) {
+#ifdef VECTOR_KERNELS
+					word16_t correlationM2M3 = ADD16(correlationM2, correlationSignal[j]);
+					word32_t energyM2M3 = candidateEnergy[n];
+					word32_t correlationM2M3Square = candidateCorrelationSquare[n];
+#else
 					word16_t correlationM2M3 = ADD16(correlationM2, correlationSignal[j]); /* compute the correlation sum due to m2 and m3 pulses */
 					word32_t energyM2M3 =  ADD32(energyM2, ADD32(Phi[currentM2][j], Phi[j][j])); /* compute the energy if eq55 using term including m2 and m3: Phi'(m2,m2) is already in energyM2 + Phi'(m2,m3) + Phi'(m3,m3) */
 					word32_t correlationM2M3Square = MULT16_16(correlationM2M3, correlationM2M3);
+#endif
 					/* check if the current correlation/energy couple gives better results than the stored one : maximise C^2/E -> C^2/E > C^2max/Emax => Emax*C^2 > C^2max*E */
 					if (MULT32_32(m3TrackEnergy,correlationM2M3Square) > MULT32_32(energyM2M3, m3TrackCorrelationSquare)) {
 						m3TrackCorrelationSquare = correlationM2M3Square;
@@ -163,13 +201,28 @@ void fixedCodebookSearch(word16_t targetSignal[], word16_t impulseResponse[], in
 			m3TrackCorrelationSquare = -1;
 			m3TrackEnergy = 1;
 
+#ifdef VECTOR_KERNELS
+			for (j=mSwitch[mIndex][3], n=0; j<L_SUBFRAME; j+=5, n++) { /* the m1 terms not depending on m0: Phi'(m1,m1) + Phi'(m1,m2) + Phi'(m1,m3) */
+				trackEnergy[n] = ADD32(Phi[j][j], ADD32(Phi[j][m2], Phi[j][m3]));
+				trackCorrelation[n] = correlationSignal[j];
+			}
+#endif
 			for (i=mSwitch[mIndex][2]; i<L_SUBFRAME; i+=5) { /* test the 8 possibilities for m0 track */
 				word16_t correlationM2M3M0 = ADD16(correlationM2M3Max, correlationSignal[i]); /* compute correlation with current m0 taking in account the previously selected m2 and m3 */
 				word32_t energyM2M3M0 = ADD32(energyM2M3Max, ADD32(Phi[i][i], ADD32(Phi[i][m2], Phi[i][m3]))); /* add to the previously computed energy the terms of eq59 we can compute with the selected m0: Phi'(m0,m0) + Phi'(m0,m2) + Phi'(m0,m3) */ 
-				for (j=mSwitch[mIndex][3]; j<L_SUBFRAME; j+=5) { /* test the 8 possibilities for m1 track */
+#ifdef VECTOR_KERNELS
+				/* Phi'(m1,m0) is read in the row of m0, the matrix is symmetric */
+				computeTrackCandidates(energyM2M3M0, correlationM2M3M0, Phi[i], mSwitch[mIndex][3], trackEnergy, trackCorrelation, candidateEnergy, candidateCorrelationSquare);
+#endif
+				for (j=mSwitch[mIndex][3], n=0; j<L_SUBFRAME; j+=5, n++) { /* test the 8 possibilities for m1 track */
+#ifdef VECTOR_KERNELS
+					word32_t energyM2M3M0M1 = candidateEnergy[n];
+					word32_t correlationM2M3M0M1Square = candidateCorrelationSquare[n];
+#else
 					word16_t correlationM2M3M0M1 = ADD16(correlationM2M3M0, correlationSignal[j]); /* compute correlation with current m1 taking in account the previously selected m2, m3 and m0 */
 					word32_t energyM2M3M0M1 = ADD32(energyM2M3M0, ADD32(Phi[j][i], ADD32(Phi[j][j], ADD32(Phi[j][m2], Phi[j][m3])))); /* add to the previously computed energy the terms of eq59 we can compute with the selected m1: Phi'(m1,m0) + Phi'(m1,m1) + Phi'(m1,m2) + Phi'(m1,m3) */ 
 					word32_t correlationM2M3M0M1Square = MULT16_16(correlationM2M3M0M1, correlationM2M3M0M1);
+#endif
 					/* check if the current correlation/energy couple gives better results than the stored one : maximise C^2/E -> C^2/E > C^2max/Emax => Emax*C^2 > C^2max*E */
 					if (MULT32_32(m3TrackEnergy,correlationM2M3M0M1Square) > MULT32_32(energyM2M3M0M1, m3TrackCorrelationSquare)) {
 						m3TrackCorrelationSquare = correlationM2M3M0M1Square;
@@ -313,7 +366,12 @@ void computeImpulseResponseCorrelationMatrix(word16_t impulseResponse[], word16_
 	int i,j,iComp;
 	word32_t acc = 0;
 	uint16_t PhiScaling = 0;
+#ifdef VECTOR_KERNELS
+	word32_t reversedImpulseResponse[L_SUBFRAME];
+	word32_t correlationSignalSignMask[L_SUBFRAME]; /* -1 for the negative correlationSignal elements, 0 otherwise */
+#else
 	int correlationSignalSignInv[L_SUBFRAME];
+#endif
 
 	/* first compute the diagonal Phi(x,x) : Phi(39,39) = h[0]^2 # Phi(38,38) = Phi(39,39)+h[1]^2 */
 	/* this diagonal must be divided by 2 according to spec 3.8.1 eq57 */
@@ -331,25 +389,52 @@ void computeImpulseResponseCorrelationMatrix(word16_t impulseResponse[], word16_
 	}
 	
 	/* Compute all diagonals but the 34, 29, 24, 19, 14, 9 and 4*/
+#ifdef VECTOR_KERNELS
+	for (i=0; i<L_SUBFRAME; i++) {
+		reversedImpulseResponse[i] = impulseResponse[L_SUBFRAME-1-i];
+	}
+	for (i=0; i<8; i++) {
+		computePhiDiagonals(5*i, impulseResponse, reversedImpulseResponse, Phi, PhiScaling);
+	}
+#else
 	for (i=0; i<8; i++) {
 		for (j=0; j<4; j++) {
 			computePhiDiagonal(5*i+j, impulseResponse, Phi, PhiScaling);
 		}
 	}
+#endif
 
 	/* correlationSignal -> absolute value and get sign (and his inverse in an array) */
 	for (i=0; i<L_SUBFRAME; i++) {
 		if (correlationSignal[i] >= 0) {
 			correlationSignalSign[i] = 1;
+#ifdef VECTOR_KERNELS
+			correlationSignalSignMask[i] = 0;
+#else
 			correlationSignalSignInv[i] = -1;
+#endif
 		} else { /* correlationSignal < 0 */
 			correlationSignalSign[i] = -1;
+#ifdef VECTOR_KERNELS
+			correlationSignalSignMask[i] = -1;
+#else
 			correlationSignalSignInv[i] = 1;
+#endif
 			correlationSignal[i] = -correlationSignal[i];
 		}
 	}
 
 	/* modify the signs according to eq56 */
+#ifdef VECTOR_KERNELS
+	/* multiply by the two signs: negate the elements where they differ */
+	/* the last vector of a row also covers up to 3 elements of the upper triangle, which is not used */
+	for (i=0; i<L_SUBFRAME; i++) {
+		vword32_t rowMask = VDUP32(correlationSignalSignMask[i]);
+		for (j=0; j<=i; j+=4) {
+			VSTORE32(&Phi[i][j], VNEGATE_IF(VLOAD32(&Phi[i][j]), VXOR(rowMask, VLOAD32(&correlationSignalSignMask[j]))));
+		}
+	}
+#else
 	for (i=0; i<L_SUBFRAME; i++) {
 		int *signOfCorrelationSignalJ;
 		
@@ -363,6 +448,7 @@ void computeImpulseResponseCorrelationMatrix(word16_t impulseResponse[], word16_
 			Phi[i][j] =  Phi[i][j] * signOfCorrelationSignalJ[j];
 		}
 	}
+#endif
 	
 	/* duplicate the usefull values to their symetric part to get easier acces to the matrix elements */
 	for (i=0; i<8; i++) {
@@ -398,3 +484,48 @@ void computePhiDiagonal(int j, word16_t impulseResponse[], word32_t Phi[L_SUBFRA
 		}
 	}
 }
+
+#ifdef VECTOR_KERNELS
+/* compute the 4 diagonals j to j+3 of Phi values at once, the lane k holding the diagonal j+k: */
+/*      a step Phi(i+1,j+k+1) -> Phi(i,j+k) writes 4 adjacent elements of row i, h(39-j-k+m) is reversedImpulseResponse[j+k-m] */
+/*      the j+1 first steps are common to the 4 diagonals, the last 3 elements of the longer ones are computed one by one */
+void computePhiDiagonals(int j, word16_t impulseResponse[], word32_t reversedImpulseResponse[], word32_t Phi[L_SUBFRAME][L_SUBFRAME], uint16_t PhiScaling)
+{
+	vword32_t acc = VDUP32(0);
+	word32_t accs[4];
+	int k, m;
+
+	for (m=0; m<=j; m++) {
+		acc = VMAC16_16(acc, VDUP32(impulseResponse[m]), VLOAD32(&reversedImpulseResponse[j-m]));
+		VSTORE32(&Phi[L_SUBFRAME-1-m][j-m], VSHR32_X4(acc, PhiScaling));
+	}
+
+	VSTORE32(accs, acc);
+	for (k=1; k<4; k++) {
+		for (m=j+1; m<=j+k; m++) {
+			accs[k] = MAC16_16(accs[k], impulseResponse[m], impulseResponse[L_SUBFRAME-1-j-k+m]);
+			Phi[L_SUBFRAME-1-m][j+k-m] = SHR(accs[k], PhiScaling);
+		}
+	}
+}
+
+/* energy and correlation square of the 8 candidates positions m = firstIndex + 5*n of a track: */
+/*      energy[n] = energyBase + PhiRow[m] + trackEnergy[n]                                          */
+/*      correlationSquare[n] = (correlationBase + trackCorrelation[n])^2, the sum wrapping on 16 bits as ADD16 */
+void computeTrackCandidates(word32_t energyBase, word16_t correlationBase, word32_t PhiRow[], int firstIndex, word32_t trackEnergy[], word32_t trackCorrelation[], word32_t energy[], word32_t correlationSquare[])
+{
+	int n;
+	word32_t PhiTerms[8];
+	vword32_t correlation;
+
+	for (n=0; n<8; n++) {
+		PhiTerms[n] = PhiRow[firstIndex+5*n];
+	}
+
+	for (n=0; n<8; n+=4) {
+		VSTORE32(&energy[n], VADD32(VDUP32(energyBase), VADD32(VLOAD32(&PhiTerms[n]), VLOAD32(&trackEnergy[n]))));
+		correlation = VADD16(VDUP32(correlationBase), VLOAD32(&trackCorrelation[n]));
+		VSTORE32(&correlationSquare[n], VMULT16_16(correlation, correlation));
+	}
+}
+#endif
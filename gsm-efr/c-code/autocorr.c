@@ -11,6 +11,14 @@
  *         The autocorrelations are expressed in normalized double precision
  *         format.
  *
+ *       With SSE2 / NEON the windowing and the correlations run in the
+ *       vector lanes. All products of r[0] are positive, so its L_mac chain
+ *       saturates exactly when the plain sum exceeds MAX_32. Once r[0] does
+ *       not saturate, 2*|y[j]*y[j+k]| <= y[j]^2 + y[j+k]^2 bounds every
+ *       partial sum of r[k] by r[0], so r[1..m] never saturate and are the
+ *       plain sums. efr_Overflow on return is set by the final sub () as in
+ *       the scalar code.
+ *
  *************************************************************************/
 
 #include "typedef.h"
@@ -18,6 +26,95 @@
 #include "oper_32b.h"
 #include "count.h"
 #include "cnst.h"
+#include "vec_op.h"
+
+#ifdef VEC_KERNELS
+/* y[i] = mult_r (x[i], wind[i]), i = 0..L_WINDOW-1 */
+static void Window_vec (Word16 x[], Word16 wind[], Word16 y[]) {
+    Word16 i;
+#ifdef VEC_SSE2
+    __m128i a, b, lo, hi, p0, p1;
+    const __m128i rnd = _mm_set1_epi32 (0x00004000L);
+
+    for (i = 0; i < L_WINDOW; i += 8) {
+        a = _mm_loadu_si128 ((__m128i *) &x[i]);
+        b = _mm_loadu_si128 ((__m128i *) &wind[i]);
+        lo = _mm_mullo_epi16 (a, b);
+        hi = _mm_mulhi_epi16 (a, b);
+        p0 = _mm_srai_epi32 (_mm_add_epi32 (_mm_unpacklo_epi16 (lo, hi), rnd), 15);
+        p1 = _mm_srai_epi32 (_mm_add_epi32 (_mm_unpackhi_epi16 (lo, hi), rnd), 15);
+        /* packs saturates 0x8000 * 0x8000 like mult_r () */
+        _mm_storeu_si128 ((__m128i *) &y[i], _mm_packs_epi32 (p0, p1));
+    }
+#else
+    for (i = 0; i < L_WINDOW; i += 8) {
+        vst1q_s16 (&y[i], vqrdmulhq_s16 (vld1q_s16 (&x[i]), vld1q_s16 (&wind[i])));
+    }
+#endif
+}
+
+/* L_mac (..., y[i], y[i]) over i = 0..L_WINDOW-1, starting from 0 */
+static Word32 Energy_vec (Word16 y[]) {
+    Word16 i;
+    long long sum;
+#ifdef VEC_SSE2
+    __m128i v, p, acc = _mm_setzero_si128 ();
+    const __m128i zero = _mm_setzero_si128 ();
+    long long part[2];
+
+    for (i = 0; i < L_WINDOW; i += 8) {
+        v = _mm_loadu_si128 ((__m128i *) &y[i]);
+        p = _mm_madd_epi16 (v, v);      /* <= 2^31, taken as unsigned */
+        acc = _mm_add_epi64 (acc, _mm_unpacklo_epi32 (p, zero));
+        acc = _mm_add_epi64 (acc, _mm_unpackhi_epi32 (p, zero));
+    }
+    _mm_storeu_si128 ((__m128i *) part, acc);
+    sum = part[0] + part[1];
+#else
+    int16x8_t v;
+    int64x2_t acc = vdupq_n_s64 (0);
+
+    for (i = 0; i < L_WINDOW; i += 8) {
+        v = vld1q_s16 (&y[i]);
+        acc = vpadalq_s32 (acc, vmull_s16 (vget_low_s16 (v), vget_low_s16 (v)));
+        acc = vpadalq_s32 (acc, vmull_high_s16 (v, v));
+    }
+    sum = vaddvq_s64 (acc);
+#endif
+    if (sum > (long long) (MAX_32 >> 1)) {
+        efr_Overflow = 1;
+        return MAX_32;
+    }
+    return (Word32) sum * 2;
+}
+
+/* L_mac (..., y[j], y[j + k]) over j = 0..L_WINDOW-1-k, starting from 0,
+   y[] is followed by k zeros, the sum must not saturate */
+static Word32 Corr_vec (Word16 y[], Word16 k) {
+    Word16 j;
+#ifdef VEC_SSE2
+    __m128i acc = _mm_setzero_si128 ();
+
+    for (j = 0; j < L_WINDOW; j += 8) {
+        acc = _mm_add_epi32 (acc, _mm_madd_epi16 (_mm_loadu_si128 ((__m128i *) &y[j]),
+                                                  _mm_loadu_si128 ((__m128i *) &y[j + k])));
+    }
+    acc = _mm_add_epi32 (acc, _mm_shuffle_epi32 (acc, 0x4E));
+    acc = _mm_add_epi32 (acc, _mm_shuffle_epi32 (acc, 0xB1));
+    return _mm_cvtsi128_si32 (acc) * 2;
+#else
+    int16x8_t v;
+    int32x4_t acc = vdupq_n_s32 (0);
+
+    for (j = 0; j < L_WINDOW; j += 8) {
+        v = vld1q_s16 (&y[j + k]);
+        acc = vmlal_s16 (acc, vld1_s16 (&y[j]), vget_low_s16 (v));
+        acc = vmlal_high_s16 (acc, vld1q_s16 (&y[j]), v);
+    }
+    return vaddvq_s32 (acc) * 2;
+#endif
+}
+#endif
 
 Word16 Autocorr (
     Word16 x[],         /* (i)    : Input signal                    */
@@ -27,15 +124,22 @@ Word16 Autocorr (
     Word16 wind[]       /* (i)    : window for LPC analysis         */
 ) {
     Word16 i, j, norm;
-    Word16 y[L_WINDOW];
+    Word16 y[L_WINDOW + M];     /* M zeros after the signal for Corr_vec */
     Word32 sum;
     Word16 overfl, overfl_shft;
 
     /* Windowing of signal */
 
+#ifdef VEC_KERNELS
+    Window_vec (x, wind, y);
+    for (i = L_WINDOW; i < L_WINDOW + M; i++) {
+        y[i] = 0;
+    }
+#else
     for (i = 0; i < L_WINDOW; i++) {
         y[i] = efr_mult_r (x[i], wind[i]); move16 ();
     }
+#endif
 
     /* Compute r[0] and test for overflow */
 
@@ -43,11 +147,15 @@ Word16 Autocorr (
 
     do {
         overfl = 0;                    move16 ();
+#ifdef VEC_KERNELS
+        sum = Energy_vec (y);
+#else
         sum = 0L;                      move32 ();
 
         for (i = 0; i < L_WINDOW; i++) {
             sum = efr_L_mac (sum, y[i], y[i]);
         }
+#endif
 
         /* If overflow divide y[] by 4 */
 
@@ -74,10 +182,17 @@ Word16 Autocorr (
     /* r[1] to r[m] */
 
     for (i = 1; i <= m; i++) {
-        sum = 0;                       move32 ();
-
-        for (j = 0; j < L_WINDOW - i; j++) {
-            sum = efr_L_mac (sum, y[j], y[j + i]);
+#ifdef VEC_KERNELS
+        if (i <= M) {
+            sum = Corr_vec (y, i);
+        } else
+#endif
+        {
+            sum = 0;                   move32 ();
+
+            for (j = 0; j < L_WINDOW - i; j++) {
+                sum = efr_L_mac (sum, y[j], y[j + i]);
+            }
         }
 
         sum = efr_L_shl (sum, norm);
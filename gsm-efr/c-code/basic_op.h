@@ -1,8 +1,12 @@
 /*___________________________________________________________________________
  |                                                                           |
- |   Constants and Globals                                                   |
+ |   Basic arithmetic operators, defined static inline so that every call    |
+ |   compiles into the caller. The results and the efr_Overflow / efr_Carry  |
+ |   side effects are the same as in the ETSI reference basicop2.c.          |
  |___________________________________________________________________________|
 */
+#include <stdio.h>
+#include <stdlib.h>
 #include "typedef.h"
 #ifndef BASIC_OP_H
 #define BASIC_OP_H
@@ -11,8 +15,24 @@
 extern "C" {
 #endif
 
-extern Flag efr_Overflow;
-extern Flag efr_Carry;
+/*___________________________________________________________________________
+ |                                                                           |
+ |   Constants and Globals                                                   |
+ |                                                                           |
+ |   The flags are per thread: the encoder and the decoder may run on two    |
+ |   threads, and the encoder reads efr_Overflow back (G_pitch, Autocorr).   |
+ |___________________________________________________________________________|
+*/
+#if defined(__cplusplus) && __cplusplus >= 201103L
+#define EFR_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+#define EFR_THREAD_LOCAL __declspec(thread)
+#else
+#define EFR_THREAD_LOCAL __thread
+#endif
+
+extern EFR_THREAD_LOCAL Flag efr_Overflow;
+extern EFR_THREAD_LOCAL Flag efr_Carry;
 
 #define MAX_32 (Word32)0x7fffffffL
 #define MIN_32 (Word32)0x80000000L
@@ -22,52 +42,598 @@ extern Flag efr_Carry;
 
 /*___________________________________________________________________________
  |                                                                           |
- |   Prototypes for basic arithmetic operators                               |
+ |   Complexity counting                                                     |
+ |                                                                           |
+ |   WMOPS_COUNT (op, n) adds n to the counter of op. The composite          |
+ |   operators take back the counts of the operators they are built from,   |
+ |   as basicop2.c did. Without WMOPS the macro expands to nothing.          |
+ |___________________________________________________________________________|
+*/
+#if (WMOPS)
+#include "count.h"
+extern BASIC_OP counter;
+#define WMOPS_COUNT(op, n) (counter.op += (n))
+#else
+#define WMOPS_COUNT(op, n) ((void) 0)
+#endif
+
+/*___________________________________________________________________________
+ |                                                                           |
+ |   Overflow and leading bit helpers                                        |
  |___________________________________________________________________________|
 */
+#if defined(__GNUC__) || defined(__clang__)
+#define efr_add_overflow(a, b, res) __builtin_add_overflow (a, b, res)
+#define efr_sub_overflow(a, b, res) __builtin_sub_overflow (a, b, res)
+#define efr_clz32(x)                __builtin_clz (x)
+#else
+static inline int efr_add_overflow (Word32 a, Word32 b, Word32 *res)
+{
+    *res = (Word32) ((unsigned int) a + (unsigned int) b);
+    return (((a ^ b) & MIN_32) == 0) && (((*res ^ a) & MIN_32) != 0);
+}
+
+static inline int efr_sub_overflow (Word32 a, Word32 b, Word32 *res)
+{
+    *res = (Word32) ((unsigned int) a - (unsigned int) b);
+    return (((a ^ b) & MIN_32) != 0) && (((*res ^ a) & MIN_32) != 0);
+}
+
+static inline int efr_clz32 (unsigned int x)     /* x != 0 */
+{
+    int n = 0;
+    while ((x & 0x80000000u) == 0) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+}
+#endif
+
+/*___________________________________________________________________________
+ |                                                                           |
+ |   Operators                                                               |
+ |___________________________________________________________________________|
+*/
+
+static inline Word16 efr_shl (Word16 var1, Word16 var2);
+static inline Word32 efr_L_shl (Word32 L_var1, Word16 var2);
+
+/* Limit the 32 bit input to the range of a 16 bit word, efr_Overflow is
+   set to 1 if the input does not fit and cleared otherwise.  Not counted. */
+static inline Word16 saturate (Word32 L_var1)
+{
+    Word16 var_out;
+
+    if (L_var1 > 0X00007fffL) {
+        efr_Overflow = 1;
+        var_out = MAX_16;
+    } else if (L_var1 < (Word32) 0xffff8000L) {
+        efr_Overflow = 1;
+        var_out = MIN_16;
+    } else {
+        efr_Overflow = 0;
+        var_out = (Word16) L_var1;
+    }
+    return (var_out);
+}
+
+/* Short add with saturation,                                       1 */
+static inline Word16 efr_add (Word16 var1, Word16 var2)
+{
+    WMOPS_COUNT (efr_add, 1);
+    return saturate ((Word32) var1 + var2);
+}
+
+/* Short sub with saturation,                                       1 */
+static inline Word16 efr_sub (Word16 var1, Word16 var2)
+{
+    WMOPS_COUNT (efr_sub, 1);
+    return saturate ((Word32) var1 - var2);
+}
+
+/* Short abs, abs_s (-32768) = 32767,                               1 */
+static inline Word16 efr_abs_s (Word16 var1)
+{
+    WMOPS_COUNT (efr_abs_s, 1);
+    if (var1 == MIN_16)
+        return MAX_16;
+    return (var1 < 0) ? (Word16) -var1 : var1;
+}
+
+/* Short shift right, var2 < 0 shifts left,                         1 */
+static inline Word16 efr_shr (Word16 var1, Word16 var2)
+{
+    Word16 var_out;
+
+    if (var2 < 0) {
+        var_out = efr_shl (var1, (Word16) -var2);
+        WMOPS_COUNT (efr_shl, -1);
+    } else if (var2 >= 15) {
+        var_out = (var1 < 0) ? -1 : 0;
+    } else {
+        var_out = (Word16) (var1 >> var2);
+    }
+    WMOPS_COUNT (efr_shr, 1);
+    return (var_out);
+}
+
+/* Short shift left with saturation, var2 < 0 shifts right,         1 */
+static inline Word16 efr_shl (Word16 var1, Word16 var2)
+{
+    Word16 var_out;
+    Word32 result;
+
+    if (var2 < 0) {
+        var_out = efr_shr (var1, (Word16) -var2);
+        WMOPS_COUNT (efr_shr, -1);
+    } else if (var2 > 15) {
+        if (var1 != 0) {
+            efr_Overflow = 1;
+            var_out = (var1 > 0) ? MAX_16 : MIN_16;
+        } else {
+            var_out = 0;
+        }
+    } else {
+        result = (Word32) var1 * ((Word32) 1 << var2);
+        if (result != (Word32) ((Word16) result)) {
+            efr_Overflow = 1;
+            var_out = (var1 > 0) ? MAX_16 : MIN_16;
+        } else {
+            var_out = (Word16) result;
+        }
+    }
+    WMOPS_COUNT (efr_shl, 1);
+    return (var_out);
+}
+
+/* Short mult, (var1 * var2) >> 15 with saturation,                 1 */
+static inline Word16 efr_mult (Word16 var1, Word16 var2)
+{
+    WMOPS_COUNT (efr_mult, 1);
+    return saturate (((Word32) var1 * (Word32) var2) >> 15);
+}
+
+/* Long mult, (var1 * var2) << 1 with saturation,                   1 */
+static inline Word32 efr_L_mult (Word16 var1, Word16 var2)
+{
+    Word32 L_var_out;
+
+    L_var_out = (Word32) var1 * (Word32) var2;
+    if (L_var_out != (Word32) 0x40000000L) {
+        L_var_out *= 2;
+    } else {
+        efr_Overflow = 1;
+        L_var_out = MAX_32;
+    }
+    WMOPS_COUNT (efr_L_mult, 1);
+    return (L_var_out);
+}
+
+/* Short negate, negate (-32768) = 32767,                           1 */
+static inline Word16 efr_negate (Word16 var1)
+{
+    WMOPS_COUNT (efr_negate, 1);
+    return (var1 == MIN_16) ? MAX_16 : (Word16) -var1;
+}
+
+/* Extract high,                                                    1 */
+static inline Word16 efr_extract_h (Word32 L_var1)
+{
+    WMOPS_COUNT (efr_extract_h, 1);
+    return (Word16) (L_var1 >> 16);
+}
+
+/* Extract low,                                                     1 */
+static inline Word16 efr_extract_l (Word32 L_var1)
+{
+    WMOPS_COUNT (efr_extract_l, 1);
+    return (Word16) L_var1;
+}
+
+/* Long add with saturation,                                        2 */
+static inline Word32 efr_L_add (Word32 L_var1, Word32 L_var2)
+{
+    Word32 L_var_out;
+
+    if (efr_add_overflow (L_var1, L_var2, &L_var_out)) {
+        L_var_out = (L_var1 < 0) ? MIN_32 : MAX_32;
+        efr_Overflow = 1;
+    }
+    WMOPS_COUNT (efr_L_add, 1);
+    return (L_var_out);
+}
+
+/* Long sub with saturation,                                        2 */
+static inline Word32 efr_L_sub (Word32 L_var1, Word32 L_var2)
+{
+    Word32 L_var_out;
+
+    if (efr_sub_overflow (L_var1, L_var2, &L_var_out)) {
+        L_var_out = (L_var1 < 0L) ? MIN_32 : MAX_32;
+        efr_Overflow = 1;
+    }
+    WMOPS_COUNT (efr_L_sub, 1);
+    return (L_var_out);
+}
+
+/* Round, extract_h (L_add (L_var1, 0x8000)),                       1 */
+static inline Word16 gsm_efr_round (Word32 L_var1)
+{
+    WMOPS_COUNT (efr_L_add, -1);
+    WMOPS_COUNT (gsm_efr_round, 1);
+    return (Word16) (efr_L_add (L_var1, (Word32) 0x00008000L) >> 16);
+}
+
+/* Mac, L_add (L_var3, L_mult (var1, var2)),                        1 */
+static inline Word32 efr_L_mac (Word32 L_var3, Word16 var1, Word16 var2)
+{
+    Word32 L_var_out;
+
+    L_var_out = efr_L_add (L_var3, efr_L_mult (var1, var2));
+    WMOPS_COUNT (efr_L_mult, -1);
+    WMOPS_COUNT (efr_L_add, -1);
+    WMOPS_COUNT (efr_L_mac, 1);
+    return (L_var_out);
+}
+
+/* Msu, L_sub (L_var3, L_mult (var1, var2)),                        1 */
+static inline Word32 efr_L_msu (Word32 L_var3, Word16 var1, Word16 var2)
+{
+    Word32 L_var_out;
+
+    L_var_out = efr_L_sub (L_var3, efr_L_mult (var1, var2));
+    WMOPS_COUNT (efr_L_mult, -1);
+    WMOPS_COUNT (efr_L_sub, -1);
+    WMOPS_COUNT (efr_L_msu, 1);
+    return (L_var_out);
+}
+
+/* Long add with carry, no saturation,                              2 */
+static inline Word32 efr_L_add_c (Word32 L_var1, Word32 L_var2)
+{
+    Word32 L_var_out;
+    Word32 L_test;
+    Flag carry_int = 0;
+
+    L_var_out = (Word32) ((unsigned int) L_var1 + (unsigned int) L_var2
+                          + (unsigned int) efr_Carry);
+    L_test = (Word32) ((unsigned int) L_var1 + (unsigned int) L_var2);
+
+    if ((L_var1 > 0) && (L_var2 > 0) && (L_test < 0)) {
+        efr_Overflow = 1;
+        carry_int = 0;
+    } else if ((L_var1 < 0) && (L_var2 < 0)) {
+        efr_Overflow = (L_test >= 0);
+        carry_int = 1;
+    } else {
+        efr_Overflow = 0;
+        carry_int = ((L_var1 ^ L_var2) < 0) && (L_test >= 0);
+    }
+
+    if (efr_Carry) {
+        if (L_test == MAX_32) {
+            efr_Overflow = 1;
+            efr_Carry = carry_int;
+        } else if (L_test == (Word32) 0xFFFFFFFFL) {
+            efr_Carry = 1;
+        } else {
+            efr_Carry = carry_int;
+        }
+    } else {
+        efr_Carry = carry_int;
+    }
+    WMOPS_COUNT (efr_L_add_c, 1);
+    return (L_var_out);
+}
+
+/* Long sub with carry, no saturation,                              2 */
+static inline Word32 efr_L_sub_c (Word32 L_var1, Word32 L_var2)
+{
+    Word32 L_var_out;
+    Word32 L_test;
+    Flag carry_int = 0;
+
+    if (efr_Carry) {
+        efr_Carry = 0;
+        if (L_var2 != MIN_32) {
+            L_var_out = efr_L_add_c (L_var1, -L_var2);
+            WMOPS_COUNT (efr_L_add_c, -1);
+        } else {
+            L_var_out = (Word32) ((unsigned int) L_var1 - (unsigned int) L_var2);
+            if (L_var1 > 0L) {
+                efr_Overflow = 1;
+                efr_Carry = 0;
+            }
+        }
+    } else {
+        L_var_out = (Word32) ((unsigned int) L_var1 - (unsigned int) L_var2 - 1u);
+        L_test = (Word32) ((unsigned int) L_var1 - (unsigned int) L_var2);
+
+        if ((L_test < 0) && (L_var1 > 0) && (L_var2 < 0)) {
+            efr_Overflow = 1;
+            carry_int = 0;
+        } else if ((L_test > 0) && (L_var1 < 0) && (L_var2 > 0)) {
+            efr_Overflow = 1;
+            carry_int = 1;
+        } else if ((L_test > 0) && ((L_var1 ^ L_var2) > 0)) {
+            efr_Overflow = 0;
+            carry_int = 1;
+        }
+        if (L_test == MIN_32) {
+            efr_Overflow = 1;
+        }
+        efr_Carry = carry_int;
+    }
+    WMOPS_COUNT (efr_L_sub_c, 1);
+    return (L_var_out);
+}
+
+/* Mac without saturation, L_add_c (L_var3, L_mult (var1, var2)),   1 */
+static inline Word32 efr_L_macNs (Word32 L_var3, Word16 var1, Word16 var2)
+{
+    Word32 L_var_out;
+
+    L_var_out = efr_L_add_c (L_var3, efr_L_mult (var1, var2));
+    WMOPS_COUNT (efr_L_mult, -1);
+    WMOPS_COUNT (efr_L_add_c, -1);
+    WMOPS_COUNT (efr_L_macNs, 1);
+    return (L_var_out);
+}
+
+/* Msu without saturation, L_sub_c (L_var3, L_mult (var1, var2)),   1 */
+static inline Word32 efr_L_msuNs (Word32 L_var3, Word16 var1, Word16 var2)
+{
+    Word32 L_var_out;
+
+    L_var_out = efr_L_sub_c (L_var3, efr_L_mult (var1, var2));
+    WMOPS_COUNT (efr_L_mult, -1);
+    WMOPS_COUNT (efr_L_sub_c, -1);
+    WMOPS_COUNT (efr_L_msuNs, 1);
+    return (L_var_out);
+}
+
+/* Long negate, L_negate (-2^31) = 2^31 - 1,                        2 */
+static inline Word32 efr_L_negate (Word32 L_var1)
+{
+    WMOPS_COUNT (efr_L_negate, 1);
+    return (L_var1 == MIN_32) ? MAX_32 : -L_var1;
+}
+
+/* Mult with rounding, (var1 * var2 + 2^14) >> 15 with saturation,  2 */
+static inline Word16 efr_mult_r (Word16 var1, Word16 var2)
+{
+    WMOPS_COUNT (efr_mult_r, 1);
+    return saturate (((Word32) var1 * (Word32) var2 + (Word32) 0x00004000L) >> 15);
+}
+
+/* Long shift right, var2 < 0 shifts left,                          2 */
+static inline Word32 efr_L_shr (Word32 L_var1, Word16 var2)
+{
+    Word32 L_var_out;
+
+    if (var2 < 0) {
+        L_var_out = efr_L_shl (L_var1, (Word16) -var2);
+        WMOPS_COUNT (efr_L_shl, -1);
+    } else if (var2 >= 31) {
+        L_var_out = (L_var1 < 0L) ? -1 : 0;
+    } else {
+        L_var_out = L_var1 >> var2;
+    }
+    WMOPS_COUNT (efr_L_shr, 1);
+    return (L_var_out);
+}
+
+/* Long shift left with saturation, var2 <= 0 shifts right,         2
+   The reference shifts one bit at a time and stops at the first bit
+   that would overflow; comparing against the bounds shifted down by
+   var2 gives the same result and efr_Overflow in one step. */
+static inline Word32 efr_L_shl (Word32 L_var1, Word16 var2)
+{
+    Word32 L_var_out;
+
+    if (var2 <= 0) {
+        L_var_out = efr_L_shr (L_var1, (Word16) -var2);
+        WMOPS_COUNT (efr_L_shr, -1);
+    } else if (var2 > 31) {
+        if (L_var1 != 0) {
+            efr_Overflow = 1;
+            L_var_out = (L_var1 > 0) ? MAX_32 : MIN_32;
+        } else {
+            L_var_out = 0;
+        }
+    } else if (L_var1 > (MAX_32 >> var2)) {
+        efr_Overflow = 1;
+        L_var_out = MAX_32;
+    } else if (L_var1 < (MIN_32 >> var2)) {
+        efr_Overflow = 1;
+        L_var_out = MIN_32;
+    } else {
+        L_var_out = (Word32) ((unsigned int) L_var1 << var2);
+    }
+    WMOPS_COUNT (efr_L_shl, 1);
+    return (L_var_out);
+}
+
+/* Shift right with rounding,                                       2 */
+static inline Word16 efr_shr_r (Word16 var1, Word16 var2)
+{
+    Word16 var_out;
+
+    if (var2 > 15) {
+        var_out = 0;
+    } else {
+        var_out = efr_shr (var1, var2);
+        WMOPS_COUNT (efr_shr, -1);
+        if (var2 > 0) {
+            if ((var1 & ((Word16) 1 << (var2 - 1))) != 0) {
+                var_out++;
+            }
+        }
+    }
+    WMOPS_COUNT (efr_shr_r, 1);
+    return (var_out);
+}
+
+/* Mac with rounding, round (L_mac (L_var3, var1, var2)),           2 */
+static inline Word16 efr_mac_r (Word32 L_var3, Word16 var1, Word16 var2)
+{
+    L_var3 = efr_L_add (efr_L_mac (L_var3, var1, var2), (Word32) 0x00008000L);
+    WMOPS_COUNT (efr_L_mac, -1);
+    WMOPS_COUNT (efr_L_add, -1);
+    WMOPS_COUNT (efr_mac_r, 1);
+    return (Word16) (L_var3 >> 16);
+}
+
+/* Msu with rounding, round (L_msu (L_var3, var1, var2)),           2 */
+static inline Word16 efr_msu_r (Word32 L_var3, Word16 var1, Word16 var2)
+{
+    L_var3 = efr_L_add (efr_L_msu (L_var3, var1, var2), (Word32) 0x00008000L);
+    WMOPS_COUNT (efr_L_msu, -1);
+    WMOPS_COUNT (efr_L_add, -1);
+    WMOPS_COUNT (efr_msu_r, 1);
+    return (Word16) (L_var3 >> 16);
+}
+
+/* 16 bit var1 -> MSB,                                              2 */
+static inline Word32 efr_L_deposit_h (Word16 var1)
+{
+    WMOPS_COUNT (efr_L_deposit_h, 1);
+    return (Word32) ((unsigned int) (Word32) var1 << 16);
+}
+
+/* 16 bit var1 -> LSB,                                              2 */
+static inline Word32 efr_L_deposit_l (Word16 var1)
+{
+    WMOPS_COUNT (efr_L_deposit_l, 1);
+    return (Word32) var1;
+}
+
+/* Long shift right with rounding,                                  3 */
+static inline Word32 efr_L_shr_r (Word32 L_var1, Word16 var2)
+{
+    Word32 L_var_out;
+
+    if (var2 > 31) {
+        L_var_out = 0;
+    } else {
+        L_var_out = efr_L_shr (L_var1, var2);
+        WMOPS_COUNT (efr_L_shr, -1);
+        if (var2 > 0) {
+            if ((L_var1 & ((Word32) 1 << (var2 - 1))) != 0) {
+                L_var_out++;
+            }
+        }
+    }
+    WMOPS_COUNT (efr_L_shr_r, 1);
+    return (L_var_out);
+}
+
+/* Long abs, L_abs (-2^31) = 2^31 - 1,                              3 */
+static inline Word32 efr_L_abs (Word32 L_var1)
+{
+    WMOPS_COUNT (efr_L_abs, 1);
+    if (L_var1 == MIN_32)
+        return MAX_32;
+    return (L_var1 < 0) ? -L_var1 : L_var1;
+}
+
+/* Long saturation after L_add_c / L_sub_c,                         4 */
+static inline Word32 efr_L_sat (Word32 L_var1)
+{
+    Word32 L_var_out;
+
+    L_var_out = L_var1;
+    if (efr_Overflow) {
+        L_var_out = efr_Carry ? MIN_32 : MAX_32;
+        efr_Carry = 0;
+        efr_Overflow = 0;
+    }
+    WMOPS_COUNT (efr_L_sat, 1);
+    return (L_var_out);
+}
+
+/* Short norm, left shifts needed to normalize var1,               15 */
+static inline Word16 efr_norm_s (Word16 var1)
+{
+    Word16 var_out;
+
+    if (var1 == 0) {
+        var_out = 0;
+    } else if (var1 == (Word16) 0xffff) {
+        var_out = 15;
+    } else {
+        if (var1 < 0) {
+            var1 = ~var1;
+        }
+        var_out = (Word16) (efr_clz32 ((unsigned int) var1) - 17);
+    }
+    WMOPS_COUNT (efr_norm_s, 1);
+    return (var_out);
+}
+
+/* Short division, var1 / var2 in Q15 for 0 <= var1 <= var2,       18 */
+static inline Word16 efr_div_s (Word16 var1, Word16 var2)
+{
+    Word16 var_out = 0;
+    Word16 iteration;
+    Word32 L_num;
+    Word32 L_denom;
+
+    if ((var1 > var2) || (var1 < 0) || (var2 < 0)) {
+        printf ("Division Error var1=%d  var2=%d\n", var1, var2);
+        exit (0);
+    }
+    if (var2 == 0) {
+        printf ("Division by 0, Fatal error \n");
+        exit (0);
+    }
+    if (var1 == 0) {
+        var_out = 0;
+    } else if (var1 == var2) {
+        var_out = MAX_16;
+    } else {
+        L_num = (Word32) var1;
+        L_denom = (Word32) var2;
+
+        /* L_num < L_denom <= 32767, so neither the shift nor the
+           subtraction nor the increment can overflow */
+        for (iteration = 0; iteration < 15; iteration++) {
+            var_out <<= 1;
+            L_num <<= 1;
+            if (L_num >= L_denom) {
+                L_num -= L_denom;
+                var_out++;
+            }
+        }
+        /* the reference increments with add (), which clears the flag,
+           and it always increments at least once */
+        efr_Overflow = 0;
+    }
+    WMOPS_COUNT (efr_div_s, 1);
+    return (var_out);
+}
+
+/* Long norm, left shifts needed to normalize L_var1,              30 */
+static inline Word16 efr_norm_l (Word32 L_var1)
+{
+    Word16 var_out;
+
+    if (L_var1 == 0) {
+        var_out = 0;
+    } else if (L_var1 == (Word32) 0xffffffffL) {
+        var_out = 31;
+    } else {
+        if (L_var1 < 0) {
+            L_var1 = ~L_var1;
+        }
+        var_out = (Word16) (efr_clz32 ((unsigned int) L_var1) - 1);
+    }
+    WMOPS_COUNT (efr_norm_l, 1);
+    return (var_out);
+}
 
-Word16 efr_add (Word16 var1, Word16 var2);    /* Short efr_add,           1   */
-Word16 efr_sub (Word16 var1, Word16 var2);    /* Short efr_sub,           1   */
-Word16 efr_abs_s (Word16 var1);               /* Short abs,           1   */
-Word16 efr_shl (Word16 var1, Word16 var2);    /* Short shift left,    1   */
-Word16 efr_shr (Word16 var1, Word16 var2);    /* Short shift right,   1   */
-Word16 efr_mult (Word16 var1, Word16 var2);   /* Short efr_mult,          1   */
-Word32 efr_L_mult (Word16 var1, Word16 var2); /* Long efr_mult,           1   */
-Word16 efr_negate (Word16 var1);              /* Short efr_negate,        1   */
-Word16 efr_extract_h (Word32 L_var1);         /* Extract high,        1   */
-Word16 efr_extract_l (Word32 L_var1);         /* Extract low,         1   */
-Word16 gsm_efr_round (Word32 L_var1);             /* Round,               1   */
-Word32 efr_L_mac (Word32 L_var3, Word16 var1, Word16 var2);   /* Mac,  1  */
-Word32 efr_L_msu (Word32 L_var3, Word16 var1, Word16 var2);   /* Msu,  1  */
-Word32 efr_L_macNs (Word32 L_var3, Word16 var1, Word16 var2); /* Mac without
-                                                             sat, 1   */
-Word32 efr_L_msuNs (Word32 L_var3, Word16 var1, Word16 var2); /* Msu without
-                                                             sat, 1   */
-Word32 efr_L_add (Word32 L_var1, Word32 L_var2);    /* Long efr_add,        2 */
-Word32 efr_L_sub (Word32 L_var1, Word32 L_var2);    /* Long efr_sub,        2 */
-Word32 efr_L_add_c (Word32 L_var1, Word32 L_var2);  /* Long efr_add with c, 2 */
-Word32 efr_L_sub_c (Word32 L_var1, Word32 L_var2);  /* Long efr_sub with c, 2 */
-Word32 efr_L_negate (Word32 L_var1);                /* Long efr_negate,     2 */
-Word16 efr_mult_r (Word16 var1, Word16 var2);       /* Mult with gsm_efr_round, 2 */
-Word32 efr_L_shl (Word32 L_var1, Word16 var2);      /* Long shift left, 2 */
-Word32 efr_L_shr (Word32 L_var1, Word16 var2);      /* Long shift right, 2*/
-Word16 efr_shr_r (Word16 var1, Word16 var2);        /* Shift right with
-                                                   gsm_efr_round, 2           */
-Word16 efr_mac_r (Word32 L_var3, Word16 var1, Word16 var2); /* Mac with
-                                                           gsm_efr_rounding,2 */
-Word16 efr_msu_r (Word32 L_var3, Word16 var1, Word16 var2); /* Msu with
-                                                           gsm_efr_rounding,2 */
-Word32 efr_L_deposit_h (Word16 var1);        /* 16 bit var1 -> MSB,     2 */
-Word32 efr_L_deposit_l (Word16 var1);        /* 16 bit var1 -> LSB,     2 */
-
-Word32 efr_L_shr_r (Word32 L_var1, Word16 var2); /* Long shift right with
-                                                gsm_efr_round,  3             */
-Word32 efr_L_abs (Word32 L_var1);            /* Long abs,              3  */
-Word32 efr_L_sat (Word32 L_var1);            /* Long saturation,       4  */
-Word16 efr_norm_s (Word16 var1);             /* Short norm,           15  */
-Word16 efr_div_s (Word16 var1, Word16 var2); /* Short division,       18  */
-Word16 efr_norm_l (Word32 L_var1);           /* Long norm,            30  */
 #ifdef __cplusplus
 }
 #endif
-#endif
\ No newline at end of file
+#endif
@@ -45,6 +45,15 @@ Word16 Bin2int (        /* Reconstructed parameter                      */
 #define BIT_1     1
 #define PRM_NO    57
 
+static const Word16 bitno[PRM_NO] =
+{
+    7, 8, 9, 8, 6,                              /* LSP VQ          */
+    9, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5,      /* first subframe  */
+    6, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5,      /* second subframe */
+    9, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5,      /* third subframe  */
+    6, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5       /* fourth subframe */
+};
+
 void Bits2prm_12k2 (
     Word16 bits[],      /* input : serial bits (244 + bfi)                */
     Word16 prm[]        /* output: analysis parameters  (57+1 parameters) */
@@ -52,14 +61,6 @@ void Bits2prm_12k2 (
 {
     Word16 i;
 
-    static const Word16 bitno[PRM_NO] =
-    {
-        7, 8, 9, 8, 6,                          /* LSP VQ          */
-        9, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5,  /* first subframe  */
-        6, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5,  /* second subframe */
-        9, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5,  /* third subframe  */
-        6, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5}; /* fourth subframe */
-
     *prm++ = *bits++;                           move16 (); /* read BFI */
 
     for (i = 0; i < PRM_NO; i++)
@@ -70,6 +71,39 @@ void Bits2prm_12k2 (
     return;
 }
 
+/*************************************************************************
+ *
+ *  FUNCTION:  Bytes2prm_12k2
+ *
+ *  PURPOSE: Retrieves the encoder parameters from the 244 serial bits
+ *           packed by Prm2bytes_12k2() (no BFI).
+ *
+ *************************************************************************/
+
+void Bytes2prm_12k2 (
+    unsigned char bytes[],  /* input : 244 serial bits in 31 bytes          */
+    Word16 prm[]            /* output: analysis parameters  (57 parameters) */
+)
+{
+    Word16 i, n;
+    Word32 acc;
+
+    acc = 0;
+    n = 0;                  /* bits in acc */
+    for (i = 0; i < PRM_NO; i++)
+    {
+        while (n < bitno[i])
+        {
+            acc = (acc << 8) | *bytes++;
+            n += 8;
+        }
+        n -= bitno[i];
+        prm[i] = (Word16) (acc >> n);
+        acc &= (1L << n) - 1;
+    }
+    return;
+}
+
 /*************************************************************************
  *
  *  FUNCTION:  Bin2int                   
@@ -2,11 +2,18 @@
 #include "basic_op.h"
 #include "sig_proc.h"
 #include "count.h"
+#include "codec.h"
+#include "vec_op.h"
 
 #define L_CODE    40
 #define NB_TRACK  5
 #define NB_PULSE  10
 #define STEP      5
+#define NB_POS    8     /* positions per track, L_CODE / STEP */
+
+/* rr[][] is stored by track: the correlation between the positions i and
+   j = k + n * STEP (track k) is rr[i][k][n], so that the 8 positions of a
+   track form one row of a vector of 16 bit words */
 
 /* local functions */
 
@@ -28,11 +35,11 @@ void cor_h (
     Word16 h[],         /* (i)  : impulse response of weighted synthesis
                                   filter */
     Word16 sign[],      /* (i)  : sign of d[n]                             */
-    Word16 rr[][L_CODE] /* (o)  : matrix of autocorrelation                */
+    Word16 rr[][NB_TRACK][NB_POS] /* (o) : matrix of autocorrelation        */
 );
 void search_10i40 (
     Word16 dn[],         /* (i) : correlation between target and h[]       */
-    Word16 rr[][L_CODE], /* (i) : matrix of autocorrelation                */
+    Word16 rr[][NB_TRACK][NB_POS], /* (i) : matrix of autocorrelation      */
     Word16 ipos[],       /* (i) : starting position for each pulse         */
     Word16 pos_max[],    /* (i) : position of maximum of dn[]              */
     Word16 codvec[]      /* (o) : algebraic codebook vector                */
@@ -90,7 +97,7 @@ void code_10i40_35bits (
 {
     Word16 ipos[NB_PULSE], pos_max[NB_TRACK], codvec[NB_PULSE];
     Word16 dn[L_CODE], sign[L_CODE];
-    Word16 rr[L_CODE][L_CODE], i;
+    Word16 rr[L_CODE][NB_TRACK][NB_POS], i;
 
     cor_h_x (h, x, dn);
     set_sign (dn, cn, sign, pos_max, ipos);
@@ -306,17 +313,75 @@ void q_p (
  *  and the sign information is included by
  *         rr[i][j] = rr[i][j]*sign[i]*sign[j]
  *
+ *  rr[i][j] is stored in rr[i][j % STEP][j / STEP].
+ *
+ *  With SSE2 / NEON, 8 diagonals are summed in vector lanes when no
+ *  L_mac can saturate.
+ *
  *************************************************************************/
 
+#ifdef VEC_KERNELS
+/* offset of rr[i][j % STEP][j / STEP] in the row rr[i], j = 0..L_CODE-1 */
+static const Word16 rr_off[L_CODE] =
+{
+    0,  8, 16, 24, 32,  1,  9, 17, 25, 33,  2, 10, 18, 26, 34,
+    3, 11, 19, 27, 35,  4, 12, 20, 28, 36,  5, 13, 21, 29, 37,
+    6, 14, 22, 30, 38,  7, 15, 23, 31, 39
+};
+
+/* c[k][l] = round (sum_{n=0}^{k} h2[n] * h2[n + d + l] * 2), l = 0..7,
+   k = 0..L_CODE-1-d; h2[L_CODE..L_CODE+7] are zero */
+static void cor_h_diag8 (Word16 h2[], Word16 d, Word16 c[][8])
+{
+    Word16 k;
+#ifdef VEC_SSE2
+    __m128i x, hk, a0, a1, r0, r1;
+
+    a0 = _mm_setzero_si128 ();
+    a1 = _mm_setzero_si128 ();
+    for (k = 0; k < L_CODE - d; k++)
+    {
+        /* (h2[k], 0) pairs */
+        hk = _mm_set1_epi32 ((unsigned short) h2[k]);
+        x = _mm_loadu_si128 ((__m128i *) &h2[k + d]);
+        a0 = _mm_add_epi32 (a0, _mm_madd_epi16 (_mm_unpacklo_epi16 (x, _mm_setzero_si128 ()), hk));
+        a1 = _mm_add_epi32 (a1, _mm_madd_epi16 (_mm_unpackhi_epi16 (x, _mm_setzero_si128 ()), hk));
+        r0 = _mm_add_epi32 (_mm_slli_epi32 (a0, 1), _mm_set1_epi32 (0x8000L));
+        r1 = _mm_add_epi32 (_mm_slli_epi32 (a1, 1), _mm_set1_epi32 (0x8000L));
+        _mm_storeu_si128 ((__m128i *) c[k],
+                          _mm_packs_epi32 (_mm_srai_epi32 (r0, 16), _mm_srai_epi32 (r1, 16)));
+    }
+#else
+    int32x4_t a0, a1, r0, r1;
+
+    a0 = vdupq_n_s32 (0);
+    a1 = vdupq_n_s32 (0);
+    for (k = 0; k < L_CODE - d; k++)
+    {
+        a0 = vmlal_n_s16 (a0, vld1_s16 (&h2[k + d]), h2[k]);
+        a1 = vmlal_n_s16 (a1, vld1_s16 (&h2[k + d + 4]), h2[k]);
+        r0 = vaddq_s32 (vshlq_n_s32 (a0, 1), vdupq_n_s32 (0x8000L));
+        r1 = vaddq_s32 (vshlq_n_s32 (a1, 1), vdupq_n_s32 (0x8000L));
+        vst1q_s16 (c[k], vcombine_s16 (vshrn_n_s32 (r0, 16), vshrn_n_s32 (r1, 16)));
+    }
+#endif
+    return;
+}
+#endif
+
 void cor_h (
     Word16 h[],         /* (i) : impulse response of weighted synthesis
                                  filter                                  */
     Word16 sign[],      /* (i) : sign of d[n]                            */
-    Word16 rr[][L_CODE] /* (o) : matrix of autocorrelation               */
+    Word16 rr[][NB_TRACK][NB_POS] /* (o) : matrix of autocorrelation     */
 )
 {
-    Word16 i, j, k, dec, h2[L_CODE];
+    Word16 i, j, k, dec, h2[L_CODE + 8];
     Word32 s;
+#ifdef VEC_KERNELS
+    Word16 l, r, v, c[L_CODE][8];
+    Word16 *rp = &rr[0][0][0];
+#endif
 
     /* Scaling for maximum precision */
 
@@ -345,6 +410,44 @@ void cor_h (
                                                  move16 (); 
         }
     }
+
+#ifdef VEC_KERNELS
+    /* |sum h2[n] * h2[n + dec]| <= sum h2[n]^2 over any range of n, so
+       nothing saturates when 2 * sum h2[n]^2 + 0x8000 <= MAX_32 */
+    s = 0;
+    for (i = 0; (i < L_CODE) && (s <= ((MAX_32 - 0x8000L) >> 1)); i++)
+    {
+        s += (Word32) h2[i] * h2[i];
+    }
+    if (s <= ((MAX_32 - 0x8000L) >> 1))
+    {
+        for (i = L_CODE; i < L_CODE + 8; i++)
+        {
+            h2[i] = 0;
+        }
+        for (k = 0; k < L_CODE; k += 8)
+        {
+            cor_h_diag8 (h2, k, c);
+            for (l = 0; l < 8; l++)
+            {
+                dec = k + l;
+                j = L_CODE - 1;
+                i = j - dec;
+                for (r = 0; r < L_CODE - dec; r++, i--, j--)
+                {
+                    v = c[r][l];
+                    if (dec != 0)
+                    {
+                        v = efr_mult (v, efr_mult (sign[i], sign[j]));
+                    }
+                    rp[j * L_CODE + rr_off[i]] = v;
+                    rp[i * L_CODE + rr_off[j]] = v;
+                }
+            }
+        }
+        return;
+    }
+#endif
     
     /* build matrix rr[] */
     s = 0;                                       move32 (); 
@@ -352,7 +455,7 @@ void cor_h (
     for (k = 0; k < L_CODE; k++, i--)
     {
         s = efr_L_mac (s, h2[k], h2[k]);
-        rr[i][i] = gsm_efr_round (s);                    move16 (); 
+        rr[i][i % STEP][i / STEP] = gsm_efr_round (s);   move16 (); 
     }
     
     for (dec = 1; dec < L_CODE; dec++)
@@ -363,9 +466,11 @@ void cor_h (
         for (k = 0; k < (L_CODE - dec); k++, i--, j--)
         {
             s = efr_L_mac (s, h2[k], h2[k + dec]);
-            rr[j][i] = efr_mult (gsm_efr_round (s), efr_mult (sign[i], sign[j]));
+            rr[j][i % STEP][i / STEP] = efr_mult (gsm_efr_round (s),
+                                                  efr_mult (sign[i], sign[j]));
+                                                 move16 (); 
+            rr[i][j % STEP][j / STEP] = rr[j][i % STEP][i / STEP];
                                                  move16 (); 
-            rr[i][j] = rr[j][i];                 move16 (); 
         }
     }
 }
@@ -377,6 +482,12 @@ void cor_h (
  *  PURPOSE: Search the best codevector; determine positions of the 10 pulses
  *           in the 40-sample frame.
  *
+ *  DESCRIPTION:
+ *    The pulses are placed by pairs (i2,i3), (i4,i5), (i6,i7), (i8,i9)
+ *    in search_pair(). With SSE2 / NEON, search_pair_vec() computes the
+ *    energies of the 8 positions of a track in vector lanes and tests the
+ *    8 positions of the second pulse of a pair at once.
+ *
  *************************************************************************/
 
 #define _1_2    (Word16)(32768L/2)
@@ -387,20 +498,573 @@ void cor_h (
 #define _1_64   (Word16)(32768L/64)
 #define _1_128  (Word16)(32768L/128)
 
+/* weights of the pairs (i2,i3) .. (i8,i9): rr[ib][ib] and rr[ip[k]][ib]
+   in rrv[], rr[ia][ia] and rr[ip[k]][ia] in alp1, rrv[] and rr[ia][ib]
+   in alp2 */
+static const Word16 w_pair[4][6] =
+{
+    {_1_8,  _1_4, _1_16,  _1_8,  _1_2, _1_8},
+    {_1_8,  _1_4, _1_32,  _1_16, _1_4, _1_16},
+    {_1_16, _1_8, _1_64,  _1_32, _1_4, _1_32},
+    {_1_16, _1_8, _1_128, _1_64, _1_8, _1_64}
+};
+
+#ifdef VEC_KERNELS
+static Word16 search_mode = SEARCH_EXACT;
+#else
+static Word16 search_mode = SEARCH_REFERENCE;
+#endif
+
+Word16 Set_search_10i40_mode (Word16 mode)
+{
+#ifdef VEC_KERNELS
+    search_mode = (mode == SEARCH_REFERENCE) ? SEARCH_REFERENCE : SEARCH_EXACT;
+#else
+    search_mode = SEARCH_REFERENCE;
+#endif
+    return search_mode;
+}
+
+/*------------------------------------------------------------------------*
+ * search_row: tests the pulse pair (ia, ib) for the 8 positions ib of a  *
+ * track. Returns the last position retained (0..7), or -1.               *
+ *------------------------------------------------------------------------*/
+
+static inline Word16 search_row (
+    Word16 ps1,      /* (i)   : correlation of the pulses up to ia         */
+    Word32 alp1,     /* (i)   : energy of the pulses up to ia              */
+    Word16 dn2[],    /* (i)   : dn[] on the track of ib                    */
+    Word16 rrv[],    /* (i)   : rr[][ib] of the pulses up to ia, but ia    */
+    Word16 rr2[],    /* (i)   : rr[ia][ib]                                 */
+    Word16 c_v,      /* (i)   : weight of rrv[]                            */
+    Word16 c_r,      /* (i)   : weight of rr2[]                            */
+    Word16 *sq,      /* (i/o) : best correlation square                    */
+    Word16 *ps,      /* (i/o) : best correlation                           */
+    Word16 *alp      /* (i/o) : best energy                                */
+)
+{
+    Word16 j, jb, ps2, sq2, alp_16, b_sq, b_ps, b_alp;
+    Word32 s, alp2;
+
+    b_sq = *sq;                                  move16 ();
+    b_ps = *ps;                                  move16 ();
+    b_alp = *alp;                                move16 ();
+    jb = -1;                                     move16 ();
+
+    /* initialize 3 indices for ib inner loop */
+    move16 (); /* initialize "dn[ib]" pointer     */
+    move16 (); /* initialize "rrv[ib]" pointer    */
+    move16 (); /* initialize "rr[ia][ib]" pointer */
+
+    for (j = 0; j < NB_POS; j++)
+    {
+        ps2 = efr_add (ps1, dn2[j]);
+
+        alp2 = efr_L_mac (alp1, rrv[j], c_v);
+        alp2 = efr_L_mac (alp2, rr2[j], c_r);
+
+        sq2 = efr_mult (ps2, ps2);
+
+        alp_16 = gsm_efr_round (alp2);
+
+        s = efr_L_msu (efr_L_mult (b_alp, sq2), b_sq, alp_16);
+
+        test ();
+        if (s > 0)
+        {
+            b_sq = sq2;                          move16 ();
+            b_ps = ps2;                          move16 ();
+            b_alp = alp_16;                      move16 ();
+            jb = j;                              move16 ();
+        }
+    }
+    *sq = b_sq;                                  move16 ();
+    *ps = b_ps;                                  move16 ();
+    *alp = b_alp;                                move16 ();
+    return jb;
+}
+
+/*------------------------------------------------------------------------*
+ * search_pair: places the pulses n and n+1 (n = 2, 4, 6, 8) on the       *
+ * tracks ipos[n] and ipos[n+1], the pulses ip[0..n-1] being placed.      *
+ *------------------------------------------------------------------------*/
+
+static inline void search_pair (
+    Word16 n,                      /* (i)   : number of pulses placed     */
+    Word16 dn[][NB_POS],           /* (i)   : dn[] by track               */
+    Word16 rr[][NB_TRACK][NB_POS], /* (i)   : matrix of autocorrelation   */
+    Word16 rr_d[][NB_POS],         /* (i)   : rr[i][i] by track           */
+    Word16 ipos[],                 /* (i)   : starting position of pulses */
+    Word16 ip[],                   /* (i/o) : pulse positions             */
+    Word16 *ps0,                   /* (i/o) : correlation of ip[0..n-1],  */
+                                   /*         then of ip[0..n+1]          */
+    Word32 *alp0,                  /* (i/o) : energy of ip[0..n-1], then  */
+                                   /*         of ip[0..n+1] * 0.5         */
+    Word16 *sq,                    /* (o)   : correlation square          */
+    Word16 *alp                    /* (o)   : energy of ip[0..n+1]        */
+)
+{
+    Word16 j, k, ta, tb, ia, ib, jb, ps, ps1;
+    Word16 rrv[NB_POS];
+    const Word16 *w;
+    Word32 s, alp1;
+
+    w = w_pair[efr_sub (efr_shr (n, 1), 1)];
+    ta = ipos[n];                                move16 ();
+    tb = ipos[n + 1];                            move16 ();
+
+    for (j = 0; j < NB_POS; j++)
+    {
+        s = efr_L_mult (rr_d[tb][j], w[0]);
+        for (k = 0; k < n; k++)
+        {
+            s = efr_L_mac (s, rr[ip[k]][tb][j], w[1]);
+        }
+        rrv[j] = gsm_efr_round (s);                  move16 ();
+    }
+
+    /* Default value */
+    *sq = -1;                                    move16 ();
+    *alp = 1;                                    move16 ();
+    ps = 0;                                      move16 ();
+    ia = ta;                                     move16 ();
+    ib = tb;                                     move16 ();
+
+    for (j = 0; j < NB_POS; j++)
+    {
+        ps1 = efr_add (*ps0, dn[ta][j]);
+
+        alp1 = efr_L_mac (*alp0, rr_d[ta][j], w[2]);
+        for (k = 0; k < n; k++)
+        {
+            alp1 = efr_L_mac (alp1, rr[ip[k]][ta][j], w[3]);
+        }
+
+        jb = search_row (ps1, alp1, dn[tb], rrv, rr[ta + j * STEP][tb],
+                         w[4], w[5], sq, &ps, alp);
+        test ();
+        if (jb >= 0)
+        {
+            ia = ta + j * STEP;                  move16 ();
+            ib = tb + jb * STEP;                 move16 ();
+        }
+    }
+    ip[n] = ia;                                  move16 ();
+    ip[n + 1] = ib;                              move16 ();
+
+    *ps0 = ps;                                   move16 ();
+    *alp0 = efr_L_mult (*alp, _1_2);
+}
+
+#ifdef VEC_KERNELS
+/*------------------------------------------------------------------------*
+ * search_pair_vec: search_pair() with the 8 positions of a track in      *
+ * vector lanes.                                                          *
+ *                                                                        *
+ * rrv[] and alp1 are plain integer sums: the terms of alp1 add up to     *
+ * less than 2^30 - 2^29 and |alp0| <= 2^30, so its L_mac chain never     *
+ * saturates; rrv[j] is taken from the reference chain when the sum of    *
+ * its absolute terms does not fit (rr[][] > -32768).                     *
+ *                                                                        *
+ * A row of 8 candidates ib for one ia is added in 32 bit lanes when alp1 *
+ * is far enough from the limits for none of the L_mac / round to         *
+ * saturate; mult (ps2, ps2) keeps the saturation of -32768 * -32768.     *
+ * s > 0 has the sign of alp * sq2 - sq * alp_16, which fits in 32 bits.  *
+ * With all alp_16 > 0 it compares sq2 / alp_16 with sq / alp, so the     *
+ * rows scanned in order end on the first (ia, ib) of the largest ratio:  *
+ * each lane keeps the first row of its largest ratio and the 8 lanes are *
+ * compared once. Else the rows are scanned with search_row().            *
+ *                                                                        *
+ * efr_Overflow is not maintained, G_pitch() clears it before reading.    *
+ *------------------------------------------------------------------------*/
+
+#ifdef VEC_SSE2
+typedef struct { __m128i lo, hi; } Vec32;
+
+/* a[j] = v */
+static inline void Vec32_set (Vec32 *a, Word32 v)
+{
+    a->lo = _mm_set1_epi32 (v);
+    a->hi = a->lo;
+}
+
+/* a[j] += x[j] * cx + y[j] * cy, or |x[j]| * cx + |y[j]| * cy */
+static inline void Vec32_mac2 (Vec32 *a, Word16 x[], Word16 cx,
+                               Word16 y[], Word16 cy, Word16 abs)
+{
+    __m128i vx, vy, c;
+
+    vx = _mm_loadu_si128 ((__m128i *) x);
+    vy = _mm_loadu_si128 ((__m128i *) y);
+    if (abs)
+    {
+        vx = _mm_max_epi16 (vx, _mm_sub_epi16 (_mm_setzero_si128 (), vx));
+        vy = _mm_max_epi16 (vy, _mm_sub_epi16 (_mm_setzero_si128 (), vy));
+    }
+    c = _mm_set1_epi32 ((Word32) (((unsigned int) (unsigned short) cy << 16)
+                                  | (unsigned short) cx));
+    a->lo = _mm_add_epi32 (a->lo, _mm_madd_epi16 (_mm_unpacklo_epi16 (vx, vy), c));
+    a->hi = _mm_add_epi32 (a->hi, _mm_madd_epi16 (_mm_unpackhi_epi16 (vx, vy), c));
+}
+
+static inline void Vec32_store (Word32 d[], Vec32 *a)
+{
+    _mm_storeu_si128 ((__m128i *) d, a->lo);
+    _mm_storeu_si128 ((__m128i *) &d[4], a->hi);
+}
+
+typedef struct
+{
+    __m128i dn;             /* dn[] on the track of ib                    */
+    __m128i rv_lo, rv_hi;   /* (rrv[] << sh_v) + 0x8000                   */
+    __m128i sh_r;           /* 16 - sh_r                                  */
+    __m128i c_lo, c_hi;     /* (alp_16, -sq2) of the best of each lane    */
+    __m128i j_lo, j_hi;     /* its row                                    */
+    __m128i a_min;          /* smallest alp_16                            */
+} Row_vec;
+
+static inline void Row_init (Row_vec *r, Word16 dn2[], Word16 rrv[],
+                             Word16 sh_v, Word16 sh_r)
+{
+    __m128i v, c;
+
+    r->dn = _mm_loadu_si128 ((__m128i *) dn2);
+    v = _mm_loadu_si128 ((__m128i *) rrv);
+    c = _mm_cvtsi32_si128 (16 - sh_v);
+    /* x << sh == (x << 16) >> (16 - sh) */
+    r->rv_lo = _mm_add_epi32 (_mm_sra_epi32 (_mm_unpacklo_epi16 (_mm_setzero_si128 (), v), c),
+                              _mm_set1_epi32 (0x8000L));
+    r->rv_hi = _mm_add_epi32 (_mm_sra_epi32 (_mm_unpackhi_epi16 (_mm_setzero_si128 (), v), c),
+                              _mm_set1_epi32 (0x8000L));
+    r->sh_r = _mm_cvtsi32_si128 (16 - sh_r);
+
+    /* sq = -1, alp = 1 */
+    r->c_lo = _mm_set1_epi32 (0x00010001L);
+    r->c_hi = r->c_lo;
+    r->j_lo = _mm_setzero_si128 ();
+    r->j_hi = r->j_lo;
+    r->a_min = _mm_set1_epi16 (MAX_16);
+}
+
+/* row j: a lane takes (sq2, alp_16) when alp * sq2 - sq * alp_16 > 0 */
+static inline void Row_best (Row_vec *r, Word16 ps1, Word32 alp1,
+                             Word16 rr2[], Word16 j)
+{
+    __m128i p, q, a, t0, t1, c;
+
+    p = _mm_adds_epi16 (_mm_set1_epi16 (ps1), r->dn);
+    /* (p * p) >> 15, -32768 * -32768 saturates to 32767 */
+    q = _mm_or_si128 (_mm_slli_epi16 (_mm_mulhi_epi16 (p, p), 1),
+                      _mm_srli_epi16 (_mm_mullo_epi16 (p, p), 15));
+    q = _mm_xor_si128 (q, _mm_cmpeq_epi16 (p, _mm_set1_epi16 (-32768)));
+
+    a = _mm_loadu_si128 ((__m128i *) rr2);
+    t0 = _mm_add_epi32 (_mm_set1_epi32 (alp1), r->rv_lo);
+    t1 = _mm_add_epi32 (_mm_set1_epi32 (alp1), r->rv_hi);
+    t0 = _mm_add_epi32 (t0, _mm_sra_epi32 (_mm_unpacklo_epi16 (_mm_setzero_si128 (), a), r->sh_r));
+    t1 = _mm_add_epi32 (t1, _mm_sra_epi32 (_mm_unpackhi_epi16 (_mm_setzero_si128 (), a), r->sh_r));
+    a = _mm_packs_epi32 (_mm_srai_epi32 (t0, 16), _mm_srai_epi32 (t1, 16));
+    r->a_min = _mm_min_epi16 (r->a_min, a);
+
+    t0 = _mm_cmpgt_epi32 (_mm_madd_epi16 (_mm_unpacklo_epi16 (q, a), r->c_lo), _mm_setzero_si128 ());
+    t1 = _mm_cmpgt_epi32 (_mm_madd_epi16 (_mm_unpackhi_epi16 (q, a), r->c_hi), _mm_setzero_si128 ());
+
+    q = _mm_sub_epi16 (_mm_setzero_si128 (), q);
+    r->c_lo = _mm_or_si128 (_mm_and_si128 (t0, _mm_unpacklo_epi16 (a, q)),
+                            _mm_andnot_si128 (t0, r->c_lo));
+    r->c_hi = _mm_or_si128 (_mm_and_si128 (t1, _mm_unpackhi_epi16 (a, q)),
+                            _mm_andnot_si128 (t1, r->c_hi));
+    c = _mm_set1_epi32 (j);
+    r->j_lo = _mm_or_si128 (_mm_and_si128 (t0, c), _mm_andnot_si128 (t0, r->j_lo));
+    r->j_hi = _mm_or_si128 (_mm_and_si128 (t1, c), _mm_andnot_si128 (t1, r->j_hi));
+}
+
+/* best of each lane in v_sq[], v_alp[], v_j[]; 0 if an alp_16 was <= 0 */
+static inline Word16 Row_get (Row_vec *r, Word16 v_sq[], Word16 v_alp[],
+                              Word16 v_j[])
+{
+    Word16 k, c[2 * NB_POS];
+    Word32 j[NB_POS];
+
+    _mm_storeu_si128 ((__m128i *) c, r->c_lo);
+    _mm_storeu_si128 ((__m128i *) &c[NB_POS], r->c_hi);
+    _mm_storeu_si128 ((__m128i *) j, r->j_lo);
+    _mm_storeu_si128 ((__m128i *) &j[4], r->j_hi);
+    for (k = 0; k < NB_POS; k++)
+    {
+        v_alp[k] = c[2 * k];
+        v_sq[k] = (Word16) -c[2 * k + 1];
+        v_j[k] = (Word16) j[k];
+    }
+    return _mm_movemask_epi8 (_mm_cmpgt_epi16 (r->a_min, _mm_setzero_si128 ())) == 0xffff;
+}
+#else
+typedef struct { int32x4_t lo, hi; } Vec32;
+
+/* a[j] = v */
+static inline void Vec32_set (Vec32 *a, Word32 v)
+{
+    a->lo = vdupq_n_s32 (v);
+    a->hi = a->lo;
+}
+
+/* a[j] += x[j] * cx + y[j] * cy, or |x[j]| * cx + |y[j]| * cy */
+static inline void Vec32_mac2 (Vec32 *a, Word16 x[], Word16 cx,
+                               Word16 y[], Word16 cy, Word16 abs)
+{
+    int16x8_t vx, vy;
+
+    vx = vld1q_s16 (x);
+    vy = vld1q_s16 (y);
+    if (abs)
+    {
+        vx = vabsq_s16 (vx);
+        vy = vabsq_s16 (vy);
+    }
+    a->lo = vmlal_n_s16 (vmlal_n_s16 (a->lo, vget_low_s16 (vx), cx), vget_low_s16 (vy), cy);
+    a->hi = vmlal_n_s16 (vmlal_n_s16 (a->hi, vget_high_s16 (vx), cx), vget_high_s16 (vy), cy);
+}
+
+static inline void Vec32_store (Word32 d[], Vec32 *a)
+{
+    vst1q_s32 (d, a->lo);
+    vst1q_s32 (&d[4], a->hi);
+}
+
+typedef struct
+{
+    int16x8_t dn;           /* dn[] on the track of ib                    */
+    int32x4_t rv_lo, rv_hi; /* (rrv[] << sh_v) + 0x8000                   */
+    int32x4_t sh_r;         /* sh_r                                       */
+    int32x4_t q_lo, q_hi;   /* sq2 of the best of each lane               */
+    int32x4_t a_lo, a_hi;   /* its alp_16                                 */
+    int32x4_t j_lo, j_hi;   /* its row                                    */
+    int16x8_t a_min;        /* smallest alp_16                            */
+} Row_vec;
+
+static inline void Row_init (Row_vec *r, Word16 dn2[], Word16 rrv[],
+                             Word16 sh_v, Word16 sh_r)
+{
+    int16x8_t v;
+
+    r->dn = vld1q_s16 (dn2);
+    v = vld1q_s16 (rrv);
+    r->rv_lo = vaddq_s32 (vshlq_s32 (vmovl_s16 (vget_low_s16 (v)), vdupq_n_s32 (sh_v)),
+                          vdupq_n_s32 (0x8000L));
+    r->rv_hi = vaddq_s32 (vshlq_s32 (vmovl_s16 (vget_high_s16 (v)), vdupq_n_s32 (sh_v)),
+                          vdupq_n_s32 (0x8000L));
+    r->sh_r = vdupq_n_s32 (sh_r);
+
+    /* sq = -1, alp = 1 */
+    r->q_lo = vdupq_n_s32 (-1);
+    r->q_hi = r->q_lo;
+    r->a_lo = vdupq_n_s32 (1);
+    r->a_hi = r->a_lo;
+    r->j_lo = vdupq_n_s32 (0);
+    r->j_hi = r->j_lo;
+    r->a_min = vdupq_n_s16 (MAX_16);
+}
+
+/* row j: a lane takes (sq2, alp_16) when alp * sq2 - sq * alp_16 > 0 */
+static inline void Row_best (Row_vec *r, Word16 ps1, Word32 alp1,
+                             Word16 rr2[], Word16 j)
+{
+    int16x8_t p, q, a;
+    int32x4_t t0, t1, q0, q1, a0, a1;
+    uint32x4_t m0, m1;
+
+    p = vqaddq_s16 (vdupq_n_s16 (ps1), r->dn);
+    q = vqdmulhq_s16 (p, p);
+
+    a = vld1q_s16 (rr2);
+    t0 = vaddq_s32 (vdupq_n_s32 (alp1), r->rv_lo);
+    t1 = vaddq_s32 (vdupq_n_s32 (alp1), r->rv_hi);
+    t0 = vaddq_s32 (t0, vshlq_s32 (vmovl_s16 (vget_low_s16 (a)), r->sh_r));
+    t1 = vaddq_s32 (t1, vshlq_s32 (vmovl_s16 (vget_high_s16 (a)), r->sh_r));
+    a0 = vshrq_n_s32 (t0, 16);
+    a1 = vshrq_n_s32 (t1, 16);
+    r->a_min = vminq_s16 (r->a_min, vcombine_s16 (vmovn_s32 (a0), vmovn_s32 (a1)));
+
+    q0 = vmovl_s16 (vget_low_s16 (q));
+    q1 = vmovl_s16 (vget_high_s16 (q));
+    m0 = vcgtq_s32 (vmlsq_s32 (vmulq_s32 (q0, r->a_lo), a0, r->q_lo), vdupq_n_s32 (0));
+    m1 = vcgtq_s32 (vmlsq_s32 (vmulq_s32 (q1, r->a_hi), a1, r->q_hi), vdupq_n_s32 (0));
+
+    r->q_lo = vbslq_s32 (m0, q0, r->q_lo);
+    r->q_hi = vbslq_s32 (m1, q1, r->q_hi);
+    r->a_lo = vbslq_s32 (m0, a0, r->a_lo);
+    r->a_hi = vbslq_s32 (m1, a1, r->a_hi);
+    r->j_lo = vbslq_s32 (m0, vdupq_n_s32 (j), r->j_lo);
+    r->j_hi = vbslq_s32 (m1, vdupq_n_s32 (j), r->j_hi);
+}
+
+/* best of each lane in v_sq[], v_alp[], v_j[]; 0 if an alp_16 was <= 0 */
+static inline Word16 Row_get (Row_vec *r, Word16 v_sq[], Word16 v_alp[],
+                              Word16 v_j[])
+{
+    vst1q_s16 (v_sq, vcombine_s16 (vmovn_s32 (r->q_lo), vmovn_s32 (r->q_hi)));
+    vst1q_s16 (v_alp, vcombine_s16 (vmovn_s32 (r->a_lo), vmovn_s32 (r->a_hi)));
+    vst1q_s16 (v_j, vcombine_s16 (vmovn_s32 (r->j_lo), vmovn_s32 (r->j_hi)));
+    return vminvq_s16 (r->a_min) > 0;
+}
+#endif
+
+/* s[j] = sum of rr_d[t][j] * c_d and rr[ip[k]][t][j] * c, k = 0..n-1 */
+static inline void Sum_track (Word32 s[], Word16 rr[][NB_TRACK][NB_POS],
+                              Word16 rr_d[], Word16 ip[], Word16 n,
+                              Word16 t, Word16 c_d, Word16 c, Word16 abs)
+{
+    Word16 k;
+    Vec32 a;
+
+    Vec32_set (&a, 0);
+    Vec32_mac2 (&a, rr_d, c_d, rr[ip[0]][t], c, abs);
+    for (k = 1; k < n - 1; k += 2)
+    {
+        Vec32_mac2 (&a, rr[ip[k]][t], c, rr[ip[k + 1]][t], c, abs);
+    }
+    Vec32_mac2 (&a, rr[ip[n - 1]][t], c, rr_d, 0, abs);
+    Vec32_store (s, &a);
+}
+
+static void search_pair_vec (
+    Word16 n,                      /* (i)   : number of pulses placed     */
+    Word16 dn[][NB_POS],           /* (i)   : dn[] by track               */
+    Word16 rr[][NB_TRACK][NB_POS], /* (i)   : matrix of autocorrelation   */
+    Word16 rr_d[][NB_POS],         /* (i)   : rr[i][i] by track           */
+    Word16 ipos[],                 /* (i)   : starting position of pulses */
+    Word16 ip[],                   /* (i/o) : pulse positions             */
+    Word16 *ps0,                   /* (i/o) : correlation of ip[0..n-1],  */
+                                   /*         then of ip[0..n+1]          */
+    Word32 *alp0,                  /* (i/o) : energy of ip[0..n-1], then  */
+                                   /*         of ip[0..n+1] * 0.5         */
+    Word16 *sq,                    /* (o)   : correlation square          */
+    Word16 *alp                    /* (o)   : energy of ip[0..n+1]        */
+)
+{
+    Word16 j, k, ta, tb, ia, ib, jb, ps, sh_v, sh_r;
+    Word16 rrv[NB_POS], v_sq[NB_POS], v_alp[NB_POS], v_j[NB_POS];
+    const Word16 *w;
+    Word32 s, lim, v_s[NB_POS], v_b[NB_POS], alp1[NB_POS];
+    Row_vec row;
+
+    w = w_pair[(n >> 1) - 1];
+    ta = ipos[n];
+    tb = ipos[n + 1];
+
+    Sum_track (v_s, rr, rr_d[tb], ip, n, tb, w[0], w[1], 0);
+    Sum_track (v_b, rr, rr_d[tb], ip, n, tb, w[0], w[1], 1);
+    for (j = 0; j < NB_POS; j++)
+    {
+        if (v_b[j] <= ((MAX_32 - 0x8000L) >> 1))
+        {
+            rrv[j] = (Word16) ((v_s[j] * 2 + 0x8000L) >> 16);
+        }
+        else
+        {
+            s = efr_L_mult (rr_d[tb][j], w[0]);
+            for (k = 0; k < n; k++)
+            {
+                s = efr_L_mac (s, rr[ip[k]][tb][j], w[1]);
+            }
+            rrv[j] = gsm_efr_round (s);
+        }
+    }
+
+    Sum_track (v_s, rr, rr_d[ta], ip, n, ta, w[2], w[3], 0);
+    for (j = 0; j < NB_POS; j++)
+    {
+        alp1[j] = *alp0 + v_s[j] * 2;
+    }
+
+    /* rrv[] * c_v * 2 == rrv[] << sh_v, rr[ia][] * c_r * 2 == rr[ia][] << sh_r */
+    sh_v = 15 - efr_norm_s (w[4]);
+    sh_r = 15 - efr_norm_s (w[5]);
+    lim = (1L << (sh_v + 15)) + (1L << (sh_r + 15));
+
+    for (j = 0; j < NB_POS; j++)
+    {
+        if ((alp1[j] > MAX_32 - 0x8000L - lim) || (alp1[j] < MIN_32 + lim))
+        {
+            break;
+        }
+    }
+    if (j == NB_POS)
+    {
+        Row_init (&row, dn[tb], rrv, sh_v, sh_r);
+        for (j = 0; j < NB_POS; j++)
+        {
+            Row_best (&row, efr_add (*ps0, dn[ta][j]), alp1[j],
+                      rr[ta + j * STEP][tb], j);
+        }
+        if (Row_get (&row, v_sq, v_alp, v_j))
+        {
+            /* first row, then first lane, of the largest ratio */
+            jb = 0;
+            for (k = 1; k < NB_POS; k++)
+            {
+                s = (Word32) v_sq[k] * v_alp[jb] - (Word32) v_sq[jb] * v_alp[k];
+                if ((s > 0) || ((s == 0) && (v_j[k] < v_j[jb])))
+                {
+                    jb = k;
+                }
+            }
+            j = v_j[jb];
+            ip[n] = ta + j * STEP;
+            ip[n + 1] = tb + jb * STEP;
+            *ps0 = efr_add (efr_add (*ps0, dn[ta][j]), dn[tb][jb]);
+            *sq = v_sq[jb];
+            *alp = v_alp[jb];
+            *alp0 = efr_L_mult (*alp, _1_2);
+            return;
+        }
+    }
+
+    *sq = -1;
+    *alp = 1;
+    ps = 0;
+    ia = ta;
+    ib = tb;
+
+    for (j = 0; j < NB_POS; j++)
+    {
+        jb = search_row (efr_add (*ps0, dn[ta][j]), alp1[j], dn[tb], rrv,
+                         rr[ta + j * STEP][tb], w[4], w[5], sq, &ps, alp);
+        if (jb >= 0)
+        {
+            ia = ta + j * STEP;
+            ib = tb + jb * STEP;
+        }
+    }
+    ip[n] = ia;
+    ip[n + 1] = ib;
+    *ps0 = ps;
+    *alp0 = efr_L_mult (*alp, _1_2);
+}
+#endif
+
 void search_10i40 (
     Word16 dn[],         /* (i) : correlation between target and h[]        */
-    Word16 rr[][L_CODE], /* (i) : matrix of autocorrelation                 */
+    Word16 rr[][NB_TRACK][NB_POS], /* (i) : matrix of autocorrelation       */
     Word16 ipos[],       /* (i) : starting position for each pulse          */
     Word16 pos_max[],    /* (i) : position of maximum of dn[]               */
     Word16 codvec[]      /* (o) : algebraic codebook vector                 */
 )
 {
-    Word16 i0, i1, i2, i3, i4, i5, i6, i7, i8, i9;
-    Word16 i, j, k, pos, ia, ib;
-    Word16 psk, ps, ps0, ps1, ps2, sq, sq2;
-    Word16 alpk, alp, alp_16;
-    Word16 rrv[L_CODE];
-    Word32 s, alp0, alp1, alp2;
+    Word16 i0, i1, ip[NB_PULSE];
+    Word16 i, j, k, n, pos;
+    Word16 psk, ps0, sq;
+    Word16 alpk, alp;
+    Word16 dn_t[NB_TRACK][NB_POS], rr_d[NB_TRACK][NB_POS];
+    Word32 s, alp0;
+
+    /* dn[] by track: dn_t[k][j] = dn[k + j * STEP] */
+
+    for (i = 0; i < L_CODE; i++)
+    {
+        dn_t[i % STEP][i / STEP] = dn[i];        move16 ();
+        rr_d[i % STEP][i / STEP] = rr[i][i % STEP][i / STEP];  move16 ();
+    }
 
     /* fix i0 on maximum of correlation position */
 
@@ -422,312 +1086,35 @@ void search_10i40 (
     {
         i1 = pos_max[ipos[1]];                   move16 (); 
         ps0 = efr_add (dn[i0], dn[i1]);
-        alp0 = efr_L_mult (rr[i0][i0], _1_16);
-        alp0 = efr_L_mac (alp0, rr[i1][i1], _1_16);
-        alp0 = efr_L_mac (alp0, rr[i0][i1], _1_8);
-        
-        /*----------------------------------------------------------------*
-         * i2 and i3 loop:                                                *
-         *----------------------------------------------------------------*/
-        
-        /* initialize 4 indices for next loop. */
-        move16 (); /* initialize "rr[i3][i3]" pointer */
-        move16 (); /* initialize "rr[i0][i3]" pointer */
-        move16 (); /* initialize "rr[i1][i3]" pointer */
-        move16 (); /* initialize "rrv[i3]" pointer    */
-        
-        for (i3 = ipos[3]; i3 < L_CODE; i3 += STEP)
-        {
-            s = efr_L_mult (rr[i3][i3], _1_8);       /* index incr= STEP+L_CODE */
-            s = efr_L_mac (s, rr[i0][i3], _1_4);     /* index increment = STEP  */
-            s = efr_L_mac (s, rr[i1][i3], _1_4);     /* index increment = STEP  */
-            rrv[i3] = gsm_efr_round (s);                 move16 (); 
-        }
-        
-        /* Default value */
-        sq = -1;                                 move16 (); 
-        alp = 1;                                 move16 (); 
-        ps = 0;                                  move16 ();
-        ia = ipos[2];                            move16 ();
-        ib = ipos[3];                            move16 ();
-        
-        /* initialize 4 indices for i2 loop. */
-        move16 (); /* initialize "dn[i2]" pointer     */
-        move16 (); /* initialize "rr[i2][i2]" pointer */
-        move16 (); /* initialize "rr[i0][i2]" pointer */
-        move16 (); /* initialize "rr[i1][i2]" pointer */
-        
-        for (i2 = ipos[2]; i2 < L_CODE; i2 += STEP)
-        {
-            /* index increment = STEP  */            
-            ps1 = efr_add (ps0, dn[i2]);    
-            
-            /* index incr= STEP+L_CODE */
-            alp1 = efr_L_mac (alp0, rr[i2][i2], _1_16);
-            /* index increment = STEP  */
-            alp1 = efr_L_mac (alp1, rr[i0][i2], _1_8);
-            /* index increment = STEP  */
-            alp1 = efr_L_mac (alp1, rr[i1][i2], _1_8);
-            
-            /* initialize 3 indices for i3 inner loop */
-            move16 (); /* initialize "dn[i3]" pointer     */
-            move16 (); /* initialize "rrv[i3]" pointer    */
-            move16 (); /* initialize "rr[i2][i3]" pointer */
-            
-            for (i3 = ipos[3]; i3 < L_CODE; i3 += STEP)
-            {
-                /* index increment = STEP */                
-                ps2 = efr_add (ps1, dn[i3]);    
-                
-                /* index increment = STEP */
-                alp2 = efr_L_mac (alp1, rrv[i3], _1_2);
-                /* index increment = STEP */
-                alp2 = efr_L_mac (alp2, rr[i2][i3], _1_8);
-                
-                sq2 = efr_mult (ps2, ps2);
+        alp0 = efr_L_mult (rr[i0][i0 % STEP][i0 / STEP], _1_16);
+        alp0 = efr_L_mac (alp0, rr[i1][i1 % STEP][i1 / STEP], _1_16);
+        alp0 = efr_L_mac (alp0, rr[i0][i1 % STEP][i1 / STEP], _1_8);
+        ip[0] = i0;                              move16 ();
+        ip[1] = i1;                              move16 ();
 
-                alp_16 = gsm_efr_round (alp2);
-                
-                s = efr_L_msu (efr_L_mult (alp, sq2), sq, alp_16);
-                
-                test (); 
-                if (s > 0)
-                {
-                    sq = sq2;                    move16 (); 
-                    ps = ps2;                    move16 (); 
-                    alp = alp_16;                move16 (); 
-                    ia = i2;                     move16 (); 
-                    ib = i3;                     move16 (); 
-                }
-            }
-        }
-        i2 = ia;                                 move16 (); 
-        i3 = ib;                                 move16 (); 
-        
         /*----------------------------------------------------------------*
-         * i4 and i5 loop:                                                *
+         * i2 and i3, i4 and i5, i6 and i7, i8 and i9 loops:              *
          *----------------------------------------------------------------*/
-        
-        ps0 = ps;                                move16 (); 
-        alp0 = efr_L_mult (alp, _1_2);
-        
-        /* initialize 6 indices for next loop (see i2-i3 loop) */
-        move16 (); move16 (); move16 (); move16 (); move16 (); move16 (); 
-        
-        for (i5 = ipos[5]; i5 < L_CODE; i5 += STEP)
-        {
-            s = efr_L_mult (rr[i5][i5], _1_8);
-            s = efr_L_mac (s, rr[i0][i5], _1_4);
-            s = efr_L_mac (s, rr[i1][i5], _1_4);
-            s = efr_L_mac (s, rr[i2][i5], _1_4);
-            s = efr_L_mac (s, rr[i3][i5], _1_4);
-            rrv[i5] = gsm_efr_round (s);                 move16 (); 
-        }
-        
-        /* Default value */
-        sq = -1;                                 move16 (); 
-        alp = 1;                                 move16 (); 
-        ps = 0;                                  move16 ();
-        ia = ipos[4];                            move16 ();
-        ib = ipos[5];                            move16 ();
-        
-        /* initialize 6 indices for i4 loop (see i2-i3 loop) */
-        move16 (); move16 (); move16 (); move16 (); move16 (); move16 (); 
-        
-        for (i4 = ipos[4]; i4 < L_CODE; i4 += STEP)
+
+#ifdef VEC_KERNELS
+        if (search_mode != SEARCH_REFERENCE)
         {
-            ps1 = efr_add (ps0, dn[i4]);
-            
-            alp1 = efr_L_mac (alp0, rr[i4][i4], _1_32);
-            alp1 = efr_L_mac (alp1, rr[i0][i4], _1_16);
-            alp1 = efr_L_mac (alp1, rr[i1][i4], _1_16);
-            alp1 = efr_L_mac (alp1, rr[i2][i4], _1_16);
-            alp1 = efr_L_mac (alp1, rr[i3][i4], _1_16);
-            
-            /* initialize 3 indices for i5 inner loop (see i2-i3 loop) */
-            move16 (); move16 (); move16 (); 
-            
-            for (i5 = ipos[5]; i5 < L_CODE; i5 += STEP)
+            for (n = 2; n < NB_PULSE; n += 2)
             {
-                ps2 = efr_add (ps1, dn[i5]);
-                
-                alp2 = efr_L_mac (alp1, rrv[i5], _1_4);
-                alp2 = efr_L_mac (alp2, rr[i4][i5], _1_16);
-                
-                sq2 = efr_mult (ps2, ps2);
-                
-                alp_16 = gsm_efr_round (alp2);
-                
-                s = efr_L_msu (efr_L_mult (alp, sq2), sq, alp_16);
-                
-                test (); 
-                if (s > 0)
-                {
-                    sq = sq2;                    move16 (); 
-                    ps = ps2;                    move16 (); 
-                    alp = alp_16;                move16 (); 
-                    ia = i4;                     move16 (); 
-                    ib = i5;                     move16 (); 
-                }
+                search_pair_vec (n, dn_t, rr, rr_d, ipos, ip, &ps0, &alp0,
+                                 &sq, &alp);
             }
         }
-        i4 = ia;                                 move16 (); 
-        i5 = ib;                                 move16 (); 
-        
-        /*----------------------------------------------------------------*
-         * i6 and i7 loop:                                                *
-         *----------------------------------------------------------------*/
-        
-        ps0 = ps;                                move16 (); 
-        alp0 = efr_L_mult (alp, _1_2);
-        
-        /* initialize 8 indices for next loop (see i2-i3 loop) */
-        move16 (); move16 (); move16 (); move16 (); 
-        move16 (); move16 (); move16 (); move16 (); 
-        
-        for (i7 = ipos[7]; i7 < L_CODE; i7 += STEP)
-        {
-            s = efr_L_mult (rr[i7][i7], _1_16);
-            s = efr_L_mac (s, rr[i0][i7], _1_8);
-            s = efr_L_mac (s, rr[i1][i7], _1_8);
-            s = efr_L_mac (s, rr[i2][i7], _1_8);
-            s = efr_L_mac (s, rr[i3][i7], _1_8);
-            s = efr_L_mac (s, rr[i4][i7], _1_8);
-            s = efr_L_mac (s, rr[i5][i7], _1_8);
-            rrv[i7] = gsm_efr_round (s);                 move16 (); 
-        }
-        
-        /* Default value */
-        sq = -1;                                 move16 (); 
-        alp = 1;                                 move16 (); 
-        ps = 0;                                  move16 ();
-        ia = ipos[6];                            move16 ();
-        ib = ipos[7];                            move16 ();
-        
-        /* initialize 8 indices for i6 loop (see i2-i3 loop) */
-        move16 (); move16 (); move16 (); move16 (); 
-        move16 (); move16 (); move16 (); move16 (); 
-        
-        for (i6 = ipos[6]; i6 < L_CODE; i6 += STEP)
-        {
-            ps1 = efr_add (ps0, dn[i6]);
-            
-            alp1 = efr_L_mac (alp0, rr[i6][i6], _1_64);
-            alp1 = efr_L_mac (alp1, rr[i0][i6], _1_32);
-            alp1 = efr_L_mac (alp1, rr[i1][i6], _1_32);
-            alp1 = efr_L_mac (alp1, rr[i2][i6], _1_32);
-            alp1 = efr_L_mac (alp1, rr[i3][i6], _1_32);
-            alp1 = efr_L_mac (alp1, rr[i4][i6], _1_32);
-            alp1 = efr_L_mac (alp1, rr[i5][i6], _1_32);
-            
-            /* initialize 3 indices for i7 inner loop (see i2-i3 loop) */
-            move16 (); move16 (); move16 (); 
-            
-            for (i7 = ipos[7]; i7 < L_CODE; i7 += STEP)
-            {
-                ps2 = efr_add (ps1, dn[i7]);
-                
-                alp2 = efr_L_mac (alp1, rrv[i7], _1_4);
-                alp2 = efr_L_mac (alp2, rr[i6][i7], _1_32);
-                
-                sq2 = efr_mult (ps2, ps2);
-                
-                alp_16 = gsm_efr_round (alp2);
-                
-                s = efr_L_msu (efr_L_mult (alp, sq2), sq, alp_16);
-                
-                test (); 
-                if (s > 0)
-                {
-                    sq = sq2;                    move16 (); 
-                    ps = ps2;                    move16 (); 
-                    alp = alp_16;                move16 (); 
-                    ia = i6;                     move16 (); 
-                    ib = i7;                     move16 (); 
-                }
-            }
-        }
-        i6 = ia;                                 move16 (); 
-        i7 = ib;                                 move16 (); 
-        
-        /*----------------------------------------------------------------*
-         * i8 and i9 loop:                                                *
-         *----------------------------------------------------------------*/
-        
-        ps0 = ps;                                move16 (); 
-        alp0 = efr_L_mult (alp, _1_2);
-        
-        /* initialize 10 indices for next loop (see i2-i3 loop) */
-        move16 (); move16 (); move16 (); move16 (); move16 (); 
-        move16 (); move16 (); move16 (); move16 (); move16 (); 
-        
-        for (i9 = ipos[9]; i9 < L_CODE; i9 += STEP)
-        {
-            s = efr_L_mult (rr[i9][i9], _1_16);
-            s = efr_L_mac (s, rr[i0][i9], _1_8);
-            s = efr_L_mac (s, rr[i1][i9], _1_8);
-            s = efr_L_mac (s, rr[i2][i9], _1_8);
-            s = efr_L_mac (s, rr[i3][i9], _1_8);
-            s = efr_L_mac (s, rr[i4][i9], _1_8);
-            s = efr_L_mac (s, rr[i5][i9], _1_8);
-            s = efr_L_mac (s, rr[i6][i9], _1_8);
-            s = efr_L_mac (s, rr[i7][i9], _1_8);
-            rrv[i9] = gsm_efr_round (s);                 move16 (); 
-        }
-        
-        /* Default value */
-        sq = -1;                                 move16 (); 
-        alp = 1;                                 move16 (); 
-        ps = 0;                                  move16 ();
-        ia = ipos[8];                            move16 ();
-        ib = ipos[9];                            move16 ();
-        
-        /* initialize 10 indices for i8 loop (see i2-i3 loop) */
-        move16 (); move16 (); move16 (); move16 (); move16 (); 
-        move16 (); move16 (); move16 (); move16 (); move16 (); 
-        
-        for (i8 = ipos[8]; i8 < L_CODE; i8 += STEP)
+        else
+#endif
         {
-            ps1 = efr_add (ps0, dn[i8]);
-            
-            alp1 = efr_L_mac (alp0, rr[i8][i8], _1_128);
-            alp1 = efr_L_mac (alp1, rr[i0][i8], _1_64);
-            alp1 = efr_L_mac (alp1, rr[i1][i8], _1_64);
-            alp1 = efr_L_mac (alp1, rr[i2][i8], _1_64);
-            alp1 = efr_L_mac (alp1, rr[i3][i8], _1_64);
-            alp1 = efr_L_mac (alp1, rr[i4][i8], _1_64);
-            alp1 = efr_L_mac (alp1, rr[i5][i8], _1_64);
-            alp1 = efr_L_mac (alp1, rr[i6][i8], _1_64);
-            alp1 = efr_L_mac (alp1, rr[i7][i8], _1_64);
-            
-            /* initialize 3 indices for i9 inner loop (see i2-i3 loop) */
-            move16 (); move16 (); move16 (); 
-            
-            for (i9 = ipos[9]; i9 < L_CODE; i9 += STEP)
-            {
-                ps2 = efr_add (ps1, dn[i9]);
-                
-                alp2 = efr_L_mac (alp1, rrv[i9], _1_8);
-                alp2 = efr_L_mac (alp2, rr[i8][i9], _1_64);
-                
-                sq2 = efr_mult (ps2, ps2);
-                
-                alp_16 = gsm_efr_round (alp2);
-                
-                s = efr_L_msu (efr_L_mult (alp, sq2), sq, alp_16);
-                
-                test (); 
-                if (s > 0)
-                {
-                    sq = sq2;                    move16 (); 
-                    ps = ps2;                    move16 (); 
-                    alp = alp_16;                move16 (); 
-                    ia = i8;                     move16 (); 
-                    ib = i9;                     move16 (); 
-                }
-            }
+            /* n is a constant in each call for the weights to fold */
+            search_pair (2, dn_t, rr, rr_d, ipos, ip, &ps0, &alp0, &sq, &alp);
+            search_pair (4, dn_t, rr, rr_d, ipos, ip, &ps0, &alp0, &sq, &alp);
+            search_pair (6, dn_t, rr, rr_d, ipos, ip, &ps0, &alp0, &sq, &alp);
+            search_pair (8, dn_t, rr, rr_d, ipos, ip, &ps0, &alp0, &sq, &alp);
         }
-        
+
         /*----------------------------------------------------------------*
          * memorise codevector if this one is better than the last one.   *
          *----------------------------------------------------------------*/
@@ -739,16 +1126,10 @@ void search_10i40 (
         {
             psk = sq;                            move16 (); 
             alpk = alp;                          move16 (); 
-            codvec[0] = i0;                      move16 (); 
-            codvec[1] = i1;                      move16 (); 
-            codvec[2] = i2;                      move16 (); 
-            codvec[3] = i3;                      move16 (); 
-            codvec[4] = i4;                      move16 (); 
-            codvec[5] = i5;                      move16 (); 
-            codvec[6] = i6;                      move16 (); 
-            codvec[7] = i7;                      move16 (); 
-            codvec[8] = ia;                      move16 (); 
-            codvec[9] = ib;                      move16 (); 
+            for (k = 0; k < NB_PULSE; k++)
+            {
+                codvec[k] = ip[k];               move16 ();
+            }
         }
         /*----------------------------------------------------------------*
          * Cyclic permutation of i1,i2,i3,i4,i5,i6,i7,i8 and i9.          *
@@ -760,7 +1141,7 @@ void search_10i40 (
             ipos[j] = ipos[k];                   move16 (); 
         }
         ipos[NB_PULSE - 1] = pos;                move16 (); 
-}
+    }
 }
 
 /*************************************************************************
@@ -35,6 +35,14 @@ void code_10i40_35bits (
     Word16 y[],        /* (o)   : filtered fixed codebook excitation        */
     Word16 indx[]      /* (o)   : index of 10 pulses (sign + position)      */
 );
+
+/* kernels of the codebook search in code_10i40_35bits () */
+#define SEARCH_REFERENCE 0 /* reference C code                             */
+#define SEARCH_EXACT     1 /* SSE2 / NEON, bit exact (default)             */
+Word16 Set_search_10i40_mode ( /* (o) : mode in use, SEARCH_REFERENCE
+                                        without SSE2 / NEON                */
+    Word16 mode        /* (i)   : SEARCH_REFERENCE or SEARCH_EXACT          */
+);
 void dec_10i40_35bits (
     Word16 index[],    /* (i)   : index of 10 pulses (sign+position)        */
     Word16 cod[]       /* (o)   : algebraic (fixed) codebook excitation     */
@@ -171,6 +179,14 @@ void Prm2bits_12k2 (
     Word16 prm[],      /* input : analysis parameters                       */
     Word16 bits[]      /* output: serial bits                               */
 );
+void Bytes2prm_12k2 (
+    unsigned char bytes[], /* input : serial bits packed in 31 bytes        */
+    Word16 prm[]           /* output: analysis parameters                   */
+);
+void Prm2bytes_12k2 (
+    Word16 prm[],          /* input : analysis parameters                   */
+    unsigned char bytes[]  /* output: serial bits packed in 31 bytes        */
+);
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
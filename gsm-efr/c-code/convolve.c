@@ -12,11 +12,64 @@
  *
  *          y[n] = sum_{i=0}^{n} x[i] h[n-i],        n=0,...,L-1
  *
+ *     With SSE2 / NEON, blocks of 8 output samples are computed in the
+ *     vector lanes when the L_mac chains can not saturate (see vec_op.h).
+ *
  *************************************************************************/
 
 #include "typedef.h"
 #include "basic_op.h"
 #include "count.h"
+#include "cnst.h"
+#include "vec_op.h"
+
+#ifdef VEC_KERNELS
+/* s[n] = sum_{i=0}^{n} x[i] * h[n - i], n = 0..L-1, L multiple of 8 */
+static void Convolve_sum (Word16 x[], Word16 h[], Word32 s[], Word16 L) {
+    Word16 i, n;
+    Word16 hz[8 + L_SUBFR];     /* h[] behind 8 zeros, hz[8 + k] = h[k] */
+#ifdef VEC_SSE2
+    __m128i c, h0, h1, acc0, acc1;
+#else
+    int32x4_t acc0, acc1;
+#endif
+
+    for (i = 0; i < 8; i++) {
+        hz[i] = 0;
+    }
+    for (i = 0; i < L; i++) {
+        hz[8 + i] = h[i];
+    }
+
+    /* lane k of block n adds x[i] * h[n + k - i] for i = 0..n+7, the
+       terms with i > n + k read the zeros in front of h[] */
+    for (n = 0; n < L; n += 8) {
+#ifdef VEC_SSE2
+        acc0 = _mm_setzero_si128 ();
+        acc1 = _mm_setzero_si128 ();
+        for (i = 0; i < n + 8; i += 2) {
+            c = _mm_unpacklo_epi16 (_mm_set1_epi16 (x[i]), _mm_set1_epi16 (x[i + 1]));
+            h0 = _mm_loadu_si128 ((__m128i *) &hz[8 + n - i]);
+            h1 = _mm_loadu_si128 ((__m128i *) &hz[8 + n - i - 1]);
+            acc0 = _mm_add_epi32 (acc0, _mm_madd_epi16 (_mm_unpacklo_epi16 (h0, h1), c));
+            acc1 = _mm_add_epi32 (acc1, _mm_madd_epi16 (_mm_unpackhi_epi16 (h0, h1), c));
+        }
+        _mm_storeu_si128 ((__m128i *) &s[n], acc0);
+        _mm_storeu_si128 ((__m128i *) &s[n + 4], acc1);
+#else
+        acc0 = vdupq_n_s32 (0);
+        acc1 = vdupq_n_s32 (0);
+        for (i = 0; i < n + 8; i++) {
+            acc0 = vmlal_n_s16 (acc0, vld1_s16 (&hz[8 + n - i]), x[i]);
+            acc1 = vmlal_n_s16 (acc1, vld1_s16 (&hz[8 + n - i + 4]), x[i]);
+        }
+        vst1q_s32 (&s[n], acc0);
+        vst1q_s32 (&s[n + 4], acc1);
+#endif
+    }
+    return;
+}
+#endif
 
 void Convolve (
     Word16 x[],        /* (i)     : input vector                           */
@@ -26,6 +79,19 @@ void Convolve (
 ) {
     Word16 i, n;
     Word32 s;
+#ifdef VEC_KERNELS
+    Word32 L_s[L_SUBFR];
+
+    if ((L <= L_SUBFR) && ((L & 7) == 0)
+        && Mac_fits (Max_abs (x, L), Sum_abs (h, L))) {
+        Convolve_sum (x, h, L_s, L);
+        for (n = 0; n < L; n++) {
+            s = efr_L_shl (L_s[n] * 2, 3);
+            y[n] = efr_extract_h (s);
+        }
+        return;
+    }
+#endif
 
     for (n = 0; n < L; n++) {
         s = 0;                  move32 ();
@@ -53,25 +53,27 @@ Word32 DeltaWeightedOperation () {
   return (delta);
 }
 
+#if (WMOPS)
 void move16 (void) {
-  // counter.DataMove16++;
+  counter.DataMove16++;
 }
 
 void move32 (void) {
-  // counter.DataMove32++;
+  counter.DataMove32++;
 }
 
 void test (void) {
-  // counter.Test++;
+  counter.Test++;
 }
 
 void logic16 (void) {
-  // counter.Logic16++;
+  counter.Logic16++;
 }
 
 void logic32 (void) {
-  // counter.Logic32++;
+  counter.Logic32++;
 }
+#endif
 
 void Init_WMOPS_counter (void) {
   Word16 i;
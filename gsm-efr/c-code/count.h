@@ -1,3 +1,6 @@
+#ifndef COUNT_H
+#define COUNT_H
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -56,11 +59,23 @@ void Reset_WMOPS_counter (void);
 void WMOPS_output (Word16 dtx_mode);
 Word32 fwc (void);
 
+/* The data move, logic and test counters are only called with WMOPS,
+   otherwise they expand to nothing instead of an empty call. */
+#if (WMOPS)
 void move16 (void);
 void move32 (void);
 void logic16 (void);
 void logic32 (void);
 void test (void);
+#else
+#define move16()  ((void) 0)
+#define move32()  ((void) 0)
+#define logic16() ((void) 0)
+#define logic32() ((void) 0)
+#define test()    ((void) 0)
+#endif
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
+
+#endif
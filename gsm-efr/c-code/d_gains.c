@@ -40,7 +40,7 @@ Word16 gcode0_CN, gain_code_old_CN, gain_code_new_CN, gain_code_muting_CN;
 /* past quantized energies.      */
 /* initialized to -14.0/constant, constant = 20*Log10(2) */
 
-Word16 past_qua_en[4];
+Word16 past_qua_en_rx[4];
 
 /* MA prediction coeff   */
 Word16 pred[4];
@@ -261,7 +261,7 @@ void d_gain_code (
             /* reset table of past quantized energies */
             for (i = 0; i < 4; i++)
             {
-                past_qua_en[i] = -2381;                        move16 (); 
+                past_qua_en_rx[i] = -2381;                     move16 (); 
             }
         }
 
@@ -309,7 +309,7 @@ void d_gain_code (
         av_pred_en = 0;                                        move16 (); 
         for (i = 0; i < 4; i++)
         {
-            av_pred_en = efr_add (av_pred_en, past_qua_en[i]);
+            av_pred_en = efr_add (av_pred_en, past_qua_en_rx[i]);
         }
 
         /* av_pred_en = 0.25*av_pred_en - 4/(20Log10(2)) */
@@ -323,9 +323,9 @@ void d_gain_code (
         }
         for (i = 3; i > 0; i--)
         {
-            past_qua_en[i] = past_qua_en[i - 1];               move16 (); 
+            past_qua_en_rx[i] = past_qua_en_rx[i - 1];         move16 (); 
         }
-        past_qua_en[0] = av_pred_en;                           move16 (); 
+        past_qua_en_rx[0] = av_pred_en;                        move16 (); 
         for (i = 1; i < 5; i++)
         {
             gbuf[i - 1] = gbuf[i];                             move16 (); 
@@ -386,7 +386,7 @@ void d_gain_code (
         ener = MEAN_ENER;                                      move32 (); 
         for (i = 0; i < 4; i++)
         {
-            ener = efr_L_mac (ener, past_qua_en[i], pred[i]);
+            ener = efr_L_mac (ener, past_qua_en_rx[i], pred[i]);
         }
 
         /*-------------------------------------------------------------------*
@@ -418,19 +418,19 @@ void d_gain_code (
         /*-------------------------------------------------------------------*
          *  update table of past quantized energies                           *
          *  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~                           *
-         *  past_qua_en      = 20 * Log10(qua_gain_code) / constant           *
+         *  past_qua_en_rx   = 20 * Log10(qua_gain_code) / constant           *
          *                   = Log2(qua_gain_code)                            *
          *                                           constant = 20*Log10(2)   *
          *-------------------------------------------------------------------*/
 
         for (i = 3; i > 0; i--)
         {
-            past_qua_en[i] = past_qua_en[i - 1];               move16 (); 
+            past_qua_en_rx[i] = past_qua_en_rx[i - 1];         move16 (); 
         }
         Log2 (efr_L_deposit_l (qua_gain_code[index]), &exp, &frac);
 
-        past_qua_en[0] = efr_shr (frac, 5);                        move16 (); 
-        past_qua_en[0] = efr_add (past_qua_en[0], efr_shl (efr_sub (exp, 11), 10));
+        past_qua_en_rx[0] = efr_shr (frac, 5);                     move16 (); 
+        past_qua_en_rx[0] = efr_add (past_qua_en_rx[0], efr_shl (efr_sub (exp, 11), 10));
         move16 (); 
 
         update_gain_code_history_rx (*gain_code, gain_code_old_rx);
@@ -454,7 +454,7 @@ void d_gain_code (
 
             for (i = 0; i < 4; i++)
             {
-                past_qua_en[i] = -2381;                        move16 (); 
+                past_qua_en_rx[i] = -2381;                     move16 (); 
             }
         }
         test (); test (); logic16 (); 
@@ -230,12 +230,12 @@ void decoder_reset (void)
     extern Word16 gain_code_muting_CN;
 
     /* Memories of gain dequantization: */
-    extern Word16 past_qua_en[4], pred[4];
+    extern Word16 past_qua_en_rx[4], pred[4];
 
     /* variables defined in d_plsf_5.c */
     /* ------------------------------ */
     /* Past quantized prediction error */
-    extern Word16 past_r2_q[M];
+    extern Word16 past_r2_q_rx[M];
 
     /* Past dequantized lsfs */
     extern Word16 past_lsf_q[M];
@@ -286,7 +286,7 @@ void decoder_reset (void)
 
     for (i = 0; i < 4; i++)
     {
-        past_qua_en[i] = -2381; /* past quantized energies */
+        past_qua_en_rx[i] = -2381; /* past quantized energies */
     }
 
     pred[0] = 44;               /* MA prediction coeff */
@@ -297,7 +297,7 @@ void decoder_reset (void)
     /* Variables in d_plsf_5.c: */
     for (i = 0; i < M; i++)
     {
-        past_r2_q[i] = 0;               /* Past quantized prediction error */
+        past_r2_q_rx[i] = 0;            /* Past quantized prediction error */
         past_lsf_q[i] = mean_lsf[i];    /* Past dequantized lsfs */
         lsf_p_CN[i] = mean_lsf[i];      /* CNI */
         lsf_new_CN[i] = mean_lsf[i];    /* CNI */
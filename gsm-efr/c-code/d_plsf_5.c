@@ -38,7 +38,7 @@
 
 /* Past quantized prediction error */
 
-Word16 past_r2_q[M];
+Word16 past_r2_q_rx[M];
 
 /* Past dequantized lsfs */
 
@@ -103,7 +103,7 @@ void D_plsf_5 (
             {
                 lsf_old_CN[i] = lsf_new_CN[i];  move16 (); 
                 lsf2_q[i] = lsf_new_CN[i];      move16 (); 
-                past_r2_q[i] = 0;               move16 (); 
+                past_r2_q_rx[i] = 0;            move16 (); 
             }
         }
 
@@ -138,11 +138,11 @@ void D_plsf_5 (
 
         for (i = 0; i < M; i++)
         {
-            /* temp  = mean_lsf[i] +  past_r2_q[i] * PRED_FAC; */
+            /* temp  = mean_lsf[i] +  past_r2_q_rx[i] * PRED_FAC; */
 
-            temp = efr_add (mean_lsf[i], efr_mult (past_r2_q[i], PRED_FAC));
+            temp = efr_add (mean_lsf[i], efr_mult (past_r2_q_rx[i], PRED_FAC));
 
-            past_r2_q[i] = efr_sub (lsf2_q[i], temp);
+            past_r2_q_rx[i] = efr_sub (lsf2_q[i], temp);
                                                 move16 (); 
         }
     }
@@ -204,12 +204,12 @@ void D_plsf_5 (
         {
             for (i = 0; i < M; i++)
             {
-                temp = efr_add (mean_lsf[i], efr_mult (past_r2_q[i], PRED_FAC));
+                temp = efr_add (mean_lsf[i], efr_mult (past_r2_q_rx[i], PRED_FAC));
                 lsf1_q[i] = efr_add (lsf1_r[i], temp);
                                                 move16 (); 
                 lsf2_q[i] = efr_add (lsf2_r[i], temp);
                                                 move16 (); 
-                past_r2_q[i] = lsf2_r[i];       move16 (); 
+                past_r2_q_rx[i] = lsf2_r[i];    move16 (); 
             }
         }
         else
@@ -222,7 +222,7 @@ void D_plsf_5 (
                 /* Use the dequantized values of lsf2 also for lsf1 */
                 lsf1_q[i] = lsf2_q[i];          move16 (); 
 
-                past_r2_q[i] = 0;               move16 (); 
+                past_r2_q_rx[i] = 0;            move16 (); 
             }
         }
     }
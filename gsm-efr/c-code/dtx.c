@@ -24,6 +24,9 @@
  *       sid_codeword_encoding()
  *     Detecting of SID codeword from a frame:
  *       sid_frame_detection()
+ *     The same two on the speech parameters instead of the serial bits:
+ *       sid_codeword_encoding_prm()
+ *       sid_frame_detection_prm()
  *     Update the LSF parameter history:
  *       update_lsf_history()
  *     Update the reference LSF parameter vector:
@@ -94,6 +97,17 @@ static const Word16 SID_codeword_bit_idx[95] = {
   217, 218, 219, 220, 221
 };
 
+/* The same bits in the 57 speech parameters of the frame (see
+   Prm2bits_12k2), the most significant bit of a parameter is sent first */
+
+static const Word16 SID_codeword_prm_mask[57] = {
+   0,  0,  0,  0,  0,
+   3,  7, 15, 15, 15, 15, 12,  0,  0,  0,  0,  0,  0,
+   7,  7, 15, 15, 15, 15, 12,  0,  0,  0,  0,  0,  0,
+   3, 15, 15, 15, 15, 15, 12,  0,  0,  0,  0,  0,  0,
+  15, 15, 15, 12, 15, 15, 12,  0,  0,  0,  0,  0,  0
+};
+
 Word16 txdtx_ctrl;              /* Encoder DTX control word                */
 Word16 rxdtx_ctrl;              /* Decoder DTX control word                */
 Word16 CN_excitation_gain;      /* Unquantized fixed codebook gain         */
@@ -617,6 +631,81 @@ Word16 sid_frame_detection (
   return sid;
 }
 
+/*************************************************************************
+ *
+ *   FUNCTION NAME: sid_codeword_encoding_prm
+ *
+ *   PURPOSE:  sid_codeword_encoding() on the speech parameters of the
+ *             frame, for a channel that does not go through serial bits.
+ *
+ *   INPUTS:      prm[0..56]    Speech parameter frame before writing
+ *                              SID codeword into it
+ *
+ *   OUTPUTS:     prm[0..56]    Speech parameter frame with SID codeword
+ *                              written into it
+ *
+ *   RETURN VALUE: none
+ *
+ *************************************************************************/
+
+void sid_codeword_encoding_prm (
+  Word16 prm[]
+) {
+  Word16 i;
+
+  for (i = 0; i < 57; i++) {
+    prm[i] = prm[i] | SID_codeword_prm_mask[i];     logic16 (); move16 ();
+  }
+
+  return;
+}
+
+/*************************************************************************
+ *
+ *   FUNCTION NAME: sid_frame_detection_prm
+ *
+ *   PURPOSE:  sid_frame_detection() on the speech parameters of the
+ *             frame, for a channel that does not go through serial bits.
+ *
+ *   INPUTS:      prm[0..56]    Received speech parameter frame
+ *
+ *   OUTPUTS:     none
+ *
+ *   RETURN VALUE: Ternary-valued SID classification flag
+ *
+ *************************************************************************/
+
+Word16 sid_frame_detection_prm (
+  Word16 prm[]
+) {
+  Word16 i, zeros, nbr_errors, sid;
+
+  /* Search for bit errors in SID codeword */
+  nbr_errors = 0;                                     move16 ();
+  for (i = 0; i < 57; i++) {
+    zeros = SID_codeword_prm_mask[i] & ~prm[i];      logic16 ();
+    while (zeros != 0) {
+      zeros = zeros & (zeros - 1);                   logic16 ();
+      nbr_errors = efr_add (nbr_errors, 1);
+    }
+  }
+
+  /* Frame classification */
+  test (); test ();
+  if (efr_sub (nbr_errors, VALID_SID_THRESH) < 0) {
+    /* Valid SID frame */
+    sid = 2;                                        move16 ();
+  } else if (efr_sub (nbr_errors, INVALID_SID_THRESH) < 0) {
+    /* Invalid SID frame */
+    sid = 1;                                        move16 ();
+  } else {
+    /* Speech frame */
+    sid = 0;                                        move16 ();
+  }
+
+  return sid;
+}
+
 /*************************************************************************
  *
  *   FUNCTION NAME: update_lsf_history
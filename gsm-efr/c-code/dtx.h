@@ -78,6 +78,14 @@ Word16 sid_frame_detection (
     Word16 ser2[]
 );
 
+void sid_codeword_encoding_prm (
+    Word16 prm[]
+);
+
+Word16 sid_frame_detection_prm (
+    Word16 prm[]
+);
+
 void update_lsf_history (
     Word16 lsf1[M],
     Word16 lsf2[M],
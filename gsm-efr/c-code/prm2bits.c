@@ -45,6 +45,15 @@ void Int2bin (
 #define MASK      0x0001
 #define PRM_NO    57
 
+static const Word16 bitno[PRM_NO] =
+{
+    7, 8, 9, 8, 6,                              /* LSP VQ          */
+    9, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5,      /* first subframe  */
+    6, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5,      /* second subframe */
+    9, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5,      /* third subframe  */
+    6, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5       /* fourth subframe */
+};
+
 void Prm2bits_12k2 (
     Word16 prm[],       /* input : analysis parameters  (57 parameters)   */
     Word16 bits[]       /* output: 244 serial bits                        */
@@ -52,14 +61,6 @@ void Prm2bits_12k2 (
 {
     Word16 i;
 
-    static const Word16 bitno[PRM_NO] =
-    {
-        7, 8, 9, 8, 6,                          /* LSP VQ          */
-        9, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5,  /* first subframe  */
-        6, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5,  /* second subframe */
-        9, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5,  /* third subframe  */
-        6, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 5   /* fourth subframe */
-    };
     for (i = 0; i < PRM_NO; i++)
     {
         Int2bin (prm[i], bitno[i], bits);
@@ -69,6 +70,44 @@ void Prm2bits_12k2 (
     return;
 }
 
+/*************************************************************************
+ *
+ *  FUNCTION:  Prm2bytes_12k2
+ *
+ *  PURPOSE:  the 244 serial bits of Prm2bits_12k2() packed in 31 bytes,
+ *            the first bit in the most significant bit of bytes[0] and
+ *            the last 4 bits of bytes[30] set to 0.
+ *
+ *************************************************************************/
+
+void Prm2bytes_12k2 (
+    Word16 prm[],           /* input : analysis parameters  (57 parameters) */
+    unsigned char bytes[]   /* output: 244 serial bits in 31 bytes          */
+)
+{
+    Word16 i, n;
+    Word32 acc;
+
+    acc = 0;
+    n = 0;                  /* bits in acc */
+    for (i = 0; i < PRM_NO; i++)
+    {
+        acc = (acc << bitno[i]) | prm[i];
+        n += bitno[i];
+        while (n >= 8)
+        {
+            n -= 8;
+            *bytes++ = (unsigned char) (acc >> n);
+        }
+        acc &= (1L << n) - 1;
+    }
+    if (n > 0)
+    {
+        *bytes = (unsigned char) (acc << (8 - n));
+    }
+    return;
+}
+
 /*************************************************************************
  *
  *  FUNCTION:  Int2bin
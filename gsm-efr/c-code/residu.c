@@ -8,15 +8,71 @@
  *     The LP residual is computed by filtering the input speech through
  *     the LP inverse filter A(z).
  *
+ *     With SSE2 / NEON, blocks of 8 output samples are computed in the
+ *     vector lanes when the L_mac chains can not saturate (see vec_op.h).
+ *
  *************************************************************************/
 
 #include "typedef.h"
 #include "basic_op.h"
 #include "count.h"
+#include "cnst.h"
+#include "vec_op.h"
 
 /* m = LPC order == 10 */
 #define m 10
 
+#ifdef VEC_KERNELS
+/* s[i] = sum_{j=0}^{m} a[j] * x[i - j], i = 0..lg-1, lg multiple of 8 */
+static void Residu_sum (Word16 a[], Word16 x[], Word32 s[], Word16 lg)
+{
+    Word16 i, j;
+#ifdef VEC_SSE2
+    __m128i c, x0, x1, acc0, acc1;
+
+    for (i = 0; i < lg; i += 8)
+    {
+        acc0 = _mm_setzero_si128 ();
+        acc1 = _mm_setzero_si128 ();
+
+        /* taps j and j+1: (x[n-j], x[n-j-1]) . (a[j], a[j+1]) */
+        for (j = 0; j < m; j += 2)
+        {
+            c = _mm_unpacklo_epi16 (_mm_set1_epi16 (a[j]), _mm_set1_epi16 (a[j + 1]));
+            x0 = _mm_loadu_si128 ((__m128i *) &x[i - j]);
+            x1 = _mm_loadu_si128 ((__m128i *) &x[i - j - 1]);
+            acc0 = _mm_add_epi32 (acc0, _mm_madd_epi16 (_mm_unpacklo_epi16 (x0, x1), c));
+            acc1 = _mm_add_epi32 (acc1, _mm_madd_epi16 (_mm_unpackhi_epi16 (x0, x1), c));
+        }
+        /* tap m alone, the second of the pair is multiplied by 0 */
+        c = _mm_unpacklo_epi16 (_mm_set1_epi16 (a[m]), _mm_setzero_si128 ());
+        x0 = _mm_loadu_si128 ((__m128i *) &x[i - m]);
+        acc0 = _mm_add_epi32 (acc0, _mm_madd_epi16 (_mm_unpacklo_epi16 (x0, x0), c));
+        acc1 = _mm_add_epi32 (acc1, _mm_madd_epi16 (_mm_unpackhi_epi16 (x0, x0), c));
+
+        _mm_storeu_si128 ((__m128i *) &s[i], acc0);
+        _mm_storeu_si128 ((__m128i *) &s[i + 4], acc1);
+    }
+#else
+    int32x4_t acc0, acc1;
+
+    for (i = 0; i < lg; i += 8)
+    {
+        acc0 = vdupq_n_s32 (0);
+        acc1 = vdupq_n_s32 (0);
+        for (j = 0; j <= m; j++)
+        {
+            acc0 = vmlal_n_s16 (acc0, vld1_s16 (&x[i - j]), a[j]);
+            acc1 = vmlal_n_s16 (acc1, vld1_s16 (&x[i - j + 4]), a[j]);
+        }
+        vst1q_s32 (&s[i], acc0);
+        vst1q_s32 (&s[i + 4], acc1);
+    }
+#endif
+    return;
+}
+#endif
+
 void Residu (
     Word16 a[], /* (i)     : prediction coefficients                      */
     Word16 x[], /* (i)     : speech signal                                */
@@ -26,6 +82,21 @@ void Residu (
 {
     Word16 i, j;
     Word32 s;
+#ifdef VEC_KERNELS
+    Word32 L_s[L_SUBFR];
+
+    if ((lg <= L_SUBFR) && ((lg & 7) == 0)
+        && Mac_fits (Max_abs (&x[-m], (Word16) (lg + m)), Sum_abs (a, m + 1)))
+    {
+        Residu_sum (a, x, L_s, lg);
+        for (i = 0; i < lg; i++)
+        {
+            s = efr_L_shl (L_s[i] * 2, 3);
+            y[i] = gsm_efr_round (s);
+        }
+        return;
+    }
+#endif
 
     for (i = 0; i < lg; i++)
     {
@@ -4,11 +4,19 @@
  *
  *  PURPOSE:  Perform synthesis filtering through 1/A(z).
  *
+ *  DESCRIPTION:
+ *     The recursion needs each output before the next one, so it stays
+ *     scalar. When sum |a[j]| <= 32767 no L_msu chain can saturate for
+ *     any 16 bit input and memory (see vec_op.h), the products are then
+ *     added as plain integers with the newest output last, which takes
+ *     the saturation tests out of the recursion.
+ *
  *************************************************************************/
 
 #include "typedef.h"
 #include "basic_op.h"
 #include "count.h"
+#include "vec_op.h"
 
 /* m = LPC order == 10 */
 #define m 10
@@ -38,15 +46,31 @@ void Syn_filt (
 
     /* Do the filtering. */
 
-    for (i = 0; i < lg; i++)
+    if (Mac_fits (32768L, Sum_abs (a, m + 1)))
+    {
+        for (i = 0; i < lg; i++)
+        {
+            s = (Word32) x[i] * a[0];
+            for (j = m; j > 0; j--)
+            {
+                s -= (Word32) a[j] * yy[-j];
+            }
+            s = efr_L_shl (s * 2, 3);
+            *yy++ = gsm_efr_round (s);
+        }
+    }
+    else
     {
-        s = efr_L_mult (x[i], a[0]);
-        for (j = 1; j <= m; j++)
+        for (i = 0; i < lg; i++)
         {
-            s = efr_L_msu (s, a[j], yy[-j]);
+            s = efr_L_mult (x[i], a[0]);
+            for (j = 1; j <= m; j++)
+            {
+                s = efr_L_msu (s, a[j], yy[-j]);
+            }
+            s = efr_L_shl (s, 3);
+            *yy++ = gsm_efr_round (s);          move16 (); 
         }
-        s = efr_L_shl (s, 3);
-        *yy++ = gsm_efr_round (s);              move16 (); 
     }
 
     for (i = 0; i < lg; i++)
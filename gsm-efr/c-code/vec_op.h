@@ -0,0 +1,65 @@
+/*___________________________________________________________________________
+ |                                                                           |
+ |   Vector extensions used by the filter kernels (Residu, Convolve,         |
+ |   Autocorr) and the bound that decides when they may be used.             |
+ |                                                                           |
+ |   A chain of L_mac / L_msu only saturates when one of its partial sums    |
+ |   leaves the 32 bit range. If the sum of the absolute products is at      |
+ |   most MAX_32 no partial sum can, the chain is then the plain integer     |
+ |   sum in any order and efr_Overflow is not touched, so a kernel that      |
+ |   adds the products with pmaddwd / vmlal is bit exact with the scalar     |
+ |   code. The kernels fall back to the scalar code when the bound fails.    |
+ |___________________________________________________________________________|
+*/
+#ifndef VEC_OP_H
+#define VEC_OP_H
+
+#include "typedef.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define VEC_SSE2
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define VEC_NEON
+#endif
+
+#if defined(VEC_SSE2) || defined(VEC_NEON)
+#define VEC_KERNELS
+#endif
+
+/* sum of |x[i]|, i = 0..n-1 */
+static inline Word32 Sum_abs (Word16 x[], Word16 n)
+{
+    Word16 i;
+    Word32 s = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        s += (x[i] < 0) ? -(Word32) x[i] : (Word32) x[i];
+    }
+    return s;
+}
+
+/* largest |x[i]|, i = 0..n-1 */
+static inline Word32 Max_abs (Word16 x[], Word16 n)
+{
+    Word16 i;
+    Word32 v, m = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        v = (x[i] < 0) ? -(Word32) x[i] : (Word32) x[i];
+        m = (v > m) ? v : m;
+    }
+    return m;
+}
+
+/* 1 if L_mac chains over products x * a with |x| <= max_x and
+   sum |a| <= sum_a can not saturate: 2 * max_x * sum_a <= MAX_32 */
+static inline Word16 Mac_fits (Word32 max_x, Word32 sum_a)
+{
+    return (sum_a == 0) || (max_x <= (Word32) 0x3fffffffL / sum_a);
+}
+
+#endif
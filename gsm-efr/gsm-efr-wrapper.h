@@ -2,20 +2,84 @@
 #define GSM_EFR_WRAPPER_H
 
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <random>
+
+// Gilbert-Elliott channel between the encoder and the decoder: every frame the
+// channel moves good->bad with p_gb and bad->good with p_bg, and in each state a
+// frame is lost with loss_* and its 244 bits are flipped with ber_*
+struct GsmEfrChannelOptions {
+  float p_gb = 0.0f, p_bg = 1.0f;
+  float loss_good = 0.0f, loss_bad = 0.0f;
+  float ber_good = 0.0f, ber_bad = 0.0f;
+  // class 1a bit errors are caught by the CRC and the frame decoded as bad,
+  // class 1b and class 2 bit errors reach the decoder undetected
+  bool crc_class_1a = true;
+  unsigned int seed = 0;
+  bool Enabled() const {
+    return loss_good > 0.0f || loss_bad > 0.0f || ber_good > 0.0f || ber_bad > 0.0f;
+  }
+};
 
 class GsmEfrWrapper {
  public:
-  GsmEfrWrapper(): samples_per_frame_(160){};
+  GsmEfrWrapper(): samples_per_frame_(160), dtx_(false), keep_bitstream_(false), pipeline_(false),
+    num_sid_frames_(0), num_no_data_frames_(0), channel_bad_(false), num_lost_frames_(0),
+    num_bad_frames_(0), num_bit_errors_(0) {};
+  // DTX: the VAD and hangover decision is made after the LP analysis, the
+  // frames without speech skip the closed-loop pitch and codebook searches
+  // and are sent as SID frames, decoded as comfort noise
+  void SetDtx(bool dtx) { dtx_ = dtx; }
+  // SID frames sent and frames not transmitted (the SID frames between two
+  // updates) in the last Simulate call
+  int NumSidFrames() const { return num_sid_frames_; }
+  int NumNoDataFrames() const { return num_no_data_frames_; }
+  // the frames go from the encoder to the decoder as parameters; with
+  // keep_bitstream they are packed into the 244 bit frames of the air
+  // interface (31 bytes, first bit in the MSB) and unpacked for the decoder
+  void SetKeepBitstream(bool keep_bitstream) { keep_bitstream_ = keep_bitstream; }
+  // the packed frames of the last Simulate call, SID codewords included
+  const std::vector<unsigned char> &Bitstream() const { return bitstream_; }
+  // the transmitted frames go through the channel, the lost frames and the
+  // frames failing the CRC reach the decoder with BFI set and are concealed
+  void SetChannel(const GsmEfrChannelOptions &channel) { channel_ = channel; }
+  // lost frames, frames failing the CRC and flipped bits in the last Simulate call
+  int NumLostFrames() const { return num_lost_frames_; }
+  int NumBadFrames() const { return num_bad_frames_; }
+  int NumBitErrors() const { return num_bit_errors_; }
+  // Simulate runs the encoder on a second thread, the frames go to the
+  // channel and the decoder through a ring as they are encoded, so encoding
+  // and decoding overlap; the output is the same as without the pipeline
+  void SetPipeline(bool pipeline) { pipeline_ = pipeline; }
   void Simulate(const char * pcm_in, int in_samples, char * pcm_out);
   ~GsmEfrWrapper() {};
  private:
-  void Encode(const char * pcm_in, int in_samples, short * efr_enc);
-  void Decode(const short *efr_dec, int num_frames, char * pcm_out);
-  void EncodeToDecode(const short *efr_enc, short *efr_dec);
+  // one frame through the encoder, the channel and the decoder, the
+  // encoder and decoder states are the globals of the c-code
+  void EncodeFrame(const short *pcm_in, short *prm);
+  void Transmit(short *prm, short *parm, short *taf, short *sid_flag);
+  void DecodeFrame(short *parm, short taf, short sid_flag, short *pcm_out);
+  int ApplyChannel(short *prm, bool transmitted);
+  void SimulatePipeline(const short *pcm_in, short *pcm_out);
   const int samples_per_frame_; // how many samples in a frame defined by AMR_NB codec
   // const int bytes_per_frame_; // how many bytes for an AMR_NB encoded frame
   // const int chars_per_frame_;
   int num_frames_;
+  bool dtx_;
+  bool keep_bitstream_;
+  bool pipeline_;
+  std::vector<unsigned char> bitstream_;
+  // channel and decoder homing state of the current Simulate call
+  int decoding_mode_;
+  int taf_count_;
+  int reset_flag_old_;
+  int num_sid_frames_;
+  int num_no_data_frames_;
+  GsmEfrChannelOptions channel_;
+  bool channel_bad_;
+  std::mt19937 channel_rng_;
+  int num_lost_frames_, num_bad_frames_, num_bit_errors_;
 };
 
 #endif
\ No newline at end of file
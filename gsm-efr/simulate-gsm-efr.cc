@@ -6,6 +6,8 @@
 #include "util/common-utils.h"
 #include "feat/wave-reader.h"
 #include "base/timer.h"
+#include "c-code/typedef.h"
+#include "c-code/codec.h"
 
 int main(int argc, char *argv[] ) {
   try {
@@ -15,7 +17,24 @@ int main(int argc, char *argv[] ) {
       "Usage: simulate-gsm-efr [options] <wav-in-file> <wav-out-file>\n"
       " e.g.: simulate-gsm-efr input.wav output.wav\n";
     ParseOptions po(usage);
+    int simd_int = SEARCH_EXACT;
+    bool dtx = false;
+    bool pipeline = false;
+    GsmEfrChannelOptions channel;
+    int channel_seed = 0;
+    po.Register("simd", &simd_int, "codebook search kernels, 0:reference C, 1:SIMD bit exact");
+    po.Register("dtx", &dtx, "discontinuous transmission, frames without speech skip the pitch and codebook searches and are sent as SID frames");
+    po.Register("pipeline", &pipeline, "run the encoder and the decoder on two threads, overlapping the encoding and the decoding of the utterance");
+    po.Register("channel-p-gb", &channel.p_gb, "Gilbert-Elliott channel, per-frame probability of going from the good to the bad state");
+    po.Register("channel-p-bg", &channel.p_bg, "Gilbert-Elliott channel, per-frame probability of going from the bad to the good state");
+    po.Register("loss-good", &channel.loss_good, "frame loss rate in the good channel state");
+    po.Register("loss-bad", &channel.loss_bad, "frame loss rate in the bad channel state");
+    po.Register("ber-good", &channel.ber_good, "bit error rate in the good channel state");
+    po.Register("ber-bad", &channel.ber_bad, "bit error rate in the bad channel state");
+    po.Register("crc-class-1a", &channel.crc_class_1a, "decode frames with class 1a bit errors as bad frames, as the CRC of a real channel would");
+    po.Register("channel-seed", &channel_seed, "random seed for the channel");
     po.Read(argc, argv);
+    channel.seed = channel_seed;
     if (po.NumArgs() != 2) {
       po.PrintUsage();
       exit(1);
@@ -31,8 +50,14 @@ int main(int argc, char *argv[] ) {
     kaldi::SubVector<kaldi::BaseFloat> data(wave_data.Data(), 0);
 
     kaldi::Matrix<kaldi::BaseFloat> output_data(1, data.Dim());
+    if (Set_search_10i40_mode(simd_int) != simd_int) {
+      KALDI_WARN << "SIMD kernels not supported by this build, using the reference C code";
+    }
 
     GsmEfrWrapper gsm_simulator;
+    gsm_simulator.SetDtx(dtx);
+    gsm_simulator.SetChannel(channel);
+    gsm_simulator.SetPipeline(pipeline);
     short *pcm_in = new short [data.Dim()];
     short *pcm_out = new short [data.Dim()];
     for (int isample = 0; isample < data.Dim(); isample++) {
@@ -45,6 +70,15 @@ int main(int argc, char *argv[] ) {
     gsm_simulator.Simulate((const char*)pcm_in, in_samples, (char*)pcm_out);
     float time_elapsed = ATimer.Elapsed();
     std::cout << "RTF:" <<  time_elapsed / (data.Dim() / 8000.0f) << "\n";
+    if (dtx) {
+      std::cout << "SID frames:" << gsm_simulator.NumSidFrames()
+                << ", not transmitted frames:" << gsm_simulator.NumNoDataFrames() << "\n";
+    }
+    if (channel.Enabled()) {
+      std::cout << "lost frames:" << gsm_simulator.NumLostFrames()
+                << ", bad frames:" << gsm_simulator.NumBadFrames()
+                << ", bit errors:" << gsm_simulator.NumBitErrors() << "\n";
+    }
     for (int isample = 0; isample < data.Dim(); isample++) {
       output_data(0, isample) = pcm_out[isample];
     }